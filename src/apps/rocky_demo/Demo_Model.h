@@ -39,7 +39,7 @@ auto Demo_Model = [](Application& app)
         auto options = vsg::Options::create(*app.context->readerWriterOptions);
         auto extension = std::filesystem::path(uri.full()).extension();
         options->extensionHint = extension.empty() ? std::filesystem::path(result.value.contentType) : extension;
-        std::stringstream in(result.value.data);
+        BufferStream in(result.value.data);
         auto node = vsg::read_cast<vsg::Node>(in, options);
         if (!node)
         {
@@ -24,7 +24,7 @@ namespace
             auto options = vsg::Options::create(*runtime->readerWriterOptions);
             auto extension = std::filesystem::path(uri.full()).extension();
             options->extensionHint = extension.empty() ? std::filesystem::path(result.value.contentType) : extension;
-            std::stringstream in(result.value.data);
+            BufferStream in(result.value.data);
             return vsg::read_cast<vsg::Node>(in, options);
         }
         else
@@ -13,6 +13,7 @@
 #include <rocky/vsg/terrain/TerrainEngine.h>
 #include <rocky/Memory.h>
 #include <vsg/core/Allocator.h>
+#include <unordered_map>
 #include "helpers.h"
 
 using namespace ROCKY_NAMESPACE;
@@ -46,6 +47,20 @@ namespace
             result = std::min(result, static_cast<long long>(t[i % frame_count].count()));
         return result;
     }
+
+    // per-pool throughput, sampled about once a second
+    struct PoolRate {
+        std::uint64_t completed = 0;
+        std::chrono::steady_clock::time_point time;
+        float perSecond = 0.0f;
+    };
+    std::unordered_map<std::string, PoolRate> pool_rates;
+
+    std::string format_latency(std::chrono::microseconds t) {
+        return t.count() >= 1000 ?
+            util::format("%.1f ms", 0.001f * (float)t.count()) :
+            util::format("%d us", (int)t.count());
+    }
 }
 auto Demo_Stats = [](Application& app)
 {
@@ -112,15 +127,56 @@ auto Demo_Stats = [](Application& app)
 
     ImGui::SeparatorText("Thread Pools");
     auto* metrics = jobs::get_metrics();
+
+    static bool pool_details = false;
+    ImGui::Checkbox("Latency", &pool_details);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##pools"))
+    {
+        for (auto m : metrics->all())
+            if (m) m->reset_latency();
+    }
+
     if (ImGuiLTable::Begin("Thread Pools"))
     {
+        auto now = std::chrono::steady_clock::now();
+
         for (auto m : metrics->all())
         {
             if (m)
             {
                 std::string name = m->name.empty() ? "default" : m->name;
-                auto buf = util::format("(%d) %d / %d", (int)m->concurrency, (int)m->running, (int)m->pending);
+
+                auto& rate = pool_rates[name];
+                if (now - rate.time >= std::chrono::seconds(1))
+                {
+                    std::uint64_t completed = m->completed;
+                    if (rate.time.time_since_epoch().count() > 0)
+                        rate.perSecond = (float)(completed - rate.completed) / std::chrono::duration<float>(now - rate.time).count();
+                    rate.completed = completed;
+                    rate.time = now;
+                }
+
+                // (threads) running / pending, jobs per second
+                auto buf = util::format("(%d) %d / %d  %.0f/s", (int)m->concurrency, (int)m->running, (int)m->pending, rate.perSecond);
                 ImGuiLTable::Text(name.c_str(), buf.c_str());
+
+                if (pool_details && m->completed > 0)
+                {
+                    ImGuiLTable::Text("  wait", "p50 %s  p95 %s  p99 %s",
+                        format_latency(m->wait.percentile(0.50)).c_str(),
+                        format_latency(m->wait.percentile(0.95)).c_str(),
+                        format_latency(m->wait.percentile(0.99)).c_str());
+
+                    ImGuiLTable::Text("  run", "p50 %s  p95 %s  p99 %s",
+                        format_latency(m->execution.percentile(0.50)).c_str(),
+                        format_latency(m->execution.percentile(0.95)).c_str(),
+                        format_latency(m->execution.percentile(0.99)).c_str());
+
+                    ImGuiLTable::Text("  queue", "peak %d, %d canceled, %d%% reordered",
+                        (int)m->peak_pending, (int)m->canceled,
+                        (int)(100.0 * (double)m->reordered / (double)m->completed));
+                }
             }
         }
         ImGuiLTable::End();
@@ -128,7 +184,7 @@ auto Demo_Stats = [](Application& app)
 
     auto& engine = app.mapNode->terrainNode->engine;
     auto& cache = app.context->io.services.contentCache;
-    float ratio = cache->gets > 0 ? float(cache->hits) / float(cache->gets) : 0.0f;
+    auto cacheStats = cache->stats();
 
     ImGui::SeparatorText("System");
     if (ImGuiLTable::Begin("System"))
@@ -136,10 +192,20 @@ auto Demo_Stats = [](Application& app)
         ImGuiLTable::Text("Loader concurrency", std::to_string(engine->settings.concurrency).c_str());
         ImGuiLTable::Text("Resident tiles", std::to_string(engine->tiles.size()).c_str());
         ImGuiLTable::Text("Geometry pool cache", std::to_string(engine->geometryPool.size()).c_str());
-        ImGuiLTable::Text("Content cache hits", "%d%%", int(ratio * 100.0f));
+        ImGuiLTable::Text("Content cache hits", "%d%%", int(cacheStats.hitRatio() * 100.0f));
         ImGui::SameLine();
         if (ImGui::Button("Clear"))
             cache->clear();
+        ImGuiLTable::Text("Content cache size", "%.1lf MB (%d entries)", (double)cacheStats.cost / 1048576.0, (int)cacheStats.entries);
+        ImGuiLTable::Text("Content cache evictions", "%llu", (unsigned long long)cacheStats.evictions);
+
+        if (auto& pool = app.context->io.services.httpPool)
+        {
+            auto poolStats = pool->stats();
+            ImGuiLTable::Text("HTTP connection reuse", "%d%%", int(poolStats.reuseRatio() * 100.0f));
+            ImGuiLTable::Text("HTTP connections", "%d active, %d idle (%llu opened)",
+                (int)poolStats.active, (int)poolStats.idle, (unsigned long long)poolStats.created);
+        }
 
         ImGuiLTable::End();
     }
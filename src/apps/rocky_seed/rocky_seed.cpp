@@ -0,0 +1,415 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+/**
+* ROCKY_SEED pre-fetches map data for offline use. For every image and
+* elevation layer in a map, it fetches the tiles that intersect a geographic
+* extent over a range of levels and stores them in an MBTiles database per
+* layer. You can then point MBTilesImageLayer/MBTilesElevationLayer at the
+* results when there is no network connection.
+*
+* Tiles already present in an output database are skipped, so you can run
+* the same command again to resume an interrupted seed.
+*/
+
+#include <rocky/rocky.h>
+#include <rocky/MBTiles.h>
+#include <rocky/vsg/VSGContext.h>
+#include <rocky/vsg/MapNode.h>
+
+#include <vsg/all.h>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <optional>
+
+using namespace ROCKY_NAMESPACE;
+
+int usage(const char* msg)
+{
+    std::cout << msg << std::endl
+        << "Usage: rocky_seed --map <file.json> --out <folder> [options]" << std::endl
+        << "  --extent <west> <south> <east> <north>  Geographic extent in degrees (default: whole earth)" << std::endl
+        << "  --min-level <n>                         First level to seed (default 0)" << std::endl
+        << "  --max-level <n>                         Last level to seed (default 8)" << std::endl
+        << "  --layer <name>                          Only seed the named layer" << std::endl
+        << "  --image-format <mime-type>              Image tile format (default image/png)" << std::endl
+        << "  --threads <n>                           Number of concurrent fetches (default 8)" << std::endl
+        << "  --batch <n>                             Tiles per database transaction (default 256)" << std::endl;
+    return -1;
+}
+
+struct Settings
+{
+    GeoExtent extent = GeoExtent(SRS::WGS84, -180.0, -90.0, 180.0, 90.0);
+    unsigned minLevel = 0u;
+    unsigned maxLevel = 8u;
+    unsigned threads = 8u;
+    unsigned batchSize = 256u;
+    std::string outputFolder;
+    std::string imageFormat = "image/png";
+};
+
+// Size of a database plus its write-ahead log, which holds the recent
+// writes until SQLite checkpoints them into the database.
+std::uintmax_t databaseSize(const std::string& filename)
+{
+    std::error_code ec;
+    auto bytes = std::filesystem::file_size(filename, ec);
+    if (ec)
+        bytes = 0;
+
+    auto wal = std::filesystem::file_size(filename + "-wal", ec);
+    if (!ec)
+        bytes += wal;
+
+    return bytes;
+}
+
+struct Progress
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t total = 0;
+    std::size_t written = 0;
+    std::size_t skipped = 0;
+    std::size_t empty = 0;
+    std::size_t failed = 0;
+    std::uintmax_t startBytes = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point lastReport = Clock::now();
+
+    std::size_t done() const { return written + skipped + empty + failed; }
+
+    void report(const std::string& name, const std::string& filename, bool force = false)
+    {
+        auto now = Clock::now();
+        if (!force && now - lastReport < std::chrono::seconds(1))
+            return;
+        lastReport = now;
+
+        auto bytes = databaseSize(filename);
+        double megabytes = (double)(bytes - std::min(bytes, startBytes)) / 1048576.0;
+        double seconds = std::max(1e-3, std::chrono::duration<double>(now - start).count());
+
+        Log()->info("{}: {}/{} tiles ({:.1f}%) | {:.1f} tiles/sec | {:.2f} MB/sec | {} written, {} skipped, {} empty, {} failed",
+            name, done(), total, total > 0 ? 100.0 * (double)done() / (double)total : 100.0,
+            (double)written / seconds, megabytes / seconds,
+            written, skipped, empty, failed);
+    }
+};
+
+// Walks the keys at one LOD that intersect an extent, one at a time, by
+// descending the quadtree depth-first from level 0. Memory stays proportional
+// to the depth of the tree, not to the number of keys.
+class KeyWalker
+{
+public:
+    KeyWalker(const GeoExtent& extent, unsigned lod, const Profile& profile) :
+        _extent(extent),
+        _lod(lod)
+    {
+        std::vector<TileKey> roots;
+        TileKey::getIntersectingKeys(extent, 0, profile, roots);
+        _stack.assign(roots.rbegin(), roots.rend());
+    }
+
+    //! The next key, or an invalid key when there are no more
+    TileKey next()
+    {
+        while (!_stack.empty())
+        {
+            auto key = _stack.back();
+            _stack.pop_back();
+
+            if (key.level == _lod)
+                return key;
+
+            for (unsigned quadrant = 4; quadrant-- > 0; )
+            {
+                auto child = key.createChildKey(quadrant);
+                if (child.extent().intersects(_extent))
+                    _stack.push_back(child);
+            }
+        }
+        return {};
+    }
+
+private:
+    GeoExtent _extent;
+    unsigned _lod;
+    std::vector<TileKey> _stack;
+};
+
+// Estimated number of keys at a LOD that intersect an extent: the count at a
+// coarser level with few keys, times the descendants each has at the LOD.
+// It runs high along the edges of the extent.
+std::size_t estimateKeys(const GeoExtent& extent, unsigned lod, const Profile& profile)
+{
+    unsigned coarse = std::min(lod, 6u);
+    std::vector<TileKey> keys;
+    TileKey::getIntersectingKeys(extent, coarse, profile, keys);
+    return keys.size() << (2 * (lod - coarse));
+}
+
+using TileResult = Result<std::shared_ptr<Image>>;
+using FetchFunction = std::function<TileResult(const TileKey&, const IOOptions&)>;
+
+Status seed(
+    std::shared_ptr<TileLayer> layer,
+    FetchFunction fetch,
+    const std::string& format,
+    const Settings& settings,
+    const IOOptions& io)
+{
+    auto profile = layer->profile;
+    if (!profile.valid())
+        return Status(Status::ConfigurationError, "Layer has no tiling profile");
+
+    auto filename = (std::filesystem::path(settings.outputFolder) / (layer->name() + ".mbtiles")).string();
+
+    MBTiles::Options options;
+    options.uri = URI(filename);
+    options.format = format;
+    options.writeAheadLog = true;
+
+    MBTiles::Driver output;
+    DataExtentList dataExtents;
+    auto status = output.open(layer->name(), options, true, profile, dataExtents, io);
+    if (status.failed())
+        return status;
+
+    // A resumed seed reports the bounds written by earlier runs. A new database
+    // reports the whole profile instead, which must not widen the bounds.
+    std::string bounds;
+    if (!output.getMetaData("bounds", bounds))
+        dataExtents.clear();
+
+    Progress progress;
+    progress.startBytes = databaseSize(filename);
+
+    // Keys are enumerated one LOD at a time, a key at a time, as the window
+    // of fetches needs refilling. Keys already in the output are skipped.
+    // The total is an estimate until each LOD is done, then it's exact.
+    unsigned lod = settings.minLevel;
+    std::optional<KeyWalker> walker;
+    std::size_t lodEstimate = 0, lodCount = 0;
+
+    auto nextKey = [&]() -> TileKey
+        {
+            while (lod <= settings.maxLevel)
+            {
+                if (!walker)
+                {
+                    walker.emplace(settings.extent, lod, profile);
+                    lodEstimate = estimateKeys(settings.extent, lod, profile);
+                    lodCount = 0;
+                    progress.total += lodEstimate;
+                    Log()->info("{}: level {}, about {} tiles", layer->name(), lod, lodEstimate);
+                }
+
+                for (auto key = walker->next(); key.valid(); key = walker->next())
+                {
+                    if (!layer->mayHaveData(key))
+                        continue;
+
+                    ++lodCount;
+
+                    if (!output.contains(key))
+                        return key;
+
+                    // resuming can skip a lot of keys; keep reporting
+                    ++progress.skipped;
+                    progress.report(layer->name(), filename);
+                }
+
+                progress.total = progress.total - lodEstimate + lodCount;
+                walker.reset();
+                ++lod;
+            }
+            return {};
+        };
+
+    // Fetch concurrently, but keep a bounded window of tiles in flight. With
+    // the keys streamed in as well, memory stays flat no matter how large the
+    // seed is.
+    using Fetch = std::pair<TileKey, jobs::future<TileResult>>;
+    std::deque<Fetch> inflight;
+    std::size_t window = settings.threads * 4u;
+    TileKey next = nextKey();
+
+    auto pool = jobs::get_pool("rocky.seed");
+    pool->set_concurrency(settings.threads);
+
+    // tiles are written in batches; each batch is one transaction, and its
+    // tiles are encoded in parallel while the inserts proceed.
+    std::vector<MBTiles::Tile> batch;
+
+    auto flush = [&]()
+        {
+            auto ws = output.write(batch, io);
+            if (ws.ok())
+                progress.written += batch.size();
+            else
+            {
+                progress.failed += batch.size();
+                Log()->warn("{}: failed to write {} tiles: {}", layer->name(), batch.size(), ws.message);
+            }
+            batch.clear();
+        };
+
+    while (next.valid() || !inflight.empty())
+    {
+        while (next.valid() && inflight.size() < window)
+        {
+            auto key = next;
+            next = nextKey();
+            auto job = [fetch, key, &io](jobs::cancelable& c)
+                {
+                    return fetch(key, IOOptions(io, c));
+                };
+
+            inflight.emplace_back(key, jobs::dispatch(job, jobs::context{ "seed " + key.str(), pool }));
+        }
+
+        auto [key, result] = std::move(inflight.front());
+        inflight.pop_front();
+
+        auto& r = result.join();
+
+        if (r.status.ok() && r.value)
+        {
+            batch.emplace_back(MBTiles::Tile{ key, r.value });
+
+            if (batch.size() >= settings.batchSize)
+                flush();
+        }
+        else if (r.status.ok() || r.status.code == Status::ResourceUnavailable)
+        {
+            ++progress.empty;
+        }
+        else
+        {
+            ++progress.failed;
+            Log()->warn("{}: failed to fetch {}: {}", layer->name(), key.str(), r.status.message);
+        }
+
+        progress.report(layer->name(), filename);
+    }
+
+    if (!batch.empty())
+        flush();
+
+    // record this run's extent, unless an earlier run already covered it
+    bool covered = std::any_of(dataExtents.begin(), dataExtents.end(),
+        [&](const DataExtent& e) { return e.contains(settings.extent); });
+    if (!covered)
+        dataExtents.emplace_back(settings.extent, settings.minLevel, settings.maxLevel);
+    output.setDataExtents(dataExtents);
+    output.close();
+
+    progress.report(layer->name(), filename, true);
+
+    return StatusOK;
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+    if (arguments.read({ "--help" }))
+        return usage(argv[0]);
+
+    Settings settings;
+    std::string mapFile, layerName;
+    double west, south, east, north;
+
+    arguments.read("--map", mapFile);
+    arguments.read("--out", settings.outputFolder);
+    arguments.read("--layer", layerName);
+    arguments.read("--min-level", settings.minLevel);
+    arguments.read("--max-level", settings.maxLevel);
+    arguments.read("--image-format", settings.imageFormat);
+    arguments.read("--threads", settings.threads);
+    arguments.read("--batch", settings.batchSize);
+    if (arguments.read("--extent", west, south, east, north))
+        settings.extent = GeoExtent(SRS::WGS84, west, south, east, north);
+
+    if (mapFile.empty() || settings.outputFolder.empty())
+        return usage("Missing required argument");
+
+    if (!settings.extent.valid() || settings.minLevel > settings.maxLevel)
+        return usage("Invalid extent or level range");
+
+    settings.threads = std::max(1u, settings.threads);
+    settings.batchSize = std::max(1u, settings.batchSize);
+
+    rocky::Log()->set_level(rocky::log::level::info);
+
+    // headless context; supplies the image codecs and IO services
+    auto context = VSGContextFactory::create(vsg::ref_ptr<vsg::Viewer>());
+    auto io = context->io.from(mapFile);
+
+    auto map_file = URI(mapFile).read(io);
+    if (map_file.status.failed())
+        return usage(map_file.status.message.c_str());
+
+    // accept either a bare map or a map node file (with a "map" section)
+    auto map = Map::create();
+    map->from_json(map_file->data.str(), io);
+    if (map->layers().size() == 0)
+    {
+        auto mapNode = MapNode::create(context);
+        mapNode->from_json(map_file->data.str(), io);
+        map = mapNode->map;
+    }
+
+    auto status = map->openAllLayers(io);
+    if (status.failed())
+        Log()->warn("Problem opening layers: {}", status.message);
+
+    std::error_code ec;
+    std::filesystem::create_directories(settings.outputFolder, ec);
+
+    for (auto& layer : map->layers().ofType<ImageLayer>())
+    {
+        if (!layer->isOpen() || (!layerName.empty() && layer->name() != layerName))
+            continue;
+
+        auto fetch = [layer](const TileKey& key, const IOOptions& io) -> TileResult
+            {
+                auto r = layer->createImage(key, io);
+                if (r.status.failed())
+                    return r.status;
+                return r.value.image();
+            };
+
+        status = seed(layer, fetch, settings.imageFormat, settings, io);
+        if (status.failed())
+            Log()->warn("{}: {}", layer->name(), status.message);
+    }
+
+    for (auto& layer : map->layers().ofType<ElevationLayer>())
+    {
+        if (!layer->isOpen() || (!layerName.empty() && layer->name() != layerName))
+            continue;
+
+        // float heightfields are stored losslessly as GeoTIFF
+        auto fetch = [layer](const TileKey& key, const IOOptions& io) -> TileResult
+            {
+                auto r = layer->createHeightfield(key, io);
+                if (r.status.failed())
+                    return r.status;
+                return std::shared_ptr<Image>(r.value.heightfield());
+            };
+
+        status = seed(layer, fetch, "image/tif", settings, io);
+        if (status.failed())
+            Log()->warn("{}: {}", layer->name(), status.message);
+    }
+
+    return 0;
+}
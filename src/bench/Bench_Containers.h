@@ -0,0 +1,185 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/TileKey.h>
+#include <rocky/LRUCache.h>
+#include <rocky/TileKeyMap.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // the keys of a pager-like working set: a few full quadtree levels over one region
+    inline std::vector<TileKey> make_test_keys(const Profile& profile, unsigned count)
+    {
+        std::vector<TileKey> keys;
+        keys.reserve(count);
+        for (unsigned level = 8; keys.size() < count; ++level)
+        {
+            unsigned dim = 1u << (level - 6);
+            for (unsigned i = 0; i < dim * dim && keys.size() < count; ++i)
+                keys.emplace_back(level, 130u * (1u << (level - 8)) + i % dim, 70u * (1u << (level - 8)) + i / dim, profile);
+        }
+
+        // shuffle deterministically so lookups don't walk memory in order
+        for (std::size_t i = keys.size() - 1; i > 0; --i)
+            std::swap(keys[i], keys[(i * 2654435761u) % (i + 1)]);
+
+        return keys;
+    }
+}
+
+//! Cost of the TileKey operations behind the pager's tables: sorting
+//! (operator<), hashing, packing to an id(), and lookups in ordered and
+//! hashed containers, including the open-addressing TileKeyMap.
+auto Bench_TileKey = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    Profile profile("global-geodetic");
+
+    for (unsigned count : { 1024u, 16384u })
+    {
+        auto keys = make_test_keys(profile, count);
+
+        auto sort = bench::measure(settings, [&]()
+            {
+                auto sorted = keys;
+                std::sort(sorted.begin(), sorted.end());
+                bench::keep(sorted.front().x);
+            });
+
+        std::uint64_t h = 0;
+        auto hash = bench::measure(settings, [&]()
+            {
+                for (auto& key : keys)
+                    h += std::hash<TileKey>()(key);
+            });
+        bench::keep(h);
+
+        std::uint64_t ids = 0;
+        auto id = bench::measure(settings, [&]()
+            {
+                for (auto& key : keys)
+                    ids += key.id();
+            });
+        bench::keep(ids);
+
+        std::map<TileKey, unsigned> ordered;
+        std::unordered_set<TileKey> hashed;
+        util::TileKeyMap<unsigned> table;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            ordered.emplace(keys[i], i);
+            hashed.emplace(keys[i]);
+            table[keys[i]] = i;
+        }
+
+        std::uint64_t found = 0;
+        auto mapFind = bench::measure(settings, [&]()
+            {
+                for (auto& key : keys)
+                    found += ordered.find(key)->second;
+            });
+
+        auto setFind = bench::measure(settings, [&]()
+            {
+                for (auto& key : keys)
+                    found += hashed.count(key);
+            });
+
+        auto tableFind = bench::measure(settings, [&]()
+            {
+                for (auto& key : keys)
+                    found += *table.find(key);
+            });
+        bench::keep(found);
+
+        auto perKey = [count](const bench::Timing& t) { return 1e3 * t.microsPerOp() / (double)count; };
+
+        reporter.report(bench::Record{ "tilekey" }
+            .param("keys", (long long)count)
+            .metric("ns_per_key_sort", perKey(sort))
+            .metric("ns_per_hash", perKey(hash))
+            .metric("ns_per_map_find", perKey(mapFind))
+            .metric("ns_per_hash_find", perKey(setFind))
+            .metric("ns_per_id", perKey(id))
+            .metric("ns_per_tilekeymap_find", perKey(tableFind)));
+    }
+};
+
+//! Operations per second on a shared LRUCache from many threads at once,
+//! with a read-mostly mix (like the layer L2 caches) and with one shard vs. many.
+auto Bench_LRUCacheContention = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    Profile profile("global-geodetic");
+    const unsigned numKeys = 4096;
+    const unsigned capacity = 1024;
+    const unsigned opsPerThread = settings.quick ? 50000 : 500000;
+    auto keys = make_test_keys(profile, numKeys);
+
+    for (unsigned shards : { 1u, 8u, 32u })
+    {
+        for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+        {
+            if (settings.quick && threads > 4)
+                break;
+
+            util::LRUCache<TileKey, std::shared_ptr<int>> cache(capacity, shards);
+            for (unsigned i = 0; i < capacity; ++i)
+                cache.put(keys[i], std::make_shared<int>(i));
+
+            std::atomic<unsigned> ready = { 0u };
+            std::atomic<std::uint64_t> sum = { 0u };
+            std::vector<std::thread> workers;
+
+            auto start = bench::Clock::now();
+            for (unsigned w = 0; w < threads; ++w)
+            {
+                workers.emplace_back([&, w]()
+                    {
+                        // start together so the threads really contend
+                        ready++;
+                        while (ready < threads)
+                            std::this_thread::yield();
+
+                        std::uint64_t local = 0;
+                        std::uint32_t rng = 0x9E3779B9u * (w + 1);
+                        for (unsigned i = 0; i < opsPerThread; ++i)
+                        {
+                            rng ^= rng << 13, rng ^= rng >> 17, rng ^= rng << 5;
+
+                            // skew toward the front of the key list so most gets hit
+                            auto& key = keys[(rng % numKeys) * (rng % numKeys) / numKeys];
+                            if ((rng >> 24) < 26) // about 10% writes
+                                cache.put(key, std::make_shared<int>((int)i));
+                            else if (auto value = cache.get(key))
+                                local += *value;
+                        }
+                        sum += local;
+                    });
+            }
+
+            for (auto& worker : workers)
+                worker.join();
+            double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            bench::keep(sum);
+            auto stats = cache.stats();
+
+            reporter.report(bench::Record{ "lrucache.contention" }
+                .param("shards", (long long)shards)
+                .param("threads", (long long)threads)
+                .metric("ops_per_sec", (double)(opsPerThread * threads) / seconds)
+                .metric("hit_ratio", stats.hitRatio()));
+        }
+    }
+};
@@ -0,0 +1,109 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/ElevationLayer.h>
+#include <cmath>
+#include <vector>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    //! Elevation layer that computes its heights, so the benchmark measures
+    //! the compositing work and not I/O or decoding.
+    class SyntheticElevationLayer : public Inherit<ElevationLayer, SyntheticElevationLayer>
+    {
+    public:
+        SyntheticElevationLayer(double amplitude, double frequency) :
+            _amplitude(amplitude), _frequency(frequency) { }
+
+        Status openImplementation(const IOOptions& io) override
+        {
+            auto parent = super::openImplementation(io);
+            if (parent.ok())
+                profile = Profile("global-geodetic");
+            return parent;
+        }
+
+    protected:
+        Result<GeoHeightfield> createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const override
+        {
+            auto extent = key.extent();
+            unsigned size = tileSize.value();
+            auto hf = Heightfield::create(size, size);
+            double dx = extent.width() / (double)(size - 1);
+            double dy = extent.height() / (double)(size - 1);
+            for (unsigned t = 0; t < size; ++t)
+            {
+                for (unsigned s = 0; s < size; ++s)
+                {
+                    double x = extent.xmin() + dx * (double)s;
+                    double y = extent.ymin() + dy * (double)t;
+                    hf->heightAt(s, t) = (float)(_amplitude * std::sin(x * _frequency) * std::cos(y * _frequency));
+                }
+            }
+            return GeoHeightfield(hf, extent);
+        }
+
+    private:
+        double _amplitude;
+        double _frequency;
+    };
+}
+
+//! Heightfields per second built by ElevationLayerVector::populateHeightfield
+//! from synthetic layers, with one and several layers, in the layers' own
+//! profile and in a different one (which forces resampling).
+auto Bench_PopulateHeightfield = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned size = 257;
+    const unsigned level = 10;
+    Profile geodetic("global-geodetic");
+    Profile mercator("spherical-mercator");
+
+    for (auto& keyProfile : { geodetic, mercator })
+    {
+        for (unsigned numLayers : { 1u, 3u })
+        {
+            IOOptions io;
+            ElevationLayerVector layers;
+            for (unsigned i = 0; i < numLayers; ++i)
+            {
+                auto layer = SyntheticElevationLayer::create(1000.0 / (double)(i + 1), 0.5 * (double)(i + 1));
+                if (layer->open(io).ok())
+                    layers.emplace_back(layer);
+            }
+
+            if (layers.empty())
+                return;
+
+            // walk a region of tiles larger than the layers' L2 caches so every call does real work
+            auto [cols, rows] = keyProfile.numTiles(level);
+            unsigned next = 0;
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    TileKey key(level, cols / 2 + next % 64, rows / 3 + (next / 64) % 64, keyProfile);
+                    ++next;
+
+                    auto hf = Heightfield::create(size, size);
+                    layers.populateHeightfield(hf, nullptr, key, {}, Interpolation::BILINEAR, io);
+                    bench::keep((std::uint64_t)std::abs(hf->heightAt(size / 2, size / 2)));
+                });
+
+            reporter.report(bench::Record{ "elevation.populate_heightfield" }
+                .param("layers", (long long)numLayers)
+                .param("profile", keyProfile == geodetic ? "same" : "different")
+                .param("size", (long long)size)
+                .metric("tiles_per_sec", t.perSecond())
+                .metric("ms_per_tile", 1e-3 * t.microsPerOp()));
+
+            for (auto& layer : layers)
+                layer->close();
+        }
+    }
+};
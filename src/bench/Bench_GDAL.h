@@ -0,0 +1,120 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#ifdef ROCKY_HAS_GDAL
+
+#include <rocky/GDALImageLayer.h>
+#include <gdal.h>
+#include <ogr_srs_api.h>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // Writes a whole-earth RGB GeoTIFF (deflate-compressed and tiled, like
+    // typical production imagery) and a VRT that wraps it.
+    inline bool make_test_rasters(const std::string& tif, const std::string& vrt, int width, int height)
+    {
+        GDALAllRegister();
+
+        const char* options[] = { "COMPRESS=DEFLATE", "TILED=YES", nullptr };
+        auto ds = GDALCreate(GDALGetDriverByName("GTiff"), tif.c_str(), width, height, 3, GDT_Byte, (char**)options);
+        if (!ds)
+            return false;
+
+        double geotransform[6] = { -180.0, 360.0 / (double)width, 0.0, 90.0, 0.0, -180.0 / (double)height };
+        GDALSetGeoTransform(ds, geotransform);
+        GDALSetProjection(ds, SRS_WKT_WGS84_LAT_LONG);
+
+        std::vector<unsigned char> row(width);
+        for (int b = 1; b <= 3; ++b)
+        {
+            auto band = GDALGetRasterBand(ds, b);
+            GDALSetRasterColorInterpretation(band, (GDALColorInterp)(GCI_RedBand + b - 1));
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                    row[x] = (unsigned char)((x * b) ^ (y * 3) ^ ((x * y) >> 7));
+                if (GDALRasterIO(band, GF_Write, 0, y, width, 1, row.data(), width, 1, GDT_Byte, 0, 0) != CE_None)
+                    break;
+            }
+        }
+
+        auto copy = GDALCreateCopy(GDALGetDriverByName("VRT"), vrt.c_str(), ds, FALSE, nullptr, nullptr, nullptr);
+        if (copy)
+            GDALClose(copy);
+
+        GDALClose(ds);
+        return copy != nullptr;
+    }
+}
+
+//! Tiles per second read from a GDAL image layer when each tile is warped
+//! on its own vs. when the four children of a tile share one warped read.
+auto Bench_GDALSiblings = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    std::filesystem::create_directories(settings.workDir);
+    auto tif = (settings.workDir / "siblings.tif").string();
+    auto vrt = (settings.workDir / "siblings.vrt").string();
+
+    int width = settings.quick ? 2048 : 8192;
+    if (!make_test_rasters(tif, vrt, width, width / 2))
+        return;
+
+    // children at about the native resolution of the raster
+    const unsigned tileSize = 256;
+    unsigned level = 0;
+    while ((2u << level) * tileSize < (unsigned)width)
+        ++level;
+
+    for (auto& file : { tif, vrt })
+    {
+        for (bool batched : { false, true })
+        {
+            auto layer = GDALImageLayer::create();
+            layer->uri = URI(file);
+            layer->tileSize = tileSize;
+            layer->batchSiblings = batched;
+
+            IOOptions io;
+            if (layer->open(io).failed())
+                return;
+
+            auto [cols, rows] = layer->profile.numTiles(level - 1);
+            unsigned next = 0;
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    // the four children of one tile, the way the pager requests them
+                    TileKey parent(level - 1, next % cols, (next / cols) % rows, layer->profile);
+                    ++next;
+
+                    for (unsigned q = 0; q < 4; ++q)
+                    {
+                        auto r = layer->createImage(parent.createChildKey(q), io);
+                        if (r.status.ok())
+                            bench::keep(r.value.image()->data<unsigned char>()[q]);
+                    }
+                });
+
+            reporter.report(bench::Record{ "gdal.siblings" }
+                .param("format", std::filesystem::path(file).extension().string().substr(1))
+                .param("mode", batched ? "batched" : "single")
+                .param("level", (long long)level)
+                .metric("tiles_per_sec", 4.0 * t.perSecond())
+                .metric("ms_per_quad", 1e3 * t.seconds / (double)t.iterations));
+
+            layer->close();
+        }
+    }
+
+    std::filesystem::remove(tif);
+    std::filesystem::remove(vrt);
+};
+
+#endif // ROCKY_HAS_GDAL
@@ -0,0 +1,83 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/URI.h>
+#include <rocky/Buffer.h>
+#include <sstream>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // touch every page so lazily-mapped memory is actually read
+    inline std::uint64_t checksum(const char* data, std::size_t size)
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < size; i += 512)
+            sum += (unsigned char)data[i];
+        return sum;
+    }
+
+    // the original URI::read local path: stream through a stringstream, then copy
+    inline std::string read_with_streams(const std::string& filename)
+    {
+        std::ifstream in(filename.c_str(), std::ios_base::in);
+        std::stringstream buf;
+        buf << in.rdbuf() << std::flush;
+        return buf.str();
+    }
+}
+
+//! Throughput of local file reads: the old stream-based path vs. Buffer::readFile
+//! (memory-mapped above the threshold) vs. a complete URI::read.
+auto Bench_ReadLocal = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    std::filesystem::create_directories(settings.workDir);
+
+    std::vector<std::size_t> sizes = { 16 * 1024, 256 * 1024, 4 * 1024 * 1024, 64 * 1024 * 1024 };
+    if (settings.quick)
+        sizes.resize(2);
+
+    for (auto size : sizes)
+    {
+        auto filename = (settings.workDir / ("read_local_" + std::to_string(size) + ".bin")).string();
+        {
+            std::string data(size, '\0');
+            for (std::size_t i = 0; i < size; ++i)
+                data[i] = (char)(i * 31);
+            std::ofstream out(filename, std::ios_base::binary);
+            out.write(data.data(), data.size());
+        }
+
+        auto stream = bench::measure(settings, [&]() {
+            auto data = read_with_streams(filename);
+            bench::keep(checksum(data.data(), data.size()));
+            });
+
+        auto buffer = bench::measure(settings, [&]() {
+            auto r = Buffer::readFile(filename);
+            bench::keep(checksum(r.value.data(), r.value.size()));
+            });
+
+        IOOptions io;
+        auto uri = bench::measure(settings, [&]() {
+            auto r = URI(filename).read(io);
+            bench::keep(checksum(r.value.data.data(), r.value.data.size()));
+            });
+
+        for (auto& [variant, t] : { std::make_pair("stream", stream), std::make_pair("buffer", buffer), std::make_pair("uri", uri) })
+        {
+            reporter.report(bench::Record{ "io.read_local" }
+                .param("variant", variant)
+                .param("bytes", (long long)size)
+                .metric("reads_per_sec", t.perSecond())
+                .metric("mb_per_sec", t.perSecond() * (double)size / 1048576.0));
+        }
+
+        std::filesystem::remove(filename);
+    }
+};
@@ -0,0 +1,257 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/BlockCompressor.h>
+#include <rocky/GeoImage.h>
+#include <rocky/Profile.h>
+#include <rocky/TileKey.h>
+#include <cmath>
+#include <vector>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // an image with a pattern that changes at every pixel so no read is trivially predictable
+    inline std::shared_ptr<Image> make_test_image(Image::PixelFormat format, unsigned size, float alpha = 1.0f)
+    {
+        auto image = Image::create(format, size, size);
+        for (unsigned t = 0; t < size; ++t)
+        {
+            for (unsigned s = 0; s < size; ++s)
+            {
+                float a = (float)((s * 7 + t * 13) & 0xff) / 255.0f;
+                float b = (float)((s ^ t) & 0xff) / 255.0f;
+                image->write(Image::Pixel(a, b, 1.0f - a, alpha), s, t);
+            }
+        }
+        return image;
+    }
+
+    inline const char* format_name(Image::PixelFormat format)
+    {
+        return
+            format == Image::R8G8B8A8_UNORM ? "rgba8" :
+            format == Image::R8G8B8_UNORM ? "rgb8" :
+            format == Image::R32_SFLOAT ? "r32f" :
+            format == Image::BC1_RGB_UNORM ? "bc1" :
+            format == Image::BC3_UNORM ? "bc3" :
+            format == Image::BC7_UNORM ? "bc7" :
+            "other";
+    }
+}
+
+//! Bilinear samples per second from an image, for 8-bit color and for
+//! 32-bit float (heightfield) data.
+auto Bench_ImageReadBilinear = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned size = 256;
+    const unsigned samples = 64 * 64;
+
+    for (auto format : { Image::R8G8B8A8_UNORM, Image::R32_SFLOAT })
+    {
+        auto image = make_test_image(format, size);
+
+        // off-grid sample locations, so every read interpolates
+        std::vector<std::pair<float, float>> uvs(samples);
+        for (unsigned i = 0; i < samples; ++i)
+            uvs[i] = { ((float)(i % 64) + 0.37f) / 64.0f, ((float)(i / 64) + 0.61f) / 64.0f };
+
+        Image::Pixel pixel;
+        float sum = 0.0f;
+
+        auto t = bench::measure(settings, [&]()
+            {
+                for (auto& uv : uvs)
+                {
+                    image->read_bilinear(pixel, uv.first, uv.second);
+                    sum += pixel.r;
+                }
+            });
+
+        bench::keep((std::uint64_t)sum);
+
+        reporter.report(bench::Record{ "image.read_bilinear" }
+            .param("format", format_name(format))
+            .param("size", (long long)size)
+            .metric("samples_per_sec", (double)samples * t.perSecond())
+            .metric("ns_per_sample", 1e3 * t.microsPerOp() / (double)samples));
+    }
+};
+
+//! Cost of generating a full mipmap chain for one terrain tile image, as the
+//! terrain loader does when TerrainSettings::colorMipmaps is set.
+auto Bench_ImageMipmaps = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    for (auto format : { Image::R8G8B8A8_UNORM, Image::R8G8B8_UNORM, Image::R32_SFLOAT })
+    {
+        for (unsigned size : { 256u, 512u })
+        {
+            auto image = make_test_image(format, size);
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    auto mipmapped = image->generateMipmaps();
+                    bench::keep(mipmapped->mipmapData<unsigned char>(1)[0]);
+                });
+
+            reporter.report(bench::Record{ "image.mipmaps" }
+                .param("format", format_name(format))
+                .param("size", (long long)size)
+                .metric("tiles_per_sec", t.perSecond())
+                .metric("us_per_tile", t.microsPerOp())
+                .metric("mb_per_sec", (double)image->sizeInBytes() * t.perSecond() / 1048576.0));
+        }
+    }
+};
+
+//! Encode throughput of util::BlockCompressor on a mipmapped RGBA terrain tile,
+//! as the terrain loader does for layers with textureCompression set, along
+//! with the texture memory saved and the error the encoding introduces.
+auto Bench_BlockCompression = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned size = 256;
+    auto image = make_test_image(Image::R8G8B8A8_UNORM, size, 0.5f)->generateMipmaps();
+
+    for (auto format : { Image::BC1_RGB_UNORM, Image::BC3_UNORM, Image::BC7_UNORM })
+    {
+        for (auto preset : { util::BlockCompressor::Preset::FAST, util::BlockCompressor::Preset::QUALITY })
+        {
+            util::BlockCompressor compressor;
+            compressor.format = format;
+            compressor.preset = preset;
+
+            std::shared_ptr<Image> compressed;
+            auto t = bench::measure(settings, [&]()
+                {
+                    compressed = compressor.compress(*image);
+                    bench::keep(compressed->data<unsigned char>()[0]);
+                });
+
+            // error over the top level, in 8-bit units (alpha is ignored by BC1)
+            const unsigned channels = format == Image::BC1_RGB_UNORM ? 3 : 4;
+            const unsigned blocks = size / 4;
+            const unsigned blockBytes = compressed->rowSizeInBytes() / blocks;
+            double sum = 0.0;
+            unsigned char rgba[64];
+            for (unsigned by = 0; by < blocks; ++by)
+            {
+                for (unsigned bx = 0; bx < blocks; ++bx)
+                {
+                    util::BlockCompressor::decodeBlock(format, compressed->data<unsigned char>() + (by * blocks + bx) * blockBytes, rgba);
+                    for (unsigned i = 0; i < 16; ++i)
+                    {
+                        auto source = image->data<unsigned char>() + ((by * 4 + i / 4) * size + bx * 4 + i % 4) * 4;
+                        for (unsigned c = 0; c < channels; ++c)
+                        {
+                            double d = (double)rgba[i * 4 + c] - (double)source[c];
+                            sum += d * d;
+                        }
+                    }
+                }
+            }
+
+            reporter.report(bench::Record{ "image.block_compression" }
+                .param("format", format_name(format))
+                .param("preset", preset == util::BlockCompressor::Preset::FAST ? "fast" : "quality")
+                .param("size", (long long)size)
+                .metric("tiles_per_sec", t.perSecond())
+                .metric("ms_per_tile", 1e-3 * t.microsPerOp())
+                .metric("mb_per_sec", (double)image->sizeInBytesWithMipmaps() * t.perSecond() / 1048576.0)
+                .metric("vram_saved_kb", (double)(image->sizeInBytesWithMipmaps() - compressed->sizeInBytesWithMipmaps()) / 1024.0)
+                .metric("rmse", std::sqrt(sum / (double)(size * size * channels))));
+        }
+    }
+};
+
+//! Tiles per second warped by GeoImage::reproject, from geodetic tiles into
+//! spherical mercator (and back), both whole and cropped to a target extent.
+auto Bench_GeoImageReproject = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned size = 256;
+    Profile geodetic("global-geodetic");
+    Profile mercator("spherical-mercator");
+
+    struct Case { const char* name; Profile from; Profile to; };
+    std::vector<Case> cases = {
+        { "geodetic>mercator", geodetic, mercator },
+        { "mercator>geodetic", mercator, geodetic }
+    };
+
+    for (auto& c : cases)
+    {
+        // a mid-latitude tile, where the warp is non-trivial
+        TileKey key(4, 3, 5, c.from);
+        GeoImage source(make_test_image(Image::R8G8B8A8_UNORM, size), key.extent());
+
+        for (bool cropped : { false, true })
+        {
+            auto targetExtent = key.extent().transform(c.to.srs());
+            if (cropped)
+            {
+                // the middle of the tile, as when building a child tile
+                targetExtent.scale(0.5, 0.5);
+            }
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    auto r = source.reproject(c.to.srs(), cropped ? &targetExtent : nullptr, size, size);
+                    if (r.status.ok())
+                        bench::keep(r.value.image()->data<unsigned char>()[size * 2]);
+                });
+
+            reporter.report(bench::Record{ "geoimage.reproject" }
+                .param("case", c.name)
+                .param("mode", cropped ? "crop" : "full")
+                .param("size", (long long)size)
+                .metric("tiles_per_sec", t.perSecond())
+                .metric("ms_per_tile", 1e-3 * t.microsPerOp()));
+        }
+    }
+};
+
+//! Tiles per second composited by GeoImage::composite from several
+//! semi-transparent sources, in the same SRS as the target and in a different one.
+auto Bench_GeoImageComposite = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned size = 256;
+    Profile geodetic("global-geodetic");
+    Profile mercator("spherical-mercator");
+
+    TileKey targetKey(4, 9, 5, geodetic);
+
+    for (auto& sourceProfile : { geodetic, mercator })
+    {
+        for (unsigned numSources : { 1u, 2u, 4u })
+        {
+            // sources cover the target tile, as the layers of a map would
+            std::vector<GeoImage> sources;
+            std::vector<float> opacities;
+            auto sourceExtent = targetKey.extent().transform(sourceProfile.srs());
+            for (unsigned i = 0; i < numSources; ++i)
+            {
+                sources.emplace_back(make_test_image(Image::R8G8B8A8_UNORM, size, 0.75f), sourceExtent);
+                opacities.emplace_back(1.0f - 0.1f * (float)i);
+            }
+
+            GeoImage target(Image::create(Image::R8G8B8A8_UNORM, size, size), targetKey.extent());
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    target.composite(sources, opacities);
+                    bench::keep(target.image()->data<unsigned char>()[size * 2]);
+                });
+
+            reporter.report(bench::Record{ "geoimage.composite" }
+                .param("sources", (long long)numSources)
+                .param("srs", sourceProfile == geodetic ? "same" : "different")
+                .param("size", (long long)size)
+                .metric("tiles_per_sec", t.perSecond())
+                .metric("ms_per_tile", 1e-3 * t.microsPerOp()));
+        }
+    }
+};
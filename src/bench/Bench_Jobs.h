@@ -0,0 +1,185 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Threading.h>
+#include <cmath>
+#include <functional>
+#include <future>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    inline const char* scheduling_name(jobs::scheduling mode)
+    {
+        return
+            mode == jobs::scheduling::scan ? "scan" :
+            mode == jobs::scheduling::heap ? "heap" :
+            "stealing";
+    }
+}
+
+//! Throughput and per-dequeue cost of a job pool draining a deep queue of
+//! prioritized jobs, for each scheduling mode and thread count.
+auto Bench_JobScheduling = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned numJobs = settings.quick ? 2000 : 10000;
+
+    for (auto mode : { jobs::scheduling::scan, jobs::scheduling::heap })
+    {
+        for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+        {
+            if (settings.quick && threads > 4)
+                break;
+
+            std::string modeName = scheduling_name(mode);
+            auto pool = jobs::get_pool("rocky.bench." + modeName + "." + std::to_string(threads), threads);
+            pool->set_scheduling(mode);
+
+            // occupy every thread so the whole batch is queued before any of it runs
+            std::promise<void> gate;
+            auto open = gate.get_future().share();
+            auto blockers = jobs::jobgroup::create();
+            for (unsigned t = 0; t < threads; ++t)
+                jobs::dispatch([open]() { open.wait(); }, jobs::context{ "gate", pool, {}, blockers });
+
+            while (pool->metrics()->running < threads)
+                std::this_thread::yield();
+
+            // priority functions do roughly what the terrain pager's do
+            auto group = jobs::jobgroup::create();
+            std::atomic<std::uint64_t> sum = { 0 };
+            for (unsigned i = 0; i < numJobs; ++i)
+            {
+                auto range = std::make_shared<float>((float)((i * 7919u) % numJobs));
+                auto priority = [range]() { return -std::sqrt(*range) * 10.0f; };
+                jobs::dispatch([&sum, i]() { sum += i; }, jobs::context{ "job", pool, priority, group });
+            }
+
+            auto start = bench::Clock::now();
+            gate.set_value();
+            group->join();
+            double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+            blockers->join();
+
+            bench::keep(sum);
+
+            reporter.report(bench::Record{ "jobs.scheduling" }
+                .param("mode", modeName)
+                .param("threads", (long long)threads)
+                .param("jobs", (long long)numJobs)
+                .metric("jobs_per_sec", (double)numJobs / seconds)
+                .metric("us_per_dequeue", 1e6 * seconds * (double)threads / (double)numJobs));
+        }
+    }
+};
+
+//! Cost of dispatching an empty job, from a thread outside the pool and
+//! from a job running in the pool, and the end-to-end rate at which the
+//! pool retires them.
+auto Bench_JobDispatch = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned numJobs = settings.quick ? 5000 : 20000;
+    const unsigned threads = 4;
+
+    for (auto mode : { jobs::scheduling::scan, jobs::scheduling::heap, jobs::scheduling::stealing })
+    {
+        auto pool = jobs::get_pool(std::string("rocky.bench.dispatch.") + scheduling_name(mode), threads);
+        pool->set_scheduling(mode);
+
+        for (bool nested : { false, true })
+        {
+            std::atomic<unsigned> done = { 0u };
+            std::atomic<std::int64_t> dispatchNanos = { 0 };
+
+            auto dispatchAll = [&]()
+                {
+                    auto t0 = bench::Clock::now();
+                    for (unsigned i = 0; i < numJobs; ++i)
+                        jobs::dispatch([&done]() { done++; }, jobs::context{ "job", pool });
+                    dispatchNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(bench::Clock::now() - t0).count();
+                };
+
+            auto start = bench::Clock::now();
+
+            if (nested)
+                jobs::dispatch(dispatchAll, jobs::context{ "root", pool });
+            else
+                dispatchAll();
+
+            while (done < numJobs)
+                std::this_thread::yield();
+
+            double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            reporter.report(bench::Record{ "jobs.dispatch" }
+                .param("mode", scheduling_name(mode))
+                .param("from", nested ? "pool" : "outside")
+                .param("threads", (long long)threads)
+                .param("jobs", (long long)numJobs)
+                .metric("ns_per_dispatch", (double)dispatchNanos / (double)numJobs)
+                .metric("jobs_per_sec", (double)numJobs / seconds));
+        }
+    }
+};
+
+//! Fork-join scaling: every job does a little work and dispatches two
+//! children until the tree is complete. Compares one shared queue (heap)
+//! with per-thread work-stealing deques at up to 64 threads.
+auto Bench_JobStealing = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    const unsigned depth = settings.quick ? 12 : 16;
+    const unsigned numJobs = (2u << depth) - 1u;
+
+    for (auto mode : { jobs::scheduling::heap, jobs::scheduling::stealing })
+    {
+        for (unsigned threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u })
+        {
+            if (settings.quick && threads > 4)
+                break;
+
+            auto pool = jobs::get_pool(
+                std::string("rocky.bench.stealing.") + scheduling_name(mode) + "." + std::to_string(threads), threads);
+            pool->set_scheduling(mode);
+
+            std::atomic<unsigned> done = { 0u };
+            std::atomic<std::uint64_t> sum = { 0u };
+
+            std::function<void(unsigned, std::uint64_t)> node = [&](unsigned level, std::uint64_t seed)
+                {
+                    // about a microsecond of work
+                    std::uint64_t h = seed;
+                    for (int i = 0; i < 256; ++i)
+                        h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ull;
+                    sum += h & 0xff;
+
+                    if (level > 0)
+                    {
+                        for (std::uint64_t c = 0; c < 2; ++c)
+                            jobs::dispatch([&node, level, h, c]() { node(level - 1, h + c); }, jobs::context{ "node", pool });
+                    }
+                    done++;
+                };
+
+            auto start = bench::Clock::now();
+            jobs::dispatch([&]() { node(depth, 1u); }, jobs::context{ "root", pool });
+
+            while (done < numJobs)
+                std::this_thread::yield();
+
+            double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            bench::keep(sum);
+
+            reporter.report(bench::Record{ "jobs.stealing" }
+                .param("mode", scheduling_name(mode))
+                .param("threads", (long long)threads)
+                .param("jobs", (long long)numJobs)
+                .metric("jobs_per_sec", (double)numJobs / seconds));
+        }
+    }
+};
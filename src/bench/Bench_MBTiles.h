@@ -0,0 +1,225 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#ifdef ROCKY_HAS_MBTILES
+
+#include <rocky/MBTiles.h>
+#include <rocky/Image.h>
+#include <random>
+#include <thread>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // Pass-through codec (raw RGBA bytes) so the benchmark measures the
+    // database and not an image library.
+    inline void install_raw_codec(IOOptions& io, unsigned size)
+    {
+        io.services.writeImageToStream = [](std::shared_ptr<Image> image, std::ostream& out, std::string, const IOOptions&)
+            {
+                out.write(image->data<char>(), image->sizeInBytes());
+                return StatusOK;
+            };
+
+        io.services.readImageFromStream = [size](std::istream& in, std::string, const IOOptions&) -> Result<std::shared_ptr<Image>>
+            {
+                auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+                in.read(image->data<char>(), image->sizeInBytes());
+                return image;
+            };
+    }
+
+    inline std::shared_ptr<Image> make_test_tile(unsigned size)
+    {
+        auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+        auto ptr = image->data<unsigned char>();
+        for (unsigned i = 0; i < image->sizeInBytes(); ++i)
+            ptr[i] = (unsigned char)((i * 7) ^ (i >> 10));
+        return image;
+    }
+}
+
+//! Random tile reads per second from an MBTiles database as the number of
+//! reading threads grows.
+auto Bench_MBTilesRead = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    std::filesystem::create_directories(settings.workDir);
+    auto filename = (settings.workDir / "read.mbtiles").string();
+    std::filesystem::remove(filename);
+
+    const unsigned tileSize = 256;
+    const unsigned level = settings.quick ? 3 : 4;
+
+    IOOptions io;
+    install_raw_codec(io, tileSize);
+
+    Profile profile("global-geodetic");
+    MBTiles::Options options;
+    options.uri = URI(filename);
+    options.format = "application/octet-stream";
+    options.compress = true;
+
+    // populate every tile at one level:
+    std::vector<TileKey> keys;
+    {
+        MBTiles::Driver driver;
+        DataExtentList dataExtents;
+        if (driver.open("bench", options, true, profile, dataExtents, io).failed())
+            return;
+
+        auto image = make_test_tile(tileSize);
+        auto [cols, rows] = profile.numTiles(level);
+
+        driver.beginTransaction();
+        for (unsigned y = 0; y < rows; ++y)
+        {
+            for (unsigned x = 0; x < cols; ++x)
+            {
+                keys.emplace_back(level, x, y, profile);
+                driver.write(keys.back(), image, io);
+            }
+        }
+        driver.commitTransaction();
+    }
+
+    MBTiles::Driver driver;
+    DataExtentList dataExtents;
+    if (driver.open("bench", options, false, profile, dataExtents, io).failed())
+        return;
+
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+    {
+        if (settings.quick && threads > 4)
+            break;
+
+        std::atomic<std::uint64_t> reads = { 0 };
+        std::atomic_bool done = { false };
+        std::vector<std::thread> workers;
+
+        auto start = bench::Clock::now();
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+                {
+                    std::minstd_rand random(t + 1);
+                    std::uint64_t count = 0, sum = 0;
+                    while (!done)
+                    {
+                        auto r = driver.read(keys[random() % keys.size()], io);
+                        if (r.status.ok())
+                            sum += r.value->data<unsigned char>()[count % tileSize];
+                        ++count;
+                    }
+                    reads += count;
+                    bench::keep(sum);
+                });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(settings.minSeconds));
+        done = true;
+        for (auto& w : workers)
+            w.join();
+
+        double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+        reporter.report(bench::Record{ "mbtiles.read" }
+            .param("threads", (long long)threads)
+            .param("tiles", (long long)keys.size())
+            .metric("reads_per_sec", (double)reads / seconds));
+    }
+
+    driver.close();
+    std::filesystem::remove(filename);
+};
+
+//! Sustained tiles per second written to a new MBTiles database: one
+//! transaction per tile vs. a transaction window vs. batched writes, with
+//! and without the write-ahead log.
+auto Bench_MBTilesWrite = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    std::filesystem::create_directories(settings.workDir);
+    auto filename = (settings.workDir / "write.mbtiles").string();
+
+    const unsigned tileSize = 256;
+    const unsigned batchSize = 256;
+
+    IOOptions io;
+    install_raw_codec(io, tileSize);
+
+    Profile profile("global-geodetic");
+    auto image = make_test_tile(tileSize);
+
+    for (std::string variant : { "single", "transaction", "batch", "batch_wal" })
+    {
+        // committing every tile costs a sync each, so keep that case small
+        unsigned level = (variant == "single" || settings.quick) ? 3 : 5;
+
+        std::filesystem::remove(filename);
+
+        MBTiles::Options options;
+        options.uri = URI(filename);
+        options.format = "application/octet-stream";
+        options.compress = true;
+        options.writeAheadLog = (variant == "batch_wal");
+
+        MBTiles::Driver driver;
+        DataExtentList dataExtents;
+        if (driver.open("bench", options, true, profile, dataExtents, io).failed())
+            return;
+
+        auto [cols, rows] = profile.numTiles(level);
+        std::vector<MBTiles::Tile> batch;
+        unsigned count = 0;
+
+        auto start = bench::Clock::now();
+
+        if (variant == "transaction")
+            driver.beginTransaction();
+
+        for (unsigned y = 0; y < rows; ++y)
+        {
+            for (unsigned x = 0; x < cols; ++x, ++count)
+            {
+                TileKey key(level, x, y, profile);
+
+                if (variant == "single" || variant == "transaction")
+                {
+                    driver.write(key, image, io);
+
+                    if (variant == "transaction" && (count + 1) % batchSize == 0)
+                        driver.commitTransaction(), driver.beginTransaction();
+                }
+                else
+                {
+                    batch.emplace_back(MBTiles::Tile{ key, image });
+                    if (batch.size() >= batchSize)
+                        driver.write(batch, io), batch.clear();
+                }
+            }
+        }
+
+        if (variant == "transaction")
+            driver.commitTransaction();
+        else if (!batch.empty())
+            driver.write(batch, io);
+
+        driver.close();
+
+        double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+        reporter.report(bench::Record{ "mbtiles.write" }
+            .param("variant", variant)
+            .param("tiles", (long long)count)
+            .metric("tiles_per_sec", (double)count / seconds));
+    }
+
+    std::filesystem::remove(filename);
+};
+
+#endif // ROCKY_HAS_MBTILES
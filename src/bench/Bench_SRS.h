@@ -0,0 +1,67 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/SRS.h>
+#include <rocky/Math.h>
+#include <cmath>
+#include <vector>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+//! Points per second through SRSOperation::transformArray for the SRS pairs
+//! the terrain engine uses most (tile extents to ECEF, mercator <-> geodetic,
+//! geodetic to UTM), at a few batch sizes.
+auto Bench_SRSTransformArray = [](const bench::Settings& settings, bench::Reporter& reporter)
+{
+    struct Pair { const char* name; SRS from; SRS to; glm::dvec3 min; glm::dvec3 max; };
+
+    std::vector<Pair> pairs = {
+        { "wgs84>ecef", SRS::WGS84, SRS::ECEF, { -180, -85, 0 }, { 180, 85, 1000 } },
+        { "wgs84>mercator", SRS::WGS84, SRS::SPHERICAL_MERCATOR, { -180, -85, 0 }, { 180, 85, 0 } },
+        { "mercator>wgs84", SRS::SPHERICAL_MERCATOR, SRS::WGS84, { -2e7, -2e7, 0 }, { 2e7, 2e7, 0 } },
+        { "wgs84>utm32", SRS::WGS84, SRS("epsg:32632"), { 6, 0, 0 }, { 12, 60, 0 } }
+    };
+
+    std::vector<std::size_t> counts = { 64, 4096, 65536 };
+    if (settings.quick)
+        counts.resize(2);
+
+    for (auto& pair : pairs)
+    {
+        auto xform = pair.from.to(pair.to);
+        if (!xform.valid())
+            continue;
+
+        for (auto count : counts)
+        {
+            // a regular grid over the test area, like a tile's vertices
+            std::vector<glm::dvec3> source(count);
+            auto side = (std::size_t)std::ceil(std::sqrt((double)count));
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                double u = (double)(i % side) / (double)(side - 1);
+                double v = (double)(i / side) / (double)(side - 1);
+                source[i] = glm::mix(pair.min, pair.max, glm::dvec3(u, v, u * v));
+            }
+
+            std::vector<glm::dvec3> points(count);
+
+            auto t = bench::measure(settings, [&]()
+                {
+                    points = source;
+                    xform.transformArray(points.data(), points.size());
+                    bench::keep((std::uint64_t)points[count / 2].x);
+                });
+
+            reporter.report(bench::Record{ "srs.transform_array" }
+                .param("pair", pair.name)
+                .param("points", (long long)count)
+                .metric("points_per_sec", (double)count * t.perSecond())
+                .metric("ns_per_point", 1e3 * t.microsPerOp() / (double)count));
+        }
+    }
+};
@@ -0,0 +1,137 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+/**
+ * Minimal benchmarking harness for rocky_bench.
+ *
+ * Each benchmark is a function that measures something and reports one or
+ * more Records. Records are printed as JSON lines (one object per line) so
+ * results can be collected and compared across builds.
+ */
+#include <rocky/Common.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    //! Settings shared by all benchmarks
+    struct Settings
+    {
+        //! Minimum time to spend measuring each case
+        double minSeconds = 1.0;
+
+        //! Folder for generated test data
+        std::filesystem::path workDir = std::filesystem::temp_directory_path() / "rocky_bench";
+
+        //! Run reduced workloads (for smoke testing)
+        bool quick = false;
+    };
+
+    //! One result row
+    struct Record
+    {
+        std::string benchmark;
+        std::vector<std::pair<std::string, std::string>> params;
+        std::vector<std::pair<std::string, double>> metrics;
+
+        Record& param(const std::string& name, const std::string& value) {
+            params.emplace_back(name, value);
+            return *this;
+        }
+        Record& param(const std::string& name, long long value) {
+            return param(name, std::to_string(value));
+        }
+        Record& metric(const std::string& name, double value) {
+            metrics.emplace_back(name, value);
+            return *this;
+        }
+    };
+
+    //! Collects records and writes them as JSON lines
+    class Reporter
+    {
+    public:
+        std::ofstream file;
+
+        void report(const Record& r)
+        {
+            auto line = to_json(r);
+            std::cout << line << std::endl;
+            if (file.is_open())
+                file << line << std::endl;
+        }
+
+    private:
+        static std::string escape(const std::string& in)
+        {
+            std::string out;
+            for (auto c : in) {
+                if (c == '"' || c == '\\') out.push_back('\\');
+                out.push_back(c);
+            }
+            return out;
+        }
+
+        static std::string to_json(const Record& r)
+        {
+            std::string s = "{\"benchmark\":\"" + escape(r.benchmark) + "\"";
+            for (auto& p : r.params)
+                s += ",\"" + escape(p.first) + "\":\"" + escape(p.second) + "\"";
+            for (auto& m : r.metrics)
+                s += ",\"" + escape(m.first) + "\":" + std::to_string(m.second);
+            return s + "}";
+        }
+    };
+
+    //! Outcome of a timed loop
+    struct Timing
+    {
+        std::uint64_t iterations = 0;
+        double seconds = 0.0;
+
+        double perSecond() const { return seconds > 0.0 ? (double)iterations / seconds : 0.0; }
+        double microsPerOp() const { return iterations > 0 ? 1e6 * seconds / (double)iterations : 0.0; }
+    };
+
+    //! Calls "func" repeatedly until at least settings.minSeconds have elapsed
+    //! (after one warm-up call) and returns the number of calls and the time taken.
+    template<typename FUNC>
+    Timing measure(const Settings& settings, FUNC&& func)
+    {
+        func(); // warm up
+
+        Timing t;
+        auto start = Clock::now();
+        do {
+            func();
+            ++t.iterations;
+            t.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (t.seconds < settings.minSeconds);
+        return t;
+    }
+
+    //! Prevent the optimizer from discarding a computed value
+    inline void keep(std::uint64_t value)
+    {
+        static volatile std::uint64_t sink = 0;
+        sink = sink + value;
+    }
+
+    //! A named benchmark
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(const Settings&, Reporter&)> run;
+    };
+}
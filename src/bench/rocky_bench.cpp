@@ -0,0 +1,110 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * ROCKY_BENCH runs headless micro-benchmarks against the core library and
+ * prints the results as JSON lines, one record per line. No window or GPU
+ * is required.
+ *
+ * Usage: rocky_bench [--filter <substring>] [--out <file.jsonl>] [--time <seconds>] [--quick]
+ */
+#include <rocky/Context.h>
+#include <rocky/Version.h>
+#include "bench.h"
+
+#include "Bench_IO.h"
+#include "Bench_Jobs.h"
+#include "Bench_SRS.h"
+#include "Bench_Image.h"
+#include "Bench_Elevation.h"
+#include "Bench_Containers.h"
+#include "Bench_MBTiles.h"
+#include "Bench_GDAL.h"
+
+int usage(const char* msg)
+{
+    std::cout << msg << std::endl
+        << "  --filter <substring>  Only run benchmarks whose name contains substring" << std::endl
+        << "  --out <file>          Also write JSON lines to a file" << std::endl
+        << "  --time <seconds>      Minimum measuring time per case (default 1.0)" << std::endl
+        << "  --dir <folder>        Folder for generated test data" << std::endl
+        << "  --quick               Run reduced workloads" << std::endl
+        << "  --list                List the available benchmarks" << std::endl;
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<bench::Benchmark> benchmarks = {
+        { "io.read_local", Bench_ReadLocal },
+        { "jobs.scheduling", Bench_JobScheduling },
+        { "jobs.dispatch", Bench_JobDispatch },
+        { "jobs.stealing", Bench_JobStealing },
+        { "srs.transform_array", Bench_SRSTransformArray },
+        { "image.read_bilinear", Bench_ImageReadBilinear },
+        { "image.mipmaps", Bench_ImageMipmaps },
+        { "image.block_compression", Bench_BlockCompression },
+        { "geoimage.reproject", Bench_GeoImageReproject },
+        { "geoimage.composite", Bench_GeoImageComposite },
+        { "elevation.populate_heightfield", Bench_PopulateHeightfield },
+        { "tilekey", Bench_TileKey },
+        { "lrucache.contention", Bench_LRUCacheContention },
+#ifdef ROCKY_HAS_MBTILES
+        { "mbtiles.read", Bench_MBTilesRead },
+        { "mbtiles.write", Bench_MBTilesWrite },
+#endif
+#ifdef ROCKY_HAS_GDAL
+        { "gdal.siblings", Bench_GDALSiblings },
+#endif
+    };
+
+    bench::Settings settings;
+    bench::Reporter reporter;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--out" && hasValue)
+            reporter.file.open(argv[++i]);
+        else if (arg == "--time" && hasValue)
+            settings.minSeconds = std::atof(argv[++i]);
+        else if (arg == "--dir" && hasValue)
+            settings.workDir = argv[++i];
+        else if (arg == "--quick")
+            settings.quick = true, settings.minSeconds = std::min(settings.minSeconds, 0.1);
+        else if (arg == "--list")
+        {
+            for (auto& b : benchmarks)
+                std::cout << b.name << std::endl;
+            return 0;
+        }
+        else
+            return usage(argv[0]);
+    }
+
+    rocky::Log()->set_level(rocky::log::level::warn);
+
+    // context sets up the runtime environment (GDAL, thread naming, etc.)
+    auto context = rocky::ContextFactory::create();
+
+    for (auto& b : benchmarks)
+    {
+        if (filter.empty() || b.name.find(filter) != std::string::npos)
+        {
+            b.run(settings, reporter);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(settings.workDir, ec);
+
+    return 0;
+}
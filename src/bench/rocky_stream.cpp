@@ -0,0 +1,485 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * ROCKY_STREAM measures terrain paging. It flies a camera along a path of
+ * viewpoints and runs the terrain engine's tile pager (ping, update, load,
+ * merge) and TerrainTileModelFactory exactly as a viewer would, but with no
+ * window, swapchain, or GPU work. Results are printed as JSON lines like
+ * rocky_bench's, one record per viewpoint plus a summary.
+ *
+ * With --upload-budget, texture uploads go through the pager's batched upload
+ * path. Without a device the compile step does nothing, so the upload metrics
+ * measure the scheduling (bytes per frame, batching) rather than transfer time.
+ *
+ * Usage: rocky_stream --map <file.json> [--path <viewpoints.json>] [options]
+ *
+ * A path file is a JSON array of viewpoints, for example:
+ *   [ { "name": "alps", "lat": 46.5, "long": 8.0, "heading": "30", "pitch": "-25", "range": "40km" } ]
+ * Without one, a built-in path zooms from space into the Alps and back out.
+ */
+#include <rocky/rocky.h>
+#include <rocky/Memory.h>
+#include <rocky/vsg/VSGContext.h>
+#include <rocky/vsg/terrain/TerrainNode.h>
+#include <rocky/vsg/terrain/TerrainEngine.h>
+#include <rocky/vsg/terrain/TerrainTileNode.h>
+#include <rocky/vsg/terrain/TerrainView.h>
+#include <rocky/json.h>
+
+#include <vsg/all.h>
+#include <cmath>
+#include <thread>
+#include "bench.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    struct Options
+    {
+        double fovy = 30.0;
+        double width = 1920.0;
+        double height = 1080.0;
+        double fps = 60.0;
+        unsigned flyFrames = 120;
+        double timeout = 60.0;
+        unsigned settleFrames = 10;
+    };
+
+    // the default path: from space, into the Alps, across them, and back out
+    struct Stop { const char* name; double lat, lon, heading, pitch, range; };
+
+    std::vector<Viewpoint> make_path(const std::vector<Stop>& stops)
+    {
+        std::vector<Viewpoint> path;
+        for (auto& stop : stops)
+        {
+            Viewpoint vp;
+            vp.name = stop.name;
+            vp.point = GeoPoint(SRS::WGS84, stop.lon, stop.lat, 0.0);
+            vp.heading = Angle(stop.heading, Units::DEGREES);
+            vp.pitch = Angle(stop.pitch, Units::DEGREES);
+            vp.range = Distance(stop.range, Units::METERS);
+            path.emplace_back(vp);
+        }
+        return path;
+    }
+
+    // zooms in and out through progressively finer detail
+    std::vector<Viewpoint> default_path()
+    {
+        return make_path({
+            { "globe", 20.0, 0.0, 0.0, -90.0, 2.0e7 },
+            { "europe", 46.0, 8.0, 0.0, -75.0, 2.0e6 },
+            { "alps", 46.5, 8.0, 30.0, -40.0, 1.5e5 },
+            { "jungfrau", 46.54, 7.96, 30.0, -20.0, 1.5e4 },
+            { "matterhorn", 45.98, 7.66, 200.0, -20.0, 1.5e4 },
+            { "leave", 45.98, 7.66, 0.0, -90.0, 5.0e6 }
+        });
+    }
+
+    // jumps between orbit and street level, so each arrival needs many new LODs at once
+    std::vector<Viewpoint> dive_path()
+    {
+        return make_path({
+            { "orbit", 46.0, 7.7, 0.0, -90.0, 2.0e7 },
+            { "zermatt", 46.02, 7.75, 45.0, -25.0, 1.0e3 },
+            { "orbit again", 46.0, 7.7, 0.0, -90.0, 2.0e7 },
+            { "new york", 40.75, -73.99, 210.0, -30.0, 1.0e3 }
+        });
+    }
+
+    Result<std::vector<Viewpoint>> read_path(const std::string& filename, const IOOptions& io)
+    {
+        auto r = URI(filename).read(io);
+        if (r.status.failed())
+            return r.status;
+
+        auto j = parse_json(r->data.str());
+        if (j.status.failed() || !j.is_array())
+            return Status(Status::ConfigurationError, "Path must be a JSON array of viewpoints");
+
+        std::vector<Viewpoint> path;
+        for (auto& item : j)
+        {
+            // viewpoint fields plus a focal point ("lat", "long", optional "srs") in the same object
+            Viewpoint vp;
+            get_to(item, vp);
+            get_to(item, vp.point);
+            if (vp.valid())
+                path.emplace_back(vp);
+        }
+
+        if (path.empty())
+            return Status(Status::ConfigurationError, "Path contains no valid viewpoints");
+
+        return path;
+    }
+
+    // Camera looking at the viewpoint's focal point from "range" away, along its heading and pitch
+    TerrainView make_view(const Viewpoint& vp, const SRS& worldSRS, const Options& options)
+    {
+        auto focal = vp.position().transform(worldSRS);
+        glm::dvec3 center(focal.x, focal.y, focal.z);
+
+        glm::dmat4 local2world = worldSRS.isGeocentric() ?
+            worldSRS.ellipsoid().topocentricToGeocentricMatrix(center) :
+            glm::translate(glm::dmat4(1.0), center);
+
+        double h = vp.heading->as(Units::RADIANS);
+        double p = vp.pitch->as(Units::RADIANS);
+        double range = vp.range->as(Units::METERS);
+
+        glm::dvec3 forward(std::sin(h) * std::cos(p), std::cos(h) * std::cos(p), std::sin(p));
+        glm::dvec3 up(-std::sin(h) * std::sin(p), -std::cos(h) * std::sin(p), std::cos(p));
+
+        glm::dvec3 eye = local2world * glm::dvec4(-forward * range, 1.0);
+        glm::dvec3 worldUp = local2world * glm::dvec4(up, 0.0);
+
+        auto view = TerrainView::lookAt(
+            vsg::dvec3(eye.x, eye.y, eye.z),
+            vsg::dvec3(center.x, center.y, center.z),
+            vsg::dvec3(worldUp.x, worldUp.y, worldUp.z),
+            options.fovy, options.width / options.height, options.height);
+
+        return view;
+    }
+
+    // camera part way between two viewpoints
+    Viewpoint interpolate(const Viewpoint& a, const Viewpoint& b, double t)
+    {
+        // smooth start and stop
+        t = t * t * (3.0 - 2.0 * t);
+
+        auto pa = a.position().transform(SRS::WGS84);
+        auto pb = b.position().transform(SRS::WGS84);
+
+        double dlon = pb.x - pa.x;
+        if (dlon > 180.0) dlon -= 360.0;
+        else if (dlon < -180.0) dlon += 360.0;
+
+        double dh = b.heading->as(Units::DEGREES) - a.heading->as(Units::DEGREES);
+        if (dh > 180.0) dh -= 360.0;
+        else if (dh < -180.0) dh += 360.0;
+
+        Viewpoint vp;
+        vp.point = GeoPoint(SRS::WGS84, pa.x + dlon * t, pa.y + (pb.y - pa.y) * t, 0.0);
+        vp.heading = Angle(a.heading->as(Units::DEGREES) + dh * t, Units::DEGREES);
+        vp.pitch = Angle(glm::mix(a.pitch->as(Units::DEGREES), b.pitch->as(Units::DEGREES), t), Units::DEGREES);
+
+        // zoom geometrically so the flight spends equal time at each scale
+        double ra = a.range->as(Units::METERS), rb = b.range->as(Units::METERS);
+        vp.range = Distance(ra * std::pow(rb / ra, t), Units::METERS);
+        return vp;
+    }
+
+    int usage(const char* msg)
+    {
+        std::cout << msg << std::endl
+            << "Usage: rocky_stream --map <file.json> [options]" << std::endl
+            << "  --path <file.json>      Camera path (JSON array of viewpoints)" << std::endl
+            << "  --dive                  Built-in path of orbit-to-street jumps" << std::endl
+            << "  --out <file>            Also write JSON lines to a file" << std::endl
+            << "  --sse <pixels>          Terrain screen-space error" << std::endl
+            << "  --concurrency <n>       Terrain loader threads" << std::endl
+            << "  --tile-size <n>         Terrain tile size in vertices" << std::endl
+            << "  --prioritized           Load tiles in screen-space-error order" << std::endl
+            << "  --max-loads <n>         Loads in flight with --prioritized" << std::endl
+            << "  --skip-lod              Non-progressive loading (skip intermediate LODs)" << std::endl
+            << "  --merge-budget <us>     Time per frame for merging tile data" << std::endl
+            << "  --cpu-budget <mb>       Terrain tile CPU memory limit" << std::endl
+            << "  --gpu-budget <mb>       Terrain tile GPU memory limit" << std::endl
+            << "  --upload-budget <kb>    Texture upload per frame (batched uploads)" << std::endl
+            << "  --mipmaps               Generate imagery mipmaps on the loader threads" << std::endl
+            << "  --fov <degrees>         Vertical field of view (default 30)" << std::endl
+            << "  --viewport <w> <h>      Viewport size in pixels (default 1920 1080)" << std::endl
+            << "  --fps <n>               Simulated frame rate (default 60)" << std::endl
+            << "  --fly-frames <n>        Frames to fly between viewpoints (default 120, 0 with --dive)" << std::endl
+            << "  --timeout <seconds>     Give up waiting for full detail after this long (default 60)" << std::endl;
+        return -1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+    if (arguments.read({ "--help" }))
+        return usage(argv[0]);
+
+    Options options;
+    std::string mapFile, pathFile, outFile;
+    arguments.read("--map", mapFile);
+    arguments.read("--path", pathFile);
+    arguments.read("--out", outFile);
+    bool dive = arguments.read("--dive");
+    if (dive)
+        options.flyFrames = 0;
+    arguments.read("--fov", options.fovy);
+    arguments.read("--viewport", options.width, options.height);
+    arguments.read("--fps", options.fps);
+    arguments.read("--fly-frames", options.flyFrames);
+    arguments.read("--timeout", options.timeout);
+
+    if (mapFile.empty())
+        return usage("Missing required argument --map");
+
+    rocky::Log()->set_level(rocky::log::level::warn);
+
+    // A viewer with no windows: it runs update operations but never compiles or draws.
+    auto viewer = vsg::Viewer::create();
+    auto context = VSGContextFactory::create(viewer);
+    auto io = context->io.from(mapFile);
+
+    auto map_file = URI(mapFile).read(io);
+    if (map_file.status.failed())
+        return usage(map_file.status.message.c_str());
+
+    // accept either a bare map or a map node file (with "map", "profile" and "terrain" sections)
+    auto map = Map::create();
+    auto terrain = TerrainNode::create();
+    Profile profile("global-geodetic");
+
+    auto j = parse_json(map_file->data.str());
+    if (j.contains("map"))
+    {
+        map->from_json(j.at("map").dump(), io);
+        get_to(j, "profile", profile);
+        if (j.contains("terrain"))
+            terrain->from_json(j.at("terrain").dump(), io);
+    }
+    else
+    {
+        map->from_json(map_file->data.str(), io);
+    }
+
+    float sse;
+    unsigned concurrency, tileSize, maxLoads, mergeBudget, cpuBudget, gpuBudget, uploadBudget;
+    if (arguments.read("--sse", sse))
+        terrain->screenSpaceError = sse;
+    if (arguments.read("--concurrency", concurrency))
+        terrain->concurrency = concurrency;
+    if (arguments.read("--tile-size", tileSize))
+        terrain->tileSize = tileSize;
+    if (arguments.read("--merge-budget", mergeBudget))
+        terrain->mergeBudgetMicros = mergeBudget;
+    if (arguments.read("--cpu-budget", cpuBudget))
+        terrain->cpuBudgetMB = cpuBudget;
+    if (arguments.read("--gpu-budget", gpuBudget))
+        terrain->gpuBudgetMB = gpuBudget;
+    if (arguments.read("--upload-budget", uploadBudget))
+        terrain->uploadBudgetKB = uploadBudget;
+    if (arguments.read("--mipmaps"))
+        terrain->colorMipmaps = true;
+    if (arguments.read("--skip-lod"))
+        terrain->progressive = false;
+    if (arguments.read("--prioritized"))
+        terrain->prioritizedLoading = true;
+    if (arguments.read("--max-loads", maxLoads))
+        terrain->maxLoadsInFlight = maxLoads;
+
+    if (arguments.errors())
+        return usage("Invalid arguments");
+
+    auto path = dive ? dive_path() : default_path();
+    if (!pathFile.empty())
+    {
+        auto r = read_path(pathFile, io);
+        if (r.status.failed())
+            return usage(r.status.message.c_str());
+        path = r.value;
+    }
+
+    auto status = map->openAllLayers(io);
+    if (status.failed())
+        Log()->warn("Problem opening layers: {}", status.message);
+
+    terrain->setMap(map, profile, context);
+
+    // the first update builds the root tiles
+    terrain->update(context);
+    if (terrain->status.failed())
+        return usage(terrain->status.message.c_str());
+
+    auto engine = terrain->engine;
+    auto pool = jobs::get_pool(engine->loadSchedulerName);
+
+    std::vector<vsg::ref_ptr<TerrainTileNode>> roots;
+    for (auto& child : terrain->stategroup->children)
+    {
+        if (auto group = child->cast<vsg::Group>())
+            for (auto& node : group->children)
+                if (auto tile = node->cast<TerrainTileNode>())
+                    roots.emplace_back(vsg::ref_ptr<TerrainTileNode>(tile));
+    }
+
+    // pings don't read the traversal; they only need one to pass along
+    vsg::ref_ptr<vsg::RecordTraversal> rv(new vsg::RecordTraversal());
+
+    auto horizon = engine->worldSRS.isGeocentric() ? std::make_shared<Horizon>(engine->worldSRS.ellipsoid()) : nullptr;
+
+    bench::Reporter reporter;
+    if (!outFile.empty())
+        reporter.file.open(outFile);
+
+    auto frameTime = std::chrono::duration_cast<bench::Clock::duration>(std::chrono::duration<double>(1.0 / options.fps));
+    std::uint64_t frameCount = 0;
+
+    // runs one frame in the same order as the viewer: update, then record
+    auto frame = [&](const Viewpoint& vp)
+        {
+            auto start = bench::Clock::now();
+            auto fs = vsg::FrameStamp::create();
+            fs->time = vsg::clock::now();
+            fs->frameCount = ++frameCount;
+
+            viewer->updateOperations->run();
+            context->update();
+            bool changes = engine->tiles.update(fs, context->io, engine);
+            pool->reprioritize();
+            engine->geometryPool.sweep(engine->context);
+
+            auto view = make_view(vp, engine->worldSRS, options);
+            view.frameStamp = fs;
+            if (horizon)
+            {
+                horizon->setEye(glm::dvec3(view.eye.x, view.eye.y, view.eye.z));
+                view.horizon = horizon;
+            }
+
+            for (auto& root : roots)
+                root->traverse(view, *rv);
+
+            std::this_thread::sleep_until(start + frameTime);
+            return changes;
+        };
+
+    auto runStart = bench::Clock::now();
+    auto firstStats = engine->tiles.stats();
+    std::size_t overallPeakTiles = 0;
+    std::int64_t overallPeakMemory = 0;
+    unsigned timeouts = 0;
+
+    for (unsigned i = 0; i < path.size(); ++i)
+    {
+        auto legStart = bench::Clock::now();
+        auto legStats = engine->tiles.stats();
+        std::size_t peakTiles = 0;
+        std::int64_t peakMemory = 0;
+        std::uint64_t peakMergeMicros = 0, peakMergeBacklog = 0;
+        std::uint64_t peakUploadBytes = 0, peakUploadBacklog = 0;
+        TerrainResidency::Bytes peakResident;
+
+        auto sample = [&]()
+            {
+                peakTiles = std::max(peakTiles, engine->tiles.size());
+                auto s = engine->tiles.stats();
+                peakMergeMicros = std::max(peakMergeMicros, s.mergeMicros);
+                peakMergeBacklog = std::max(peakMergeBacklog, s.mergeBacklog);
+                peakUploadBytes = std::max(peakUploadBytes, s.uploadBytes);
+                peakUploadBacklog = std::max(peakUploadBacklog, s.uploadBacklog);
+                peakResident.cpu = std::max(peakResident.cpu, s.residentBytes.cpu);
+                peakResident.gpu = std::max(peakResident.gpu, s.residentBytes.gpu);
+                if (frameCount % 10 == 0)
+                    peakMemory = std::max(peakMemory, Memory::getProcessPhysicalUsage());
+            };
+
+        // fly from the previous viewpoint
+        if (i > 0)
+        {
+            for (unsigned f = 0; f < options.flyFrames; ++f)
+            {
+                frame(interpolate(path[i - 1], path[i], (double)f / (double)options.flyFrames));
+                sample();
+            }
+        }
+
+        // hold still until nothing is loading or changing
+        auto arrival = bench::Clock::now();
+        unsigned quietFrames = 0;
+        bool timedOut = false;
+        while (quietFrames < options.settleFrames)
+        {
+            bool changes = frame(path[i]);
+            sample();
+
+            auto metrics = pool->metrics();
+            bool idle = !changes && metrics->pending == 0 && metrics->running == 0;
+            quietFrames = idle ? quietFrames + 1 : 0;
+
+            if (std::chrono::duration<double>(bench::Clock::now() - arrival).count() > options.timeout)
+            {
+                timedOut = true;
+                ++timeouts;
+                break;
+            }
+        }
+
+        // don't count the quiet frames used to detect completion
+        auto done = bench::Clock::now() - (timedOut ? bench::Clock::duration(0) : frameTime * options.settleFrames);
+        double legSeconds = std::chrono::duration<double>(done - legStart).count();
+        auto stats = engine->tiles.stats();
+        auto loaded = stats.loadsMerged - legStats.loadsMerged;
+
+        overallPeakTiles = std::max(overallPeakTiles, peakTiles);
+        overallPeakMemory = std::max(overallPeakMemory, peakMemory);
+
+        reporter.report(bench::Record{ "terrain.streaming" }
+            .param("viewpoint", path[i].name.value_or("viewpoint " + std::to_string(i)))
+            .param("sse", std::to_string(terrain->screenSpaceError.value()))
+            .param("concurrency", (long long)terrain->concurrency.value())
+            .param("loading", terrain->prioritizedLoading.value() ? "prioritized" : "fifo")
+            .param("lod", terrain->progressive.value() ? "progressive" : "skip")
+            .param("upload_budget_kb", (long long)terrain->uploadBudgetKB.value())
+            .param("mipmaps", terrain->colorMipmaps.value() ? "true" : "false")
+            .param("timed_out", timedOut ? "true" : "false")
+            .metric("time_to_full_detail_ms", 1e3 * std::chrono::duration<double>(done - arrival).count())
+            .metric("tiles_loaded", (double)loaded)
+            .metric("tiles_per_sec", legSeconds > 0.0 ? (double)loaded / legSeconds : 0.0)
+            .metric("peak_tiles", (double)peakTiles)
+            .metric("peak_memory_mb", (double)peakMemory / 1048576.0)
+            .metric("canceled_loads", (double)(stats.loadsCanceled - legStats.loadsCanceled))
+            .metric("discarded_loads", (double)(stats.loadsDiscarded - legStats.loadsDiscarded))
+            .metric("max_merge_ms", 1e-3 * (double)peakMergeMicros)
+            .metric("peak_merge_backlog", (double)peakMergeBacklog)
+            .metric("peak_tile_cpu_mb", (double)peakResident.cpu / 1048576.0)
+            .metric("peak_tile_gpu_mb", (double)peakResident.gpu / 1048576.0)
+            .metric("evicted_tiles", (double)(stats.tilesEvicted - legStats.tilesEvicted))
+            .metric("peak_upload_mb_per_frame", (double)peakUploadBytes / 1048576.0)
+            .metric("peak_upload_backlog", (double)peakUploadBacklog)
+            .metric("upload_stalls_avoided", (double)(stats.uploadStallsAvoided - legStats.uploadStallsAvoided)));
+    }
+
+    double seconds = std::chrono::duration<double>(bench::Clock::now() - runStart).count();
+    auto stats = engine->tiles.stats();
+    auto requested = stats.loadsRequested - firstStats.loadsRequested;
+    auto wasted = (stats.loadsCanceled - firstStats.loadsCanceled) + (stats.loadsDiscarded - firstStats.loadsDiscarded);
+
+    reporter.report(bench::Record{ "terrain.streaming.total" }
+        .param("sse", std::to_string(terrain->screenSpaceError.value()))
+        .param("concurrency", (long long)terrain->concurrency.value())
+        .param("loading", terrain->prioritizedLoading.value() ? "prioritized" : "fifo")
+        .param("lod", terrain->progressive.value() ? "progressive" : "skip")
+        .param("upload_budget_kb", (long long)terrain->uploadBudgetKB.value())
+        .param("mipmaps", terrain->colorMipmaps.value() ? "true" : "false")
+        .metric("seconds", seconds)
+        .metric("frames", (double)frameCount)
+        .metric("loads_requested", (double)requested)
+        .metric("tiles_loaded", (double)(stats.loadsMerged - firstStats.loadsMerged))
+        .metric("wasted_load_ratio", requested > 0 ? (double)wasted / (double)requested : 0.0)
+        .metric("peak_tiles", (double)overallPeakTiles)
+        .metric("peak_memory_mb", (double)overallPeakMemory / 1048576.0)
+        .metric("timeouts", (double)timeouts)
+        .metric("peak_tile_cpu_mb", (double)stats.peakResidentBytes.cpu / 1048576.0)
+        .metric("peak_tile_gpu_mb", (double)stats.peakResidentBytes.gpu / 1048576.0)
+        .metric("upload_mb_per_frame", frameCount > 0 ?
+            (double)(stats.uploadBytesTotal - firstStats.uploadBytesTotal) / 1048576.0 / (double)frameCount : 0.0)
+        .metric("upload_batches", (double)(stats.uploadBatches - firstStats.uploadBatches))
+        .metric("upload_stalls_avoided", (double)(stats.uploadStallsAvoided - firstStats.uploadStallsAvoided)));
+
+    engine->tiles.releaseAll();
+    return 0;
+}
@@ -119,7 +119,7 @@ AzureImageLayer::createImageImplementation(const TileKey& key, const IOOptions&
         return fetch.status;
     }
 
-    std::istringstream buf(fetch->data);
+    BufferStream buf(fetch->data);
     auto image_rr = io.services.readImageFromStream(buf, fetch->contentType, io);
 
     if (image_rr.status.failed())
@@ -0,0 +1,657 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::util;
+
+namespace
+{
+    using uchar = unsigned char;
+
+    // 16 RGBA8 pixels, row by row
+    struct Block
+    {
+        uchar p[16][4];
+    };
+
+    // BC7 interpolation weights for 4-bit indices (out of 64)
+    const int bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Reads the 4x4 block at block column bx, row by. Pixels past the
+    // right or bottom edge repeat the last column or row.
+    void fetch(const uchar* data, unsigned width, unsigned height, unsigned components, unsigned bx, unsigned by, Block& block)
+    {
+        for (unsigned y = 0; y < 4; ++y)
+        {
+            unsigned t = std::min(by * 4 + y, height - 1);
+            for (unsigned x = 0; x < 4; ++x)
+            {
+                unsigned s = std::min(bx * 4 + x, width - 1);
+                const uchar* src = data + (t * width + s) * components;
+                uchar* dst = block.p[y * 4 + x];
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = components == 4 ? src[3] : 255;
+            }
+        }
+    }
+
+    // LSB-first bit packing, as BC7 blocks are laid out
+    struct BitWriter
+    {
+        uchar* out;
+        unsigned pos = 0;
+
+        void put(unsigned value, unsigned count)
+        {
+            for (unsigned i = 0; i < count; ++i, ++pos)
+                if (value & (1u << i))
+                    out[pos >> 3] |= (uchar)(1u << (pos & 7));
+        }
+    };
+
+    struct BitReader
+    {
+        const uchar* in;
+        unsigned pos = 0;
+
+        unsigned get(unsigned count)
+        {
+            unsigned value = 0;
+            for (unsigned i = 0; i < count; ++i, ++pos)
+                value |= ((in[pos >> 3] >> (pos & 7)) & 1u) << i;
+            return value;
+        }
+    };
+
+    inline float clamp255(float v)
+    {
+        return std::min(std::max(v, 0.0f), 255.0f);
+    }
+
+    // Endpoints spanning the block's bounding box in the first n channels.
+    // Channels that fall while the widest one rises get their ends swapped,
+    // so the line follows the colors instead of always running min-to-max.
+    void bounds(const Block& block, unsigned n, float lo[4], float hi[4])
+    {
+        for (unsigned c = 0; c < n; ++c)
+        {
+            lo[c] = 255.0f, hi[c] = 0.0f;
+            for (auto& p : block.p)
+            {
+                lo[c] = std::min(lo[c], (float)p[c]);
+                hi[c] = std::max(hi[c], (float)p[c]);
+            }
+        }
+
+        unsigned widest = 0;
+        for (unsigned c = 1; c < n; ++c)
+            if (hi[c] - lo[c] > hi[widest] - lo[widest])
+                widest = c;
+
+        for (unsigned c = 0; c < n; ++c)
+        {
+            if (c == widest)
+                continue;
+
+            float mid_w = 0.5f * (lo[widest] + hi[widest]), mid_c = 0.5f * (lo[c] + hi[c]);
+            float cov = 0.0f;
+            for (auto& p : block.p)
+                cov += ((float)p[widest] - mid_w) * ((float)p[c] - mid_c);
+
+            if (cov < 0.0f)
+                std::swap(lo[c], hi[c]);
+        }
+    }
+
+    // Endpoints at the extremes of the block's principal axis (the direction
+    // of greatest variance) in the first n channels, found by power iteration
+    // starting from the bounding-box diagonal in lo/hi.
+    void principalAxis(const Block& block, unsigned n, float lo[4], float hi[4])
+    {
+        float mean[4] = { 0, 0, 0, 0 };
+        for (auto& p : block.p)
+            for (unsigned c = 0; c < n; ++c)
+                mean[c] += (float)p[c] / 16.0f;
+
+        float cov[4][4] = { };
+        for (auto& p : block.p)
+            for (unsigned i = 0; i < n; ++i)
+                for (unsigned j = 0; j < n; ++j)
+                    cov[i][j] += ((float)p[i] - mean[i]) * ((float)p[j] - mean[j]);
+
+        float axis[4] = { 0, 0, 0, 0 };
+        for (unsigned c = 0; c < n; ++c)
+            axis[c] = hi[c] - lo[c];
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = { 0, 0, 0, 0 }, largest = 0.0f;
+            for (unsigned i = 0; i < n; ++i)
+            {
+                for (unsigned j = 0; j < n; ++j)
+                    next[i] += cov[i][j] * axis[j];
+                largest = std::max(largest, std::fabs(next[i]));
+            }
+            if (largest <= 0.0f)
+                return; // flat block; keep the bounding box
+            for (unsigned c = 0; c < n; ++c)
+                axis[c] = next[c] / largest;
+        }
+
+        float length2 = 0.0f;
+        for (unsigned c = 0; c < n; ++c)
+            length2 += axis[c] * axis[c];
+        if (length2 <= 0.0f)
+            return;
+
+        float tmin = FLT_MAX, tmax = -FLT_MAX;
+        for (auto& p : block.p)
+        {
+            float t = 0.0f;
+            for (unsigned c = 0; c < n; ++c)
+                t += ((float)p[c] - mean[c]) * axis[c];
+            t /= length2;
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+
+        for (unsigned c = 0; c < n; ++c)
+        {
+            lo[c] = clamp255(mean[c] + axis[c] * tmin);
+            hi[c] = clamp255(mean[c] + axis[c] * tmax);
+        }
+    }
+
+    // Least-squares endpoints for the given per-pixel weights, where each pixel
+    // is approximated by lo + (hi - lo) * weight.
+    // @return false if the weights don't determine the endpoints
+    bool refine(const Block& block, unsigned n, const float weights[16], float lo[4], float hi[4])
+    {
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[4] = { 0, 0, 0, 0 }, bx[4] = { 0, 0, 0, 0 };
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            float b = weights[i], a = 1.0f - b;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (unsigned c = 0; c < n; ++c)
+            {
+                ax[c] += a * (float)block.p[i][c];
+                bx[c] += b * (float)block.p[i][c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+
+        for (unsigned c = 0; c < n; ++c)
+        {
+            lo[c] = clamp255((ax[c] * bb - bx[c] * ab) / det);
+            hi[c] = clamp255((bx[c] * aa - ax[c] * ab) / det);
+        }
+        return true;
+    }
+
+    inline unsigned pack565(const float c[4])
+    {
+        unsigned r = (unsigned)std::lround(c[0] * 31.0f / 255.0f);
+        unsigned g = (unsigned)std::lround(c[1] * 63.0f / 255.0f);
+        unsigned b = (unsigned)std::lround(c[2] * 31.0f / 255.0f);
+        return (r << 11) | (g << 5) | b;
+    }
+
+    inline void unpack565(unsigned c, int rgb[3])
+    {
+        int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // the four colors of a BC1 block in four-color mode
+    void palette565(unsigned c0, unsigned c1, int palette[4][3])
+    {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+    }
+
+    // Writes a four-color-mode BC1 color block for endpoints lo and hi.
+    // @return squared error; weights receive each pixel's position from lo to hi
+    int encodeColor(const Block& block, const float lo[4], const float hi[4], uchar out[8], float weights[16])
+    {
+        unsigned c0 = pack565(hi), c1 = pack565(lo);
+        bool swapped = c0 < c1;
+        if (swapped)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        palette565(c0, c1, palette);
+
+        // weight of "hi" in each palette entry
+        const float position[4] = {
+            swapped ? 0.0f : 1.0f, swapped ? 1.0f : 0.0f,
+            swapped ? 1.0f / 3.0f : 2.0f / 3.0f, swapped ? 2.0f / 3.0f : 1.0f / 3.0f };
+
+        std::uint32_t indices = 0;
+        int error = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = INT_MAX;
+            for (int e = 0; e < 4; ++e)
+            {
+                int err = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    int d = (int)block.p[i][c] - palette[e][c];
+                    err += d * d;
+                }
+                if (err < bestError)
+                    best = e, bestError = err;
+            }
+            indices |= (std::uint32_t)best << (2 * i);
+            weights[i] = position[best];
+            error += bestError;
+        }
+
+        out[0] = (uchar)(c0 & 0xff); out[1] = (uchar)(c0 >> 8);
+        out[2] = (uchar)(c1 & 0xff); out[3] = (uchar)(c1 >> 8);
+        for (int b = 0; b < 4; ++b)
+            out[4 + b] = (uchar)(indices >> (8 * b));
+
+        return error;
+    }
+
+    void encodeColorBlock(const Block& block, bool quality, uchar out[8])
+    {
+        float lo[4], hi[4], weights[16];
+        bounds(block, 3, lo, hi);
+        int best = encodeColor(block, lo, hi, out, weights);
+
+        if (quality && best > 0)
+        {
+            uchar trial[8];
+            principalAxis(block, 3, lo, hi);
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+                int error = encodeColor(block, lo, hi, trial, weights);
+                if (error < best)
+                {
+                    best = error;
+                    memcpy(out, trial, 8);
+                }
+                if (!refine(block, 3, weights, lo, hi))
+                    break;
+            }
+        }
+    }
+
+    // the eight alphas of a BC3 alpha block (a0 > a1) or six plus 0 and 255 (a0 <= a1)
+    void paletteAlpha(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encodeAlphaBlock(const Block& block, uchar out[8])
+    {
+        int a0 = 0, a1 = 255;
+        for (auto& p : block.p)
+        {
+            a0 = std::max(a0, (int)p[3]);
+            a1 = std::min(a1, (int)p[3]);
+        }
+
+        memset(out, 0, 8);
+        out[0] = (uchar)a0;
+        out[1] = (uchar)a1;
+        if (a0 == a1)
+            return;
+
+        int palette[8];
+        paletteAlpha(a0, a1, palette);
+
+        std::uint64_t indices = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            for (int e = 1; e < 8; ++e)
+                if (std::abs(palette[e] - (int)block.p[i][3]) < std::abs(palette[best] - (int)block.p[i][3]))
+                    best = e;
+            indices |= (std::uint64_t)best << (3 * i);
+        }
+
+        for (int b = 0; b < 6; ++b)
+            out[2 + b] = (uchar)(indices >> (8 * b));
+    }
+
+    // Quantizes an RGBA endpoint to 7 bits per channel plus a shared
+    // low bit (the "p-bit"), picking the p-bit with the smaller error.
+    void quantize7p(const float in[4], int q[4], int& pbit)
+    {
+        int bestError = INT_MAX;
+        for (int p = 0; p < 2; ++p)
+        {
+            int trial[4], error = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                trial[c] = std::min(std::max((int)std::lround((in[c] - (float)p) * 0.5f), 0), 127);
+                int d = ((trial[c] << 1) | p) - (int)std::lround(in[c]);
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pbit = p;
+                std::copy(trial, trial + 4, q);
+            }
+        }
+    }
+
+    // Writes a BC7 mode 6 block for endpoints lo and hi.
+    // @return squared error; weights receive each pixel's position from lo to hi
+    int encodeMode6(const Block& block, const float lo[4], const float hi[4], bool exhaustive, uchar out[16], float weights[16])
+    {
+        int q0[4], q1[4], p0, p1;
+        quantize7p(lo, q0, p0);
+        quantize7p(hi, q1, p1);
+
+        int e0[4], e1[4], palette[16][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = (q0[c] << 1) | p0;
+            e1[c] = (q1[c] << 1) | p1;
+        }
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 4; ++c)
+                palette[i][c] = ((64 - bc7_weights4[i]) * e0[c] + bc7_weights4[i] * e1[c] + 32) >> 6;
+
+        int axis[4], length2 = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            axis[c] = e1[c] - e0[c];
+            length2 += axis[c] * axis[c];
+        }
+
+        int indices[16], error = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            if (exhaustive || length2 == 0)
+            {
+                int bestError = INT_MAX;
+                for (int e = 0; e < (length2 == 0 ? 1 : 16); ++e)
+                {
+                    int err = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        int d = (int)block.p[i][c] - palette[e][c];
+                        err += d * d;
+                    }
+                    if (err < bestError)
+                        best = e, bestError = err;
+                }
+            }
+            else
+            {
+                // the weights are nearly uniform, so project onto the endpoint line
+                int dot = 0;
+                for (int c = 0; c < 4; ++c)
+                    dot += ((int)block.p[i][c] - e0[c]) * axis[c];
+                best = std::min(std::max((int)std::lround(15.0f * (float)dot / (float)length2), 0), 15);
+            }
+
+            indices[i] = best;
+            weights[i] = (float)bc7_weights4[best] / 64.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                int d = (int)block.p[i][c] - palette[best][c];
+                error += d * d;
+            }
+        }
+
+        // the first index is stored without its high bit, so it must be < 8;
+        // swapping the endpoints mirrors every index
+        if (indices[0] >= 8)
+        {
+            std::swap(q0, q1);
+            std::swap(p0, p1);
+            for (auto& index : indices)
+                index = 15 - index;
+        }
+
+        memset(out, 0, 16);
+        BitWriter bits{ out };
+        bits.put(1u << 6, 7); // mode 6
+        for (int c = 0; c < 4; ++c)
+        {
+            bits.put(q0[c], 7);
+            bits.put(q1[c], 7);
+        }
+        bits.put(p0, 1);
+        bits.put(p1, 1);
+        bits.put(indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+            bits.put(indices[i], 4);
+
+        return error;
+    }
+
+    void encodeBC7Block(const Block& block, bool quality, uchar out[16])
+    {
+        float lo[4], hi[4], weights[16];
+        bounds(block, 4, lo, hi);
+        int best = encodeMode6(block, lo, hi, quality, out, weights);
+
+        if (quality && best > 0)
+        {
+            uchar trial[16];
+            principalAxis(block, 4, lo, hi);
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+                int error = encodeMode6(block, lo, hi, true, trial, weights);
+                if (error < best)
+                {
+                    best = error;
+                    memcpy(out, trial, 16);
+                }
+                if (!refine(block, 4, weights, lo, hi))
+                    break;
+            }
+        }
+    }
+
+    void decodeColor(const uchar* in, bool fourColorOnly, uchar rgba[64])
+    {
+        unsigned c0 = in[0] | (in[1] << 8), c1 = in[2] | (in[3] << 8);
+        int palette[4][3];
+        palette565(c0, c1, palette);
+
+        bool threeColor = !fourColorOnly && c0 <= c1;
+        if (threeColor)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        std::uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((std::uint32_t)in[7] << 24);
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            auto index = (indices >> (2 * i)) & 3;
+            for (int c = 0; c < 3; ++c)
+                rgba[i * 4 + c] = (uchar)palette[index][c];
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+}
+
+std::shared_ptr<Image>
+BlockCompressor::compress(const Image& image) const
+{
+    const unsigned components =
+        image.pixelFormat() == Image::R8G8B8A8_UNORM ? 4u :
+        image.pixelFormat() == Image::R8G8B8_UNORM ? 3u :
+        0u;
+
+    ROCKY_SOFT_ASSERT_AND_RETURN(image.valid() && image.depth() == 1 && components > 0, nullptr);
+    ROCKY_SOFT_ASSERT_AND_RETURN(format == Image::BC1_RGB_UNORM || format == Image::BC3_UNORM || format == Image::BC7_UNORM, nullptr);
+
+    // Block-compressed mipmaps end at the first level that fits in one block,
+    // and each level halves the block count, which matches the pixel size
+    // only for powers of two.
+    const bool powerOfTwo =
+        (image.width() & (image.width() - 1)) == 0 &&
+        (image.height() & (image.height() - 1)) == 0;
+
+    unsigned levels = 1;
+    if (powerOfTwo)
+    {
+        while (levels < image.mipLevels() &&
+            std::max(image.mipmapWidth(levels - 1), image.mipmapHeight(levels - 1)) > 4)
+        {
+            ++levels;
+        }
+    }
+
+    auto result = Image::create(format, image.width(), image.height(), 1u, levels);
+    const unsigned blockBytes = format == Image::BC1_RGB_UNORM ? 8 : 16;
+    const bool quality = preset == Preset::QUALITY;
+
+    for (unsigned level = 0; level < levels; ++level)
+    {
+        const unsigned width = image.mipmapWidth(level), height = image.mipmapHeight(level);
+        const unsigned blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+        const uchar* src = image.mipmapData<uchar>(level);
+        uchar* out = result->mipmapData<uchar>(level);
+
+        Block block;
+        for (unsigned by = 0; by < blocksHigh; ++by)
+        {
+            for (unsigned bx = 0; bx < blocksWide; ++bx)
+            {
+                fetch(src, width, height, components, bx, by, block);
+                uchar* dst = out + (by * blocksWide + bx) * blockBytes;
+
+                switch (format)
+                {
+                case Image::BC1_RGB_UNORM:
+                    encodeColorBlock(block, quality, dst);
+                    break;
+                case Image::BC3_UNORM:
+                    encodeAlphaBlock(block, dst);
+                    encodeColorBlock(block, quality, dst + 8);
+                    break;
+                default:
+                    encodeBC7Block(block, quality, dst);
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+Image::PixelFormat
+BlockCompressor::chooseFormat(const Image& image)
+{
+    if (image.pixelFormat() == Image::R8G8B8A8_UNORM)
+    {
+        auto data = image.data<uchar>();
+        for (unsigned i = 0; i < image.sizeInPixels(); ++i)
+            if (data[i * 4 + 3] != 255)
+                return Image::BC7_UNORM;
+    }
+    return Image::BC1_RGB_UNORM;
+}
+
+bool
+BlockCompressor::decodeBlock(Image::PixelFormat format, const unsigned char* block, unsigned char rgba[64])
+{
+    if (format == Image::BC1_RGB_UNORM)
+    {
+        decodeColor(block, false, rgba);
+        return true;
+    }
+
+    else if (format == Image::BC3_UNORM)
+    {
+        decodeColor(block + 8, true, rgba);
+
+        int palette[8];
+        paletteAlpha(block[0], block[1], palette);
+
+        std::uint64_t indices = 0;
+        for (int b = 0; b < 6; ++b)
+            indices |= (std::uint64_t)block[2 + b] << (8 * b);
+
+        for (unsigned i = 0; i < 16; ++i)
+            rgba[i * 4 + 3] = (uchar)palette[(indices >> (3 * i)) & 7];
+
+        return true;
+    }
+
+    else if (format == Image::BC7_UNORM)
+    {
+        // mode 6 only: the mode is the position of the lowest set bit
+        if ((block[0] & 0x7f) != 0x40)
+            return false;
+
+        BitReader bits{ block };
+        bits.get(7);
+
+        int q0[4], q1[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            q0[c] = bits.get(7);
+            q1[c] = bits.get(7);
+        }
+        int p0 = bits.get(1), p1 = bits.get(1);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            int w = bc7_weights4[bits.get(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; ++c)
+            {
+                int e0 = (q0[c] << 1) | p0, e1 = (q1[c] << 1) | p1;
+                rgba[i * 4 + c] = (uchar)(((64 - w) * e0 + w * e1 + 32) >> 6);
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
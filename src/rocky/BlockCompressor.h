@@ -0,0 +1,57 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Image.h>
+
+namespace ROCKY_NAMESPACE
+{
+    namespace util
+    {
+        /**
+        * Encodes 8-bit RGB and RGBA images into GPU block-compressed formats,
+        * which the GPU samples directly for a fraction of the memory:
+        * - BC1: opaque color, 4 bits per pixel (1/8 the size of RGBA)
+        * - BC3: color plus a separate alpha block, 8 bits per pixel (1/4)
+        * - BC7: color and alpha at higher quality, 8 bits per pixel (1/4)
+        *
+        * Encoding is expensive, so do it on a worker thread. The BC7 encoder
+        * writes only mode 6 blocks (a single pair of RGBA endpoints).
+        */
+        class ROCKY_EXPORT BlockCompressor
+        {
+        public:
+            //! Speed/quality tradeoff
+            enum class Preset
+            {
+                //! Bounding-box endpoints; BC7 indices by projection
+                FAST,
+                //! Principal-axis endpoints refined by least squares, best of both
+                QUALITY
+            };
+
+            //! Output format: Image::BC1_RGB_UNORM, Image::BC3_UNORM or Image::BC7_UNORM
+            Image::PixelFormat format = Image::BC1_RGB_UNORM;
+
+            //! Speed/quality tradeoff
+            Preset preset = Preset::FAST;
+
+        public:
+            //! Compresses an image and its mipmaps. Only mipmaps down to a single
+            //! block survive, and only for power-of-two sizes, since those are the
+            //! only levels the GPU can address in blocks.
+            //! @param image 8-bit RGB or RGBA 2D image
+            //! @return Compressed image, or nullptr if the image is not supported
+            std::shared_ptr<Image> compress(const Image& image) const;
+
+            //! BC1 if every pixel in the image is opaque, otherwise BC7.
+            static Image::PixelFormat chooseFormat(const Image& image);
+
+            //! Decodes one 4x4 block into 16 RGBA8 pixels, row by row.
+            //! @return false if the format (or the BC7 block mode) is not supported
+            static bool decodeBlock(Image::PixelFormat format, const unsigned char* block, unsigned char rgba[64]);
+        };
+    }
+}
@@ -0,0 +1,210 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "Buffer.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#   ifndef NOMINMAX
+#   define NOMINMAX
+#   endif
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // Files smaller than this are read with a single fread; mapping tiny
+    // files costs more in system calls and page faults than copying them.
+    const std::size_t MMAP_THRESHOLD = 64 * 1024;
+
+    // Owns a read-only memory mapping and releases it when the last Buffer
+    // referencing it goes away.
+    struct MappedFile
+    {
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+
+        bool open(const std::string& filename)
+        {
+            file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+                return false;
+
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping)
+                return false;
+
+            data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            size = (std::size_t)fileSize.QuadPart;
+            return data != nullptr;
+        }
+
+        ~MappedFile()
+        {
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        }
+#else
+        bool open(const std::string& filename)
+        {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            void* ptr = ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // the mapping stays valid after the descriptor is closed
+
+            if (ptr == MAP_FAILED)
+                return false;
+
+            ::madvise(ptr, (std::size_t)st.st_size, MADV_SEQUENTIAL);
+
+            data = (const char*)ptr;
+            size = (std::size_t)st.st_size;
+            return true;
+        }
+
+        ~MappedFile()
+        {
+            if (data) ::munmap((void*)data, size);
+        }
+#endif
+    };
+}
+
+Buffer::Buffer(std::string&& value)
+{
+    auto owner = std::make_shared<const std::string>(std::move(value));
+    _data = owner->data();
+    _size = owner->size();
+    _owner = owner;
+}
+
+Buffer::Buffer(const std::string& value) :
+    Buffer(std::string(value))
+{
+    //nop
+}
+
+Buffer
+Buffer::slice(std::size_t offset, std::size_t length) const
+{
+    offset = std::min(offset, _size);
+    length = std::min(length, _size - offset);
+
+    Buffer result;
+    if (length > 0)
+    {
+        result._owner = _owner;
+        result._data = _data + offset;
+        result._size = length;
+    }
+    return result;
+}
+
+Result<Buffer>
+Buffer::readFile(const std::string& filename)
+{
+    std::error_code ec;
+    auto fileSize = std::filesystem::file_size(filename, ec);
+    if (ec)
+        return Status(Status::ResourceUnavailable, filename);
+
+    if (fileSize == 0)
+        return Buffer();
+
+    if (fileSize >= MMAP_THRESHOLD)
+    {
+        auto mapped = std::make_shared<MappedFile>();
+        if (mapped->open(filename))
+        {
+            Buffer buffer;
+            buffer._data = mapped->data;
+            buffer._size = mapped->size;
+            buffer._owner = mapped;
+            return buffer;
+        }
+        // fall back on a normal read
+    }
+
+    FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file)
+        return Status(Status::ResourceUnavailable, filename);
+
+    std::string data;
+    data.resize(fileSize);
+    auto bytesRead = std::fread(data.data(), 1, fileSize, file);
+    std::fclose(file);
+
+    if (bytesRead != fileSize)
+        return Status(Status::GeneralError, "Short read from " + filename);
+
+    return Buffer(std::move(data));
+}
+
+BufferStream::StreamBuf::StreamBuf(const char* data, std::size_t size)
+{
+    auto begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+}
+
+BufferStream::StreamBuf::pos_type
+BufferStream::StreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in))
+        return pos_type(off_type(-1));
+
+    off_type base =
+        dir == std::ios_base::beg ? 0 :
+        dir == std::ios_base::cur ? (gptr() - eback()) :
+        (egptr() - eback());
+
+    off_type pos = base + off;
+    if (pos < 0 || pos > (egptr() - eback()))
+        return pos_type(off_type(-1));
+
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+}
+
+BufferStream::StreamBuf::pos_type
+BufferStream::StreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+BufferStream::BufferStream(const Buffer& buffer) :
+    std::istream(nullptr),
+    _buffer(buffer),
+    _streambuf(buffer.data(), buffer.size())
+{
+    rdbuf(&_streambuf);
+}
@@ -0,0 +1,99 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#include <rocky/Status.h>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Immutable, reference-counted block of bytes.
+     *
+     * Copying a Buffer shares the underlying memory rather than duplicating
+     * it, so a Buffer can pass through caches and result objects for free.
+     * The memory may come from a std::string or from a read-only memory
+     * mapping of a file. A slice is a Buffer that views part of another
+     * and keeps the whole block alive.
+     */
+    class ROCKY_EXPORT Buffer
+    {
+    public:
+        //! Empty buffer
+        Buffer() = default;
+
+        //! Buffer that takes ownership of a string's contents (no copy)
+        Buffer(std::string&& value);
+
+        //! Buffer holding a copy of a string
+        Buffer(const std::string& value);
+
+        //! Buffer holding a copy of a null-terminated string
+        Buffer(const char* value) : Buffer(std::string(value)) { }
+
+        //! Reads a whole file into a buffer. Large files are memory-mapped
+        //! read-only so their bytes are never copied into process memory.
+        static Result<Buffer> readFile(const std::string& filename);
+
+        //! Pointer to the first byte (not null-terminated)
+        inline const char* data() const { return _data; }
+
+        //! Number of bytes
+        inline std::size_t size() const { return _size; }
+
+        //! Whether the buffer holds no bytes
+        inline bool empty() const { return _size == 0; }
+
+        //! Read-only view of the bytes
+        inline std::string_view view() const { return std::string_view(_data, _size); }
+
+        //! Implicit conversion to a read-only view
+        inline operator std::string_view() const { return view(); }
+
+        //! Buffer viewing a sub-range of this one, sharing the same memory.
+        //! The range is clamped to the bounds of this buffer.
+        Buffer slice(std::size_t offset, std::size_t length = std::string::npos) const;
+
+        //! Copy the bytes into a new string
+        inline std::string str() const { return std::string(_data, _size); }
+
+        //! Compare contents
+        inline bool operator == (const Buffer& rhs) const { return view() == rhs.view(); }
+        inline bool operator != (const Buffer& rhs) const { return view() != rhs.view(); }
+
+    private:
+        std::shared_ptr<const void> _owner;
+        const char* _data = nullptr;
+        std::size_t _size = 0;
+    };
+
+    /**
+     * Input stream that reads directly from a Buffer's memory without copying it.
+     * Holds a reference to the buffer for its lifetime.
+     */
+    class ROCKY_EXPORT BufferStream : public std::istream
+    {
+    public:
+        BufferStream(const Buffer& buffer);
+
+        //! The buffer this stream reads from
+        inline const Buffer& buffer() const { return _buffer; }
+
+    private:
+        struct StreamBuf : public std::streambuf
+        {
+            StreamBuf(const char* data, std::size_t size);
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+        };
+
+        Buffer _buffer;
+        StreamBuf _streambuf;
+    };
+}
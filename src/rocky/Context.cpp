@@ -8,6 +8,7 @@
 #include "Profile.h"
 #include "SRS.h"
 #include "Threading.h"
+#include "Trace.h"
 #include "Utils.h"
 #include "Version.h"
 #include "json.h"
@@ -122,6 +123,17 @@ ContextImpl::ContextImpl()
     jobs::set_thread_name_function([](const char* value) {
         util::setThreadName(value);
         });
+
+#ifdef ROCKY_HAS_TRACING
+    // Record a Chrome trace for the lifetime of the context
+    auto traceFile = util::getEnvVar("ROCKY_TRACE_FILE");
+    if (!traceFile.empty())
+    {
+        Trace::start(traceFile);
+        Trace::setThreadName("main");
+        Log()->info("Recording trace to {}", traceFile);
+    }
+#endif
 }
 
 //ContextImpl::ContextImpl(const ContextImpl& rhs)
@@ -135,6 +147,12 @@ ContextImpl::ContextImpl()
 ContextImpl::~ContextImpl()
 {
     jobs::shutdown();
+
+#ifdef ROCKY_HAS_TRACING
+    auto status = Trace::stop();
+    if (status.failed())
+        Log()->warn("{}", status.message);
+#endif
     //_global_status = Status_ServiceUnavailable;
 }
 
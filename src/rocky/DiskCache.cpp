@@ -0,0 +1,402 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "DiskCache.h"
+#include "Utils.h"
+#include "sha1.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#undef LC
+#define LC "[DiskCache] "
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // file header identifying a rocky disk cache entry
+    const char MAGIC[4] = { 'R', 'C', 'K', '1' };
+
+    inline std::int64_t now_seconds()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    template<typename T>
+    inline void write_pod(std::ostream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline void write_string(std::ostream& out, const std::string& value)
+    {
+        write_pod(out, (std::uint32_t)value.size());
+        out.write(value.data(), value.size());
+    }
+
+    // sequential reader over the bytes of a cache entry
+    struct EntryReader
+    {
+        const char* ptr;
+        std::size_t remaining;
+
+        template<typename T>
+        inline bool read_pod(T& value)
+        {
+            if (remaining < sizeof(T))
+                return false;
+            memcpy(&value, ptr, sizeof(T));
+            ptr += sizeof(T), remaining -= sizeof(T);
+            return true;
+        }
+
+        inline bool read_string(std::string& value)
+        {
+            std::uint32_t size = 0;
+            if (!read_pod(size) || size > remaining)
+                return false;
+            value.assign(ptr, size);
+            ptr += size, remaining -= size;
+            return true;
+        }
+    };
+}
+
+DiskCache::DiskCache(const std::string& rootPath, std::uint64_t maxBytes) :
+    _rootPath(rootPath),
+    _maxBytes(maxBytes)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(_rootPath, ec);
+    if (!std::filesystem::is_directory(_rootPath, ec))
+    {
+        _status = Status(Status::ResourceUnavailable, "Cannot create cache folder " + _rootPath);
+        Log()->warn(LC "{}", _status.message);
+        return;
+    }
+
+    index();
+
+    Log()->info(LC "Opened {} with {} entries ({:.1f} MB)",
+        _rootPath, entries(), (double)_bytes / 1048576.0);
+
+    if (_maxBytes > 0 && _bytes > _maxBytes)
+    {
+        trim();
+    }
+}
+
+std::string
+DiskCache::hash(const std::string& key) const
+{
+    char hex[SHA1_HEX_SIZE];
+    util::sha1(key.c_str()).finalize().print_hex(hex);
+    return std::string(hex);
+}
+
+DiskCache::Shard&
+DiskCache::shard(const std::string& hash) const
+{
+    // the hash is hex, so the first character is evenly distributed over 16 values
+    auto c = hash[0];
+    unsigned i = (c >= 'a') ? (10u + (unsigned)(c - 'a')) : (unsigned)(c - '0');
+    return _shards[i % NUM_SHARDS];
+}
+
+std::string
+DiskCache::filename(const std::string& hash) const
+{
+    return (std::filesystem::path(_rootPath) / hash.substr(0, 2) / hash).string();
+}
+
+std::size_t
+DiskCache::entries() const
+{
+    std::size_t count = 0;
+    for (auto& s : _shards)
+    {
+        std::shared_lock lock(s.mutex);
+        count += s.entries.size();
+    }
+    return count;
+}
+
+void
+DiskCache::index()
+{
+    struct Found {
+        std::filesystem::file_time_type mtime;
+        std::string name;
+        std::string filename;
+        std::uint64_t size;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (auto& i : std::filesystem::recursive_directory_iterator(_rootPath, ec))
+    {
+        if (!i.is_regular_file(ec))
+            continue;
+
+        auto path = i.path();
+        auto name = path.filename().string();
+
+        // leftover temporary file from an interrupted write
+        if (path.extension() == ".tmp")
+        {
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+
+        if (name.size() != SHA1_HEX_SIZE - 1)
+            continue;
+
+        auto size = i.file_size(ec);
+        if (ec)
+            continue;
+
+        found.emplace_back(Found{ std::filesystem::last_write_time(path, ec), name, path.string(), size });
+    }
+
+    // use the modification time as a stand-in for the access order.
+    std::sort(found.begin(), found.end(),
+        [](const Found& lhs, const Found& rhs) { return lhs.mtime < rhs.mtime; });
+
+    for (auto& f : found)
+    {
+        auto& s = shard(f.name);
+        auto& entry = s.entries[f.name];
+        entry.filename = f.filename;
+        entry.size = f.size;
+        entry.lastAccess = ++_clock;
+        _bytes += f.size;
+    }
+}
+
+Result<Content>
+DiskCache::read(const std::string& key) const
+{
+    if (_status.failed())
+        return _status;
+
+    auto h = hash(key);
+    auto& s = shard(h);
+    std::string fn;
+    {
+        std::shared_lock lock(s.mutex);
+        auto i = s.entries.find(h);
+        if (i == s.entries.end())
+        {
+            ++_misses;
+            return Status(Status::ResourceUnavailable);
+        }
+        fn = i->second.filename;
+        i->second.lastAccess = ++_clock;
+    }
+
+    // Read the file outside the lock. If another thread evicted it in the
+    // meantime, the read will fail and we report a miss. Large entries are
+    // memory-mapped and the payload is a slice of the mapping, so it is never
+    // copied on its way to the decoder.
+    auto file = Buffer::readFile(fn);
+    if (file.status.failed())
+    {
+        ++_misses;
+        return Status(Status::ResourceUnavailable);
+    }
+
+    EntryReader in{ file.value.data(), file.value.size() };
+    char magic[4] = { 0, 0, 0, 0 };
+    std::int64_t timestamp = 0;
+    std::string storedKey;
+    Content content;
+
+    if (!in.read_pod(magic) || memcmp(magic, MAGIC, 4) != 0 ||
+        !in.read_pod(timestamp) ||
+        !in.read_string(storedKey) ||
+        !in.read_string(content.contentType))
+    {
+        file.value = {};
+        removeEntry(h);
+        ++_misses;
+        return Status(Status::GeneralError, "Corrupt cache entry for " + key);
+    }
+
+    // hash collision; very unlikely but cheap to check
+    if (storedKey != key)
+    {
+        ++_misses;
+        return Status(Status::ResourceUnavailable);
+    }
+
+    content.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(timestamp));
+
+    if (maxAge.count() > 0 && std::chrono::system_clock::now() - content.timestamp > maxAge)
+    {
+        file.value = {};
+        if (removeEntry(h))
+            ++_evictions;
+        ++_misses;
+        return Status(Status::ResourceUnavailable, "Expired");
+    }
+
+    content.data = file.value.slice(file.value.size() - in.remaining);
+
+    ++_hits;
+    return content;
+}
+
+Status
+DiskCache::write(const std::string& key, const Content& content)
+{
+    if (_status.failed())
+        return _status;
+
+    auto h = hash(key);
+    auto fn = filename(h);
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(fn).parent_path(), ec);
+
+    // write to a temporary file first so readers never see a partial entry.
+    std::stringstream tid;
+    tid << std::this_thread::get_id();
+    auto temp = fn + "." + tid.str() + ".tmp";
+
+    std::ofstream out(temp, std::ios_base::binary | std::ios_base::trunc);
+    if (!out.is_open())
+    {
+        return Status(Status::ResourceUnavailable, "Cannot write to " + temp);
+    }
+
+    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+        content.timestamp.time_since_epoch()).count();
+
+    if (timestamp <= 0)
+        timestamp = now_seconds();
+
+    out.write(MAGIC, 4);
+    write_pod(out, (std::int64_t)timestamp);
+    write_string(out, key);
+    write_string(out, content.contentType);
+    out.write(content.data.data(), content.data.size());
+    std::uint64_t size = out.tellp();
+    out.close();
+
+    if (out.fail())
+    {
+        std::filesystem::remove(temp, ec);
+        return Status(Status::GeneralError, "Failed to write " + temp);
+    }
+
+    auto& s = shard(h);
+    {
+        std::unique_lock lock(s.mutex);
+
+#ifdef _WIN32
+        // rename will not replace an existing file on Windows
+        std::filesystem::remove(fn, ec);
+#endif
+        std::filesystem::rename(temp, fn, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return Status(Status::GeneralError, "Failed to commit " + fn);
+        }
+
+        auto& entry = s.entries[h];
+        _bytes -= entry.size;
+        entry.filename = fn;
+        entry.size = size;
+        entry.lastAccess = ++_clock;
+        _bytes += size;
+    }
+
+    if (_maxBytes > 0 && _bytes > _maxBytes)
+    {
+        trim();
+    }
+
+    return StatusOK;
+}
+
+bool
+DiskCache::removeEntry(const std::string& h) const
+{
+    auto& s = shard(h);
+    std::unique_lock lock(s.mutex);
+    auto i = s.entries.find(h);
+    if (i == s.entries.end())
+        return false;
+
+    std::error_code ec;
+    std::filesystem::remove(i->second.filename, ec);
+    _bytes -= i->second.size;
+    s.entries.erase(i);
+    return true;
+}
+
+void
+DiskCache::remove(const std::string& key)
+{
+    removeEntry(hash(key));
+}
+
+void
+DiskCache::clear()
+{
+    for (auto& s : _shards)
+    {
+        std::unique_lock lock(s.mutex);
+        std::error_code ec;
+        for (auto& i : s.entries)
+        {
+            std::filesystem::remove(i.second.filename, ec);
+            _bytes -= i.second.size;
+        }
+        s.entries.clear();
+    }
+}
+
+void
+DiskCache::trim()
+{
+    // only one thread needs to trim at a time; others can carry on.
+    std::unique_lock trimLock(_trimMutex, std::try_to_lock);
+    if (!trimLock.owns_lock())
+        return;
+
+    // Trim down to 90% of the budget so we're not trimming on every write.
+    std::uint64_t target = _maxBytes - _maxBytes / 10;
+
+    struct Candidate {
+        std::uint64_t lastAccess;
+        std::string hash;
+    };
+    std::vector<Candidate> candidates;
+
+    for (auto& s : _shards)
+    {
+        std::shared_lock lock(s.mutex);
+        for (auto& i : s.entries)
+            candidates.emplace_back(Candidate{ i.second.lastAccess.load(), i.first });
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const Candidate& lhs, const Candidate& rhs) { return lhs.lastAccess < rhs.lastAccess; });
+
+    for (auto& c : candidates)
+    {
+        if (_bytes <= target)
+            break;
+
+        if (removeEntry(c.hash))
+            ++_evictions;
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/IOTypes.h>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Persistent content cache that stores each entry as a file on disk.
+     *
+     * Entries are keyed by a string (typically URI::full()) and stored in
+     * a two-level folder hierarchy under the root path. The cache honors a
+     * total byte budget by evicting the least recently accessed entries, and
+     * optionally expires entries that are older than a maximum age.
+     *
+     * Any number of threads may read concurrently; writes go to a temporary
+     * file that is atomically renamed into place.
+     */
+    class ROCKY_EXPORT DiskCache : public Inherit<Cache, DiskCache>
+    {
+    public:
+        //! Construct a disk cache rooted at the given folder.
+        //! The folder is created if it does not exist, and any existing
+        //! entries are indexed so they count against the byte budget.
+        //! @param rootPath Folder in which to store cache entries
+        //! @param maxBytes Byte budget (0 = unlimited)
+        DiskCache(const std::string& rootPath, std::uint64_t maxBytes = 0);
+
+        //! Maximum age of an entry before it expires (0 = never expires)
+        std::chrono::seconds maxAge = std::chrono::seconds(0);
+
+        //! Root folder of the cache
+        const std::string& rootPath() const { return _rootPath; }
+
+        //! Total byte budget of the cache (0 = unlimited)
+        std::uint64_t maxBytes() const { return _maxBytes; }
+
+        //! Total size of all entries currently in the cache
+        std::uint64_t bytes() const { return _bytes; }
+
+        //! Number of entries currently in the cache
+        std::size_t entries() const;
+
+        //! Status of the cache (e.g., failure to create the root folder)
+        const Status& status() const { return _status; }
+
+        //! Number of successful reads
+        std::uint64_t hits() const { return _hits; }
+
+        //! Number of reads that found no valid entry
+        std::uint64_t misses() const { return _misses; }
+
+        //! Number of entries evicted to honor the byte budget or max age
+        std::uint64_t evictions() const { return _evictions; }
+
+    public: // Cache
+
+        Result<Content> read(const std::string& key) const override;
+
+        Status write(const std::string& key, const Content& content) override;
+
+        void remove(const std::string& key) override;
+
+        void clear() override;
+
+    private:
+        struct Entry
+        {
+            std::string filename;
+            std::uint64_t size = 0;
+            mutable std::atomic<std::uint64_t> lastAccess = { 0 }; // logical clock value
+        };
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string, Entry> entries; // keyed by hash
+        };
+
+        static constexpr unsigned NUM_SHARDS = 16;
+
+        std::string _rootPath;
+        std::uint64_t _maxBytes = 0;
+        mutable std::atomic<std::uint64_t> _bytes = { 0 };
+        mutable std::atomic<std::uint64_t> _hits = { 0 };
+        mutable std::atomic<std::uint64_t> _misses = { 0 };
+        mutable std::atomic<std::uint64_t> _evictions = { 0 };
+        mutable std::atomic<std::uint64_t> _clock = { 0 };
+        mutable Shard _shards[NUM_SHARDS];
+        std::mutex _trimMutex;
+        Status _status;
+
+        std::string hash(const std::string& key) const;
+        Shard& shard(const std::string& hash) const;
+        std::string filename(const std::string& hash) const;
+        void index();
+        void trim();
+        bool removeEntry(const std::string& hash) const;
+    };
+}
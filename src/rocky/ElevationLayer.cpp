@@ -6,6 +6,7 @@
 #include "ElevationLayer.h"
 #include "Geoid.h"
 #include "Heightfield.h"
+#include "Trace.h"
 #include "json.h"
 
 #include <cinttypes>
@@ -104,14 +105,12 @@ ElevationLayer::construct(const std::string& JSON, const IOOptions& io)
     }
 
     // a small L2 cache will help with things like normal map creation
-    // (i.e. queries that sample neighboring tiles)
+    // (i.e. queries that sample neighboring tiles); sized in tiles
     if (!l2CacheSize.has_value())
     {
-        l2CacheSize.set_default(32u);
+        l2CacheSize.set_default(64u);
     }
 
-    _L2cache.setCapacity(l2CacheSize.value());
-
     // Disable max-level support for elevation data because it makes no sense.
     maxLevel.clear();
     maxResolution.clear();
@@ -148,6 +147,10 @@ ElevationLayer::openImplementation(const IOOptions& io)
 
     _dependencyCache = std::make_shared<TileMosaicWeakCache<Heightfield>>();
 
+    // budget the L2 cache in bytes, so smaller tiles pack in more entries
+    std::size_t tileBytes = (std::size_t)tileSize.value() * tileSize.value() * sizeof(float);
+    _L2cache.setCapacity((std::size_t)l2CacheSize.value() * tileBytes);
+
     return StatusOK;
 }
 
@@ -344,7 +347,32 @@ ElevationLayer::createHeightfield(const TileKey& key, const IOOptions& io) const
     std::shared_lock readLock(layerStateMutex());
     if (isOpen())
     {
-        return createHeightfieldInKeyProfile(key, io);
+        auto cached = _L2cache.get(key);
+        if (cached.status.ok() && cached.value.valid())
+        {
+            return cached;
+        }
+
+        // only one thread creates a given key at a time; the others share the result,
+        // unless they are canceled while they wait.
+        auto create = [&]() -> std::optional<Result<GeoHeightfield>>
+            {
+                auto r = createHeightfieldInKeyProfile(key, io);
+                if (io.canceled())
+                    return std::nullopt;
+
+                if (r.status.ok() && r.value.valid())
+                    _L2cache.put(key, r);
+
+                return r;
+            };
+
+        auto result = _sentry.run(key, create, [&]() { return io.canceled(); });
+
+        if (result.has_value())
+            return result.value();
+        else
+            return Result(GeoHeightfield::INVALID);
     }
     return status();
 }
@@ -499,6 +527,8 @@ ElevationLayerVector::populateHeightfield(
     Interpolation interpolation,
     const IOOptions& io) const
 {
+    ROCKY_TRACE_SCOPE_KEY("populateHeightfield", key);
+
     // heightfield must already exist.
     if ( !hf )
         return false;
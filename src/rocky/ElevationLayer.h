@@ -92,9 +92,19 @@ namespace ROCKY_NAMESPACE
 
         void normalizeNoDataValues(Heightfield* hf) const;
 
-        util::Gate<TileKey> _sentry;
+        mutable util::SingleFlight<TileKey, Result<GeoHeightfield>> _sentry;
 
-        mutable util::LRUCache<TileKey, Result<GeoHeightfield>> _L2cache;
+        //! L2 cache cost of a heightfield: its size in bytes
+        struct HeightfieldCost
+        {
+            inline std::size_t operator()(const Result<GeoHeightfield>& r) const {
+                auto hf = r.value.heightfield();
+                return hf ? hf->sizeInBytes() : 1u;
+            }
+        };
+
+        // few shards, since each one only gets its share of the capacity
+        mutable util::LRUCache<TileKey, Result<GeoHeightfield>, HeightfieldCost> _L2cache{ 0, 4 };
 
         Result<GeoHeightfield> createHeightfieldImplementation_internal(
             const TileKey& key,
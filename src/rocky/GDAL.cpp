@@ -344,6 +344,72 @@ namespace ROCKY_NAMESPACE
 
             return result;
         }
+
+        Result<std::string> writeImage(std::shared_ptr<Image> image, const std::string& name)
+        {
+            if (!image || image->depth() != 1)
+                return Status(Status::AssertionFailure);
+
+            GDALDataType type =
+                image->pixelFormat() == Image::R16_UNORM ? GDT_UInt16 :
+                image->pixelFormat() == Image::R32_SFLOAT ? GDT_Float32 :
+                image->pixelFormat() == Image::R64_SFLOAT ? GDT_Float64 :
+                GDT_Byte;
+
+            auto memDriver = GDALGetDriverByName("MEM");
+            auto driver = GDALGetDriverByName(name.c_str());
+            if (!memDriver || !driver)
+                return Status(Status::ServiceUnavailable, "GDAL driver \"" + name + "\" is not available");
+
+            int width = image->width();
+            int height = image->height();
+            int bands = image->numComponents();
+            int componentBytes = GDALGetDataTypeSizeBytes(type);
+            int pixelBytes = componentBytes * bands;
+
+            // wrap the pixels in an in-memory dataset, one band per component:
+            auto mem = (GDALDataset*)GDALCreate(memDriver, "", width, height, bands, type, nullptr);
+            if (!mem)
+                return Status(Status::GeneralError, CPLGetLastErrorMsg());
+
+            for (int b = 0; b < bands; ++b)
+            {
+                auto band = mem->GetRasterBand(b + 1);
+                auto err = band->RasterIO(GF_Write, 0, 0, width, height,
+                    image->data<unsigned char>() + b * componentBytes, width, height, type,
+                    pixelBytes, (GSpacing)pixelBytes * width, nullptr);
+                ROCKY_SOFT_ASSERT(err == CE_None, CPLGetLastErrorMsg() << );
+
+                // mirror the band interpretation readImage expects
+                band->SetColorInterpretation(
+                    type != GDT_Byte ? GCI_GrayIndex : (GDALColorInterp)(GCI_RedBand + b));
+            }
+
+            // generate a unique name for our temporary vsimem file:
+            static std::atomic_int rgen(0);
+            std::string filename = "/vsimem/encode" + std::to_string(rgen++);
+
+            auto out = (GDALDataset*)GDALCreateCopy(driver, filename.c_str(), mem, FALSE, nullptr, nullptr, nullptr);
+            GDALClose(mem);
+
+            if (!out)
+            {
+                VSIUnlink(filename.c_str());
+                return Status(Status::GeneralError, CPLGetLastErrorMsg());
+            }
+            GDALClose(out);
+
+            // take the encoded bytes out of the virtual file system:
+            vsi_l_offset length = 0;
+            GByte* bytes = VSIGetMemFileBuffer(filename.c_str(), &length, TRUE);
+            std::string result(bytes ? (const char*)bytes : "", bytes ? (std::size_t)length : 0u);
+            CPLFree(bytes);
+
+            // some drivers write a sidecar with auxiliary metadata
+            VSIUnlink((filename + ".aux.xml").c_str());
+
+            return result;
+        }
     }
 }
 
@@ -494,7 +560,7 @@ GDAL::Driver::open(
         auto rr = URI(prjLocation).read(io); // TODO io
         if (rr.status.ok() && !rr.value.data.empty())
         {
-            src_srs = SRS(util::trim(rr.value.data));
+            src_srs = SRS(util::trim(rr.value.data.str()));
         }
     }
 
@@ -797,16 +863,22 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
         return Status(Status::ResourceUnavailable);
     }
 
+    return createImage(key.extent(), tileSize, tileSize, io);
+}
+
+Result<std::shared_ptr<Image>>
+GDAL::Driver::createImage(const GeoExtent& extent, unsigned width, unsigned height, const IOOptions& io)
+{
     std::shared_ptr<Image> image;
 
     const bool invert = true;
 
     //Get the extents of the tile
     double xmin, ymin, xmax, ymax;
-    key.extent().getBounds(xmin, ymin, xmax, ymax);
+    extent.getBounds(xmin, ymin, xmax, ymax);
 
     // Compute the intersection of the incoming key with the data extents of the dataset
-    rocky::GeoExtent intersection = key.extent().intersectionSameSRS(_extents);
+    rocky::GeoExtent intersection = extent.intersectionSameSRS(_extents);
     if (!intersection.valid())
     {
         return Status(Status::ResourceUnavailable);
@@ -863,14 +935,14 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
     double offset_top = ymax - intersection.ymax();
 
 
-    int target_width = (int)ceil((intersection.width() / key.extent().width())*(double)tileSize);
-    int target_height = (int)ceil((intersection.height() / key.extent().height())*(double)tileSize);
-    int tile_offset_left = (int)floor((offset_left / key.extent().width()) * (double)tileSize);
-    int tile_offset_top = (int)floor((offset_top / key.extent().height()) * (double)tileSize);
+    int target_width = (int)ceil((intersection.width() / extent.width())*(double)width);
+    int target_height = (int)ceil((intersection.height() / extent.height())*(double)height);
+    int tile_offset_left = (int)floor((offset_left / extent.width()) * (double)width);
+    int tile_offset_top = (int)floor((offset_top / extent.height()) * (double)height);
 
     // Compute spacing
-    double dx = (xmax - xmin) / (double)(tileSize - 1);
-    double dy = (ymax - ymin) / (double)(tileSize - 1);
+    double dx = (xmax - xmin) / (double)(width - 1);
+    double dy = (ymax - ymin) / (double)(height - 1);
 
     // Return if parameters are out of range.
     if (src_width <= 0 || src_height <= 0 || target_width <= 0 || target_height <= 0)
@@ -932,7 +1004,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
         //Initialize the alpha values to 255.
         memset(alpha, 255, target_width * target_height);
 
-        image = Image::create(pixelFormat, tileSize, tileSize);
+        image = Image::create(pixelFormat, width, height);
 
         memset(image->data<char>(), 0, image->sizeInBytes());
 
@@ -949,7 +1021,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
             src_row < target_height;
             src_row++, dst_row++)
         {
-            unsigned int flippedRow = tileSize - dst_row - 1;
+            unsigned int flippedRow = height - dst_row - 1;
             for (int src_col = 0, dst_col = tile_offset_left;
                 src_col < target_width;
                 ++src_col, ++dst_col)
@@ -999,7 +1071,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
 
         if (isElevation)
         {
-            image = Image::create(Image::R32_SFLOAT, tileSize, tileSize);
+            image = Image::create(Image::R32_SFLOAT, width, height);
             image->fill(glm::fvec4(NO_DATA_VALUE));
             
             if (gdalDataType == GDT_Int16)
@@ -1014,7 +1086,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
 
                 for (int src_row = 0, dst_row = tile_offset_top; src_row < target_height; src_row++, dst_row++)
                 {
-                    unsigned int flippedRow = tileSize - dst_row - 1;
+                    unsigned int flippedRow = height - dst_row - 1;
                     for (int src_col = 0, dst_col = tile_offset_left; src_col < target_width; ++src_col, ++dst_col)
                     {
                         glm::fvec4 c;
@@ -1038,7 +1110,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
 
                 for (int src_row = 0, dst_row = tile_offset_top; src_row < target_height; src_row++, dst_row++)
                 {
-                    unsigned int flippedRow = tileSize - dst_row - 1;
+                    unsigned int flippedRow = height - dst_row - 1;
                     for (int src_col = 0, dst_col = tile_offset_left; src_col < target_width; ++src_col, ++dst_col)
                     {
                         glm::fvec4 c;
@@ -1054,7 +1126,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
         
         else // grey + alpha color
         {
-            image = Image::create(Image::R8G8B8A8_UNORM, tileSize, tileSize);
+            image = Image::create(Image::R8G8B8A8_UNORM, width, height);
             image->fill(glm::fvec4(0));
 
             unsigned char* gray = new unsigned char[target_width * target_height];
@@ -1079,7 +1151,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
                 src_row < target_height;
                 src_row++, dst_row++)
             {
-                unsigned int flippedRow = tileSize - dst_row - 1;
+                unsigned int flippedRow = height - dst_row - 1;
                 for (int src_col = 0, dst_col = tile_offset_left; src_col < target_width; ++src_col, ++dst_col)
                 {
                     glm::fvec4 c;
@@ -1111,7 +1183,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
         //Palette indexed imagery doesn't support interpolation currently and only uses nearest
         //b/c interpolating palette indexes doesn't make sense.
         unsigned char *palette = new unsigned char[target_width * target_height];
-        image = Image::create(pixelFormat, tileSize, tileSize);
+        image = Image::create(pixelFormat, width, height);
         memset(image->data<unsigned char>(), 0, image->sizeInBytes());
 
         detail::rasterIO(
@@ -1127,7 +1199,7 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
             src_row < target_height;
             src_row++, dst_row++)
         {
-            unsigned int flippedRow = tileSize - dst_row - 1;
+            unsigned int flippedRow = height - dst_row - 1;
             for (int src_col = 0, dst_col = tile_offset_left;
                 src_col < target_width;
                 ++src_col, ++dst_col)
@@ -1168,6 +1240,87 @@ GDAL::Driver::createImage(const TileKey& key, unsigned tileSize, const IOOptions
     return image;
 }
 
+namespace
+{
+    // Position of a block of adjacent keys (all at one level) and the
+    // extent they cover together.
+    struct KeyBlock
+    {
+        unsigned minX = ~0u, maxX = 0u, minY = ~0u, maxY = 0u;
+        unsigned level = 0u;
+        GeoExtent extent;
+
+        KeyBlock(const std::vector<TileKey>& keys)
+        {
+            if (keys.empty())
+                return;
+
+            level = keys.front().level;
+            for (auto& key : keys)
+            {
+                if (!key.valid() || key.level != level)
+                    return;
+                minX = std::min(minX, key.x), maxX = std::max(maxX, key.x);
+                minY = std::min(minY, key.y), maxY = std::max(maxY, key.y);
+            }
+
+            // tile y runs north to south
+            auto nw = TileKey(level, minX, minY, keys.front().profile).extent();
+            auto se = TileKey(level, maxX, maxY, keys.front().profile).extent();
+            extent = GeoExtent(nw.srs(), nw.xmin(), se.ymin(), se.xmax(), nw.ymax());
+        }
+
+        unsigned cols() const { return maxX - minX + 1; }
+        unsigned rows() const { return maxY - minY + 1; }
+    };
+
+    // Copies the pixels of "dst" from "src", starting at col/row in "src"
+    void copyBlock(const Image* src, unsigned col, unsigned row, Image* dst)
+    {
+        auto pixelSize = src->sizeInBytes() / src->sizeInPixels();
+        for (unsigned t = 0; t < dst->height(); ++t)
+        {
+            memcpy(
+                dst->data<unsigned char>() + t * dst->rowSizeInBytes(),
+                src->data<unsigned char>() + ((row + t) * src->width() + col) * pixelSize,
+                dst->rowSizeInBytes());
+        }
+    }
+}
+
+std::vector<Result<std::shared_ptr<Image>>>
+GDAL::Driver::createImages(const std::vector<TileKey>& keys, unsigned tileSize, const IOOptions& io)
+{
+    std::vector<Result<std::shared_ptr<Image>>> results(keys.size(), Status(Status::ResourceUnavailable));
+
+    KeyBlock block(keys);
+    if (!block.extent.valid() || (maxDataLevel.has_value() && block.level > maxDataLevel) || io.canceled())
+    {
+        return results;
+    }
+
+    // one warped read for the whole block...
+    auto all = createImage(block.extent, block.cols() * tileSize, block.rows() * tileSize, io);
+    if (all.status.failed())
+    {
+        std::fill(results.begin(), results.end(), all.status);
+        return results;
+    }
+
+    // ...then split it into tiles. Image rows run south to north.
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        if (!intersects(keys[i]))
+            continue;
+
+        auto image = Image::create(all.value->pixelFormat(), tileSize, tileSize);
+        copyBlock(all.value.get(), (keys[i].x - block.minX) * tileSize, (block.maxY - keys[i].y) * tileSize, image.get());
+        results[i] = image;
+    }
+
+    return results;
+}
+
 namespace
 {
     // per-thread raster sampling workspace for createHeightField
@@ -1453,32 +1606,38 @@ GDAL::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOO
         return Status(Status::ResourceUnavailable);
     }
 
+    return createHeightfield(key.extent(), tileSize, tileSize, io);
+}
+
+Result<std::shared_ptr<Heightfield>>
+GDAL::Driver::createHeightfield(const GeoExtent& extent, unsigned cols, unsigned rows, const IOOptions& io)
+{
     std::shared_ptr<Heightfield> hf;
 
     const bool invert = true;
 
     //Get the extents of the tile
     double xmin, ymin, xmax, ymax;
-    key.extent().getBounds(xmin, ymin, xmax, ymax);
+    extent.getBounds(xmin, ymin, xmax, ymax);
 
     // Compute the intersection of the incoming key with the data extents of the dataset
-    rocky::GeoExtent intersection = key.extent().intersectionSameSRS(_extents);
+    rocky::GeoExtent intersection = extent.intersectionSameSRS(_extents);
     if (!intersection.valid())
     {
         return Status(Status::ResourceUnavailable);
     }
 
     // Allocate the heightfield
-    hf = Heightfield::create(tileSize, tileSize);
+    hf = Heightfield::create(cols, rows);
     hf->fill(NO_DATA_VALUE);
 
     // Extract the extents of the tile
     double tile_xmin, tile_ymin, tile_xmax, tile_ymax;
-    key.extent().getBounds(tile_xmin, tile_ymin, tile_xmax, tile_ymax);
+    extent.getBounds(tile_xmin, tile_ymin, tile_xmax, tile_ymax);
 
     // Sampling intervals:
-    double dx = (tile_xmax - tile_xmin) / (tileSize - 1);
-    double dy = (tile_ymax - tile_ymin) / (tileSize - 1);
+    double dx = (tile_xmax - tile_xmin) / (cols - 1);
+    double dy = (tile_ymax - tile_ymin) / (rows - 1);
 
     // Assume the first band contains our data
     auto* band = _warpedDS->GetRasterBand(1);
@@ -1488,10 +1647,10 @@ GDAL::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOO
         // Note. This method always works, but it's slow.
         // It wound be ideal to use the method in the "else" block but it
         // does not yet work with the half-pixel shift that is required for DEMs.
-        for (unsigned r = 0; r < tileSize; ++r)
+        for (unsigned r = 0; r < rows; ++r)
         {
             double y = tile_ymin + (dy * (double)r);
-            for (unsigned c = 0; c < tileSize; ++c)
+            for (unsigned c = 0; c < cols; ++c)
             {
                 double x = tile_xmin + (dx * (double)c);
                 float h = getInterpolatedDEMValue(band, x, y, true) * _linearUnits;
@@ -1517,7 +1676,7 @@ GDAL::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOO
 
         // Allocate a read workspace for RasterIO.
         // note: workspace is a thread_local vector, see above
-        int workspace_width = tileSize, workspace_height = tileSize;
+        int workspace_width = cols, workspace_height = rows;
 
         workspace.assign(workspace_width * workspace_height, NO_DATA_VALUE);
 
@@ -1547,13 +1706,13 @@ GDAL::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOO
 
         // Fill the heightfield by transforming the tile's coordinates to the buffer's coordinates
         // and sampling the buffer.
-        for (unsigned r = 0; r < tileSize; ++r)
+        for (unsigned r = 0; r < rows; ++r)
         {
             double y = tile_ymin + (dy * (double)r);
             double v = (y - buf_ymin) / (buf_ymax - buf_ymin);
             if (equiv(v, 0.0, epsilon)) v = 0.0;
 
-            for (unsigned c = 0; c < tileSize; ++c)
+            for (unsigned c = 0; c < cols; ++c)
             {
                 double x = tile_xmin + (dx * (double)c);
                 double u = (x - buf_xmin) / (buf_xmax - buf_xmin);
@@ -1566,10 +1725,45 @@ GDAL::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOO
         }
 
         // Apply any scale/offset found in the source:
-        applyScaleAndOffset(band, (void*)hf->data<float>(), GDT_Float32, tileSize, tileSize);
+        applyScaleAndOffset(band, (void*)hf->data<float>(), GDT_Float32, cols, rows);
     }
 
     return hf;
 }
 
+std::vector<Result<std::shared_ptr<Heightfield>>>
+GDAL::Driver::createHeightfields(const std::vector<TileKey>& keys, unsigned tileSize, const IOOptions& io)
+{
+    std::vector<Result<std::shared_ptr<Heightfield>>> results(keys.size(), Status(Status::ResourceUnavailable));
+
+    KeyBlock block(keys);
+    if (!block.extent.valid() || (maxDataLevel.has_value() && block.level > maxDataLevel) || io.canceled())
+    {
+        return results;
+    }
+
+    // Heightfield samples include the tile edges, so neighbors share a row
+    // or column of samples.
+    unsigned step = tileSize - 1;
+
+    auto all = createHeightfield(block.extent, block.cols() * step + 1, block.rows() * step + 1, io);
+    if (all.status.failed())
+    {
+        std::fill(results.begin(), results.end(), all.status);
+        return results;
+    }
+
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        if (!intersects(keys[i]))
+            continue;
+
+        auto hf = Heightfield::create(tileSize, tileSize);
+        copyBlock(all.value.get(), (keys[i].x - block.minX) * step, (block.maxY - keys[i].y) * step, hf.get());
+        results[i] = hf;
+    }
+
+    return results;
+}
+
 #endif // ROCKY_HAS_GDAL
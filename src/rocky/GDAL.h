@@ -12,6 +12,10 @@
 #include <rocky/Image.h>
 #include <rocky/GeoExtent.h>
 #include <rocky/TileKey.h>
+#include <rocky/Threading.h>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 class GDALDataset;
 class GDALRasterBand;
@@ -47,6 +51,10 @@ namespace ROCKY_NAMESPACE
             //! Interpolation method for resampling (default is average)
             option<Interpolation> interpolation = Interpolation::AVERAGE;
 
+            //! Read the four children of a tile together in one warp when the
+            //! terrain pager loads any one of them (default is true)
+            option<bool> batchSiblings = true;
+
         protected:
             option<bool> singleThreaded = false;
         };
@@ -110,11 +118,22 @@ namespace ROCKY_NAMESPACE
             //! Creates an image if possible
             Result<std::shared_ptr<Heightfield>> createHeightfield(const TileKey& key, unsigned tileSize, const IOOptions& io);
 
+            //! Creates images for a block of adjacent keys at the same level
+            //! (e.g., the four children of a tile) with a single warped read
+            //! of their combined extent. Results are in the order of the keys.
+            std::vector<Result<std::shared_ptr<Image>>> createImages(const std::vector<TileKey>& keys, unsigned tileSize, const IOOptions& io);
+
+            //! Creates heightfields for a block of adjacent keys at the same
+            //! level with a single read of their combined extent.
+            std::vector<Result<std::shared_ptr<Heightfield>>> createHeightfields(const std::vector<TileKey>& keys, unsigned tileSize, const IOOptions& io);
+
             const Profile& profile() const {
                 return _profile;
             }
 
         private:
+            Result<std::shared_ptr<Image>> createImage(const GeoExtent& extent, unsigned width, unsigned height, const IOOptions& io);
+            Result<std::shared_ptr<Heightfield>> createHeightfield(const GeoExtent& extent, unsigned cols, unsigned rows, const IOOptions& io);
             void pixelToGeo(double, double, double&, double&);
             void geoToPixel(double, double, double&, double&);
 
@@ -143,12 +162,107 @@ namespace ROCKY_NAMESPACE
             const std::string& getName() const { return _name; }
         };
 
+        /**
+         * Shares batched reads among sibling tiles.
+         *
+         * The terrain pager always creates tiles in quads and requests the
+         * data for all four at about the same time. The first request in a
+         * quad reads all four tiles at once; concurrent requests for the
+         * siblings wait for that read, and later ones find their results
+         * held here until they pick them up.
+         */
+        template<typename T>
+        class SiblingBatcher
+        {
+        public:
+            using Batch = std::vector<Result<std::shared_ptr<T>>>;
+
+            //! @param capacity Maximum number of quads to hold for siblings
+            SiblingBatcher(unsigned capacity = 16) : _capacity(capacity) { }
+
+            //! Result for "key". Calls readBatch(keys) with the four siblings
+            //! of "key" unless a sibling already did.
+            template<typename FUNC>
+            Result<std::shared_ptr<T>> read(const TileKey& key, const IOOptions& io, FUNC&& readBatch)
+            {
+                auto parent = key.createParentKey();
+                auto quadrant = key.getQuadrant();
+
+                std::shared_ptr<Batch> batch;
+                {
+                    std::scoped_lock lock(_mutex);
+                    auto i = _entries.find(parent);
+                    if (i != _entries.end())
+                        batch = i->second.batch;
+                }
+
+                if (!batch)
+                {
+                    auto flight = _flights.run(parent, [&]() -> std::optional<std::shared_ptr<Batch>>
+                        {
+                            std::vector<TileKey> keys = {
+                                parent.createChildKey(0), parent.createChildKey(1),
+                                parent.createChildKey(2), parent.createChildKey(3) };
+
+                            auto result = std::make_shared<Batch>(readBatch(keys));
+
+                            // a canceled read is not shared; siblings will try again
+                            if (io.canceled())
+                                return std::nullopt;
+
+                            std::scoped_lock lock(_mutex);
+                            _entries[parent].batch = result;
+                            _order.push_back(parent);
+                            while (_order.size() > _capacity)
+                            {
+                                _entries.erase(_order.front());
+                                _order.pop_front();
+                            }
+                            return result;
+                        });
+
+                    if (!flight.has_value())
+                        return Status(Status::ResourceUnavailable);
+
+                    batch = flight.value();
+                }
+
+                // release the quad once all four tiles have taken their results
+                {
+                    std::scoped_lock lock(_mutex);
+                    auto i = _entries.find(parent);
+                    if (i != _entries.end() && (i->second.taken |= (1u << quadrant)) == 0xF)
+                        _entries.erase(i);
+                }
+
+                return (*batch)[quadrant];
+            }
+
+        private:
+            struct Entry
+            {
+                std::shared_ptr<Batch> batch;
+                unsigned taken = 0u;
+            };
+            std::mutex _mutex;
+            std::unordered_map<TileKey, Entry> _entries;
+            std::deque<TileKey> _order;
+            util::SingleFlight<TileKey, std::shared_ptr<Batch>> _flights;
+            unsigned _capacity;
+        };
+
         //! Reads an image from raw data using the specified GDAL driver.
         extern ROCKY_EXPORT Result<std::shared_ptr<Image>> readImage(
             unsigned char* data,
             std::size_t len,
             const std::string& gdal_driver);
 
+        //! Encodes an image into raw data using the specified GDAL driver
+        //! (e.g., "PNG", "JPEG", "GTiff").
+        extern ROCKY_EXPORT Result<std::string> writeImage(
+            std::shared_ptr<Image> image,
+            const std::string& gdal_driver);
+
     } // namespace GDAL
 
 } // namespace ROCKY_NAMESPACE
@@ -81,6 +81,7 @@ GDALElevationLayer::construct(const std::string& JSON, const IOOptions& io)
     if (temp == "nearest") interpolation = Interpolation::NEAREST;
     else if (temp == "bilinear") interpolation = Interpolation::BILINEAR;
     get_to(j, "single_threaded", singleThreaded);
+    get_to(j, "batch_siblings", batchSiblings);
 
     // default for GDAL elevation is nearest-neighbor.
     if (!interpolation.has_value())
@@ -103,6 +104,7 @@ GDALElevationLayer::to_json() const
     else if (interpolation.has_value(Interpolation::BILINEAR))
         set(j, "interpolation", "bilinear");
     set(j, "single_threaded", singleThreaded);
+    set(j, "batch_siblings", batchSiblings);
     return j.dump();
 }
 
@@ -164,7 +166,21 @@ GDALElevationLayer::createHeightfieldImplementation(const TileKey& key, const IO
 
     if (driver.isOpen())
     {
-        auto r = driver.createHeightfield(key, tileSize, io);
+        Result<std::shared_ptr<Heightfield>> r;
+
+        // the pager loads tiles in quads, so read all four at once;
+        // other reads would pay for three tiles they don't need
+        if (batchSiblings == true && key.level > 0 && io.quadLoadKey == key)
+        {
+            r = _siblings.read(key, io, [&](const std::vector<TileKey>& keys)
+                {
+                    return driver.createHeightfields(keys, tileSize, io);
+                });
+        }
+        else
+        {
+            r = driver.createHeightfield(key, tileSize, io);
+        }
 
         if (r.status.ok())
         {
@@ -46,6 +46,7 @@ namespace ROCKY_NAMESPACE
         void construct(const std::string& JSON, const IOOptions& io);
 
         mutable util::ThreadLocal<GDAL::Driver> _drivers;
+        mutable GDAL::SiblingBatcher<Heightfield> _siblings;
         friend class GDAL::Driver;
     };
 
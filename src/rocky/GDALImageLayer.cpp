@@ -80,6 +80,7 @@ GDALImageLayer::construct(const std::string& JSON, const IOOptions& io)
     if (temp == "nearest") interpolation = Interpolation::NEAREST;
     else if (temp == "bilinear") interpolation = Interpolation::BILINEAR;
     get_to(j, "single_threaded", singleThreaded);
+    get_to(j, "batch_siblings", batchSiblings);
 
     setRenderType(RenderType::TERRAIN_SURFACE);
 }
@@ -96,6 +97,7 @@ GDALImageLayer::to_json() const
     else if (interpolation.has_value(Interpolation::BILINEAR))
         set(j, "interpolation", "bilinear");
     set(j, "single_threaded", singleThreaded);
+    set(j, "batch_siblings", batchSiblings);
     return j.dump();
 }
 
@@ -157,7 +159,22 @@ GDALImageLayer::createImageImplementation(const TileKey& key, const IOOptions& i
 
     if (driver.isOpen())
     {
-        auto image = driver.createImage(key, tileSize, io);
+        Result<std::shared_ptr<Image>> image;
+
+        // the pager loads tiles in quads, so read all four in one warp;
+        // other reads would pay for three tiles they don't need
+        if (batchSiblings == true && key.level > 0 && io.quadLoadKey == key)
+        {
+            image = _siblings.read(key, io, [&](const std::vector<TileKey>& keys)
+                {
+                    return driver.createImages(keys, tileSize, io);
+                });
+        }
+        else
+        {
+            image = driver.createImage(key, tileSize, io);
+        }
+
         if (image.value)
             return GeoImage(image.value, key.extent());
     }
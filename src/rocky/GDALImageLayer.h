@@ -46,6 +46,7 @@ namespace ROCKY_NAMESPACE
         void construct(const std::string& JSON, const IOOptions& io);
 
         mutable util::ThreadLocal<GDAL::Driver> _drivers;
+        mutable GDAL::SiblingBatcher<Image> _siblings;
         //mutable util::ThreadLocal<std::shared_ptr<GDAL::Driver>> _drivers;
         friend class GDAL::Driver;
     };
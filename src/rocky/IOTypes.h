@@ -5,11 +5,13 @@
  */
 #pragma once
 
+#include <rocky/Buffer.h>
 #include <rocky/DateTime.h>
 #include <rocky/Status.h>
 #include <rocky/Units.h>
 #include <rocky/Threading.h>
 #include <rocky/LRUCache.h>
+#include <rocky/TileKey.h>
 #include <optional>
 #include <string>
 
@@ -18,13 +20,34 @@
  */
 namespace ROCKY_NAMESPACE
 {
+    class HTTPConnectionPool;
     class IOOptions;
     class Image;
     class Layer;
+    template<typename T> struct IOResult;
 
-    //! Base class for a cache
-    class Cache : public Inherit<Object, Cache>
+    //! Raw content read from a URI
+    struct Content {
+        std::string contentType;
+        Buffer data;
+        std::chrono::system_clock::time_point timestamp;
+    };
+
+    //! Base class for a persistent content cache
+    class ROCKY_EXPORT Cache : public Inherit<Object, Cache>
     {
+    public:
+        //! Fetch an entry from the cache
+        virtual Result<Content> read(const std::string& key) const = 0;
+
+        //! Store an entry in the cache, replacing any existing entry
+        virtual Status write(const std::string& key, const Content& content) = 0;
+
+        //! Remove an entry from the cache
+        virtual void remove(const std::string& key) = 0;
+
+        //! Remove all entries from the cache
+        virtual void clear() = 0;
     };
 
     //! Service for reading an image from a URI
@@ -39,10 +62,6 @@ namespace ROCKY_NAMESPACE
     using WriteImageStreamService = std::function<
         Status(std::shared_ptr<Image> image, std::ostream& stream, std::string contentType, const IOOptions& io)>;
 
-    //! Service for caching data
-    using CacheImpl = void*; // todo.
-    using CacheService = std::function<std::shared_ptr<CacheImpl>()>;
-
     //! Service for accessing other data
     class DataInterface {
     public:
@@ -50,13 +69,15 @@ namespace ROCKY_NAMESPACE
     };
     using DataService = std::function<DataInterface&()>;
 
-    struct Content {
-        std::string contentType;
-        std::string data;
-        std::chrono::system_clock::time_point timestamp;
+    //! Cost of a content cache entry in bytes
+    struct ContentCost {
+        inline std::size_t operator()(const Result<Content>& r) const {
+            return r.value.data.size() + r.value.contentType.size() + sizeof(Result<Content>);
+        }
     };
 
-    using ContentCache = rocky::util::LRUCache<std::string, Result<Content>>;
+    //! In-memory cache of recently read content, budgeted in bytes
+    using ContentCache = rocky::util::LRUCache<std::string, Result<Content>, ContentCost>;
 
     class ROCKY_EXPORT Services
     {
@@ -70,8 +91,13 @@ namespace ROCKY_NAMESPACE
         ReadImageURIService readImageFromURI;
         ReadImageStreamService readImageFromStream;
         WriteImageStreamService writeImageToStream;
-        //CacheService cache = nullptr;
         std::shared_ptr<ContentCache> contentCache;
+
+        //! Persistent cache consulted for remote content (optional)
+        std::shared_ptr<Cache> cache;
+
+        //! Keep-alive HTTP connections shared by remote reads (optional)
+        std::shared_ptr<HTTPConnectionPool> httpPool;
     };
 
     /**
@@ -106,8 +132,14 @@ namespace ROCKY_NAMESPACE
         //! Referring location for an operation using these options
         std::optional<std::string> referrer;
 
-        //! Gate for seriaizing duplicate URI requests (shared)
-        mutable std::shared_ptr<util::Gate<std::string>> uriGate;
+        //! Coalesces duplicate concurrent URI requests into one fetch (shared)
+        mutable std::shared_ptr<util::SingleFlight<std::string, IOResult<Content>>> uriFlights;
+
+        //! Key of the tile the terrain pager is loading, if any. The pager
+        //! loads sibling tiles together, so a layer asked for exactly this key
+        //! may read all four siblings at once. Reads of any other key (fallbacks,
+        //! neighbors, mosaics) should not.
+        std::optional<TileKey> quadLoadKey;
 
     public:
         IOOptions& operator = (const IOOptions& rhs);
@@ -4,6 +4,7 @@
  * MIT License
  */
 #include "Image.h"
+#include "BlockCompressor.h"
 
 using namespace ROCKY_NAMESPACE;
 
@@ -59,34 +60,62 @@ namespace
                 *sptr++ = (T)pixel[i];
         }
     };
+
+    // 2x2 box filter of one row of 8-bit pixels (N components each) from two
+    // rows of the level above. Integer math on fixed-size pixels with no
+    // dependencies between outputs, so the compiler can vectorize the loop.
+    template<unsigned N>
+    void box_filter_row_8(const uchar* row0, const uchar* row1, unsigned srcWidth, uchar* out, unsigned outWidth)
+    {
+        const unsigned pairs = srcWidth / 2;
+        for (unsigned p = 0; p < pairs; ++p)
+        {
+            const uchar* a = row0 + p * 2 * N;
+            const uchar* b = row1 + p * 2 * N;
+            for (unsigned c = 0; c < N; ++c)
+                out[p * N + c] = (uchar)((a[c] + a[c + N] + b[c] + b[c + N] + 2) >> 2);
+        }
+
+        // odd width: the last pixel has no partner
+        if (outWidth > pairs)
+        {
+            auto s = (srcWidth - 1) * N;
+            for (unsigned c = 0; c < N; ++c)
+                out[pairs * N + c] = (uchar)((row0[s + c] + row1[s + c] + 1) >> 1);
+        }
+    }
 }
 
 // static member
-Image::Layout Image::_layouts[7] =
+Image::Layout Image::_layouts[NUM_PIXEL_FORMATS] =
 {
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 1, 1, R8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 2, 2, R8G8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 3, 3, R8G8B8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 4, 4, R8G8B8A8_UNORM },
-    { &NORM16<ushort>::read, &NORM16<ushort>::write, 1, 2, R16_UNORM },
-    { &FLOAT<float>::read, &FLOAT<float>::write, 1, 4, R32_SFLOAT },
-    { &FLOAT<double>::read, &FLOAT<double>::write, 1, 8, R64_SFLOAT }
+    { &NORM8<uchar>::read, &NORM8<uchar>::write, 1, 1, R8_UNORM, 0 },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write, 2, 2, R8G8_UNORM, 0 },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write, 3, 3, R8G8B8_UNORM, 0 },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write, 4, 4, R8G8B8A8_UNORM, 0 },
+    { &NORM16<ushort>::read, &NORM16<ushort>::write, 1, 2, R16_UNORM, 0 },
+    { &FLOAT<float>::read, &FLOAT<float>::write, 1, 4, R32_SFLOAT, 0 },
+    { &FLOAT<double>::read, &FLOAT<double>::write, 1, 8, R64_SFLOAT, 0 },
+    // compressed formats are read by block (see readCompressed)
+    { nullptr, nullptr, 3, 0, BC1_RGB_UNORM, 8 },
+    { nullptr, nullptr, 4, 0, BC3_UNORM, 16 },
+    { nullptr, nullptr, 4, 0, BC7_UNORM, 16 }
 };
 
-Image::Image(PixelFormat format, unsigned cols, unsigned rows, unsigned depth) :    
+Image::Image(PixelFormat format, unsigned cols, unsigned rows, unsigned depth, unsigned mipLevels) :    
     super(),
     _width(0), _height(0), _depth(0),
     _pixelFormat(R8G8B8A8_UNORM),
     _data(nullptr)
 {
-    allocate(format, cols, rows, depth);
+    allocate(format, cols, rows, depth, mipLevels);
 }
 
 Image::Image(const Image& rhs) :
     super(rhs)
 {
-    allocate(rhs.pixelFormat(), rhs.width(), rhs.height(), rhs.depth());
-    memcpy(_data, rhs._data, sizeInBytes());
+    allocate(rhs.pixelFormat(), rhs.width(), rhs.height(), rhs.depth(), rhs.mipLevels());
+    memcpy(_data, rhs._data, sizeInBytesWithMipmaps());
 }
 
 Image::Image(Image&& rhs) noexcept :
@@ -97,6 +126,7 @@ Image::Image(Image&& rhs) noexcept :
         _width = rhs._width;
         _height = rhs._height;
         _depth = rhs._depth;
+        _mipLevels = rhs._mipLevels;
         _pixelFormat = rhs._pixelFormat;
         _data = rhs.releaseData();
     }
@@ -112,7 +142,28 @@ bool
 Image::hasAlphaChannel() const
 {
     return
-        pixelFormat() == R8G8B8A8_UNORM;
+        pixelFormat() == R8G8B8A8_UNORM ||
+        pixelFormat() == BC3_UNORM ||
+        pixelFormat() == BC7_UNORM;
+}
+
+void
+Image::readCompressed(Pixel& pixel, unsigned s, unsigned t, unsigned layer) const
+{
+    auto blocksWide = (width() + 3) / 4;
+    auto blocksHigh = (height() + 3) / 4;
+    auto block = _data + (blocksWide * blocksHigh * layer + blocksWide * (t / 4) + (s / 4)) * _layouts[pixelFormat()].block_bytes;
+
+    unsigned char rgba[64];
+    if (util::BlockCompressor::decodeBlock(pixelFormat(), block, rgba))
+    {
+        auto p = &rgba[((t % 4) * 4 + (s % 4)) * 4];
+        pixel = Pixel(p[0], p[1], p[2], p[3]) * (1.0f / 255.0f);
+    }
+    else
+    {
+        pixel = Pixel(0, 0, 0, 0);
+    }
 }
 
 std::shared_ptr<Image>
@@ -123,10 +174,13 @@ Image::clone() const
     auto clone = Image::create(
         pixelFormat(), width(), height(), depth());
 
+    if (mipLevels() > 1)
+        clone->allocate(pixelFormat(), width(), height(), depth(), mipLevels());
+
     memcpy(
         clone->data<unsigned char*>(),
         _data,
-        sizeInBytes());
+        sizeInBytesWithMipmaps());
 
     return clone;
 }
@@ -136,16 +190,18 @@ Image::allocate(
     PixelFormat pixelFormat_,
     unsigned width_,
     unsigned height_,
-    unsigned depth_)
+    unsigned depth_,
+    unsigned mipLevels_)
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(
-        width_ > 0 && height_ > 0 && depth_ > 0 &&
+        width_ > 0 && height_ > 0 && depth_ > 0 && mipLevels_ > 0 &&
         (unsigned)pixelFormat_ >= 0 && pixelFormat_ < NUM_PIXEL_FORMATS,
         void());
     
     _width = width_;
     _height = height_;
     _depth = depth_;
+    _mipLevels = mipLevels_;
     _pixelFormat = pixelFormat_;
 
     auto layout = _layouts[pixelFormat()];
@@ -153,7 +209,7 @@ Image::allocate(
     if (_data)
         delete[] _data;
 
-    _data = new unsigned char[sizeInBytes()];
+    _data = new unsigned char[sizeInBytesWithMipmaps()];
 
     // simple init for one-byte images
     if (sizeInBytes() > 0)
@@ -168,6 +224,7 @@ Image::releaseData()
     _width = 0;
     _height = 0;
     _depth = 0;
+    _mipLevels = 1;
     return released;
 }
 
@@ -271,4 +328,69 @@ Image::sharpen(float k) const
 #endif
 
     return convolve(kernel);
-}
\ No newline at end of file
+}
+
+std::shared_ptr<Image>
+Image::generateMipmaps() const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(valid() && depth() == 1 && !isCompressed(), nullptr);
+
+    unsigned levels = 1;
+    while ((std::max(width(), height()) >> levels) > 0)
+        ++levels;
+
+    auto result = Image::create();
+    result->allocate(pixelFormat(), width(), height(), 1, levels);
+    memcpy(result->_data, _data, sizeInBytes());
+
+    const auto& layout = _layouts[pixelFormat()];
+    const unsigned bpp = layout.bytes_per_pixel;
+
+    for (unsigned level = 1; level < levels; ++level)
+    {
+        const unsigned srcWidth = result->mipmapWidth(level - 1), srcHeight = result->mipmapHeight(level - 1);
+        const unsigned outWidth = result->mipmapWidth(level), outHeight = result->mipmapHeight(level);
+        const unsigned char* src = result->data_at_miplevel(level - 1);
+        unsigned char* out = result->data_at_miplevel(level);
+
+        for (unsigned t = 0; t < outHeight; ++t)
+        {
+            // odd height: the last row pairs with itself
+            const unsigned char* row0 = src + std::min(2 * t, srcHeight - 1) * srcWidth * bpp;
+            const unsigned char* row1 = src + std::min(2 * t + 1, srcHeight - 1) * srcWidth * bpp;
+            unsigned char* row = out + t * outWidth * bpp;
+
+            switch (pixelFormat())
+            {
+            case R8_UNORM:
+                box_filter_row_8<1>(row0, row1, srcWidth, row, outWidth);
+                break;
+            case R8G8_UNORM:
+                box_filter_row_8<2>(row0, row1, srcWidth, row, outWidth);
+                break;
+            case R8G8B8_UNORM:
+                box_filter_row_8<3>(row0, row1, srcWidth, row, outWidth);
+                break;
+            case R8G8B8A8_UNORM:
+                box_filter_row_8<4>(row0, row1, srcWidth, row, outWidth);
+                break;
+            default:
+                // other formats go through the generic pixel accessors
+                for (unsigned s = 0; s < outWidth; ++s)
+                {
+                    const unsigned s0 = std::min(2 * s, srcWidth - 1) * bpp;
+                    const unsigned s1 = std::min(2 * s + 1, srcWidth - 1) * bpp;
+                    Pixel a, b, c, d;
+                    layout.read(a, const_cast<unsigned char*>(row0 + s0), layout.num_components);
+                    layout.read(b, const_cast<unsigned char*>(row0 + s1), layout.num_components);
+                    layout.read(c, const_cast<unsigned char*>(row1 + s0), layout.num_components);
+                    layout.read(d, const_cast<unsigned char*>(row1 + s1), layout.num_components);
+                    layout.write((a + b + c + d) * 0.25f, row + s * bpp, layout.num_components);
+                }
+                break;
+            }
+        }
+    }
+
+    return result;
+}
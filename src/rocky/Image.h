@@ -29,6 +29,9 @@ namespace ROCKY_NAMESPACE
             R16_UNORM,
             R32_SFLOAT,
             R64_SFLOAT,
+            BC1_RGB_UNORM,  // block-compressed: opaque color, 4 bits per pixel
+            BC3_UNORM,      // block-compressed: color and alpha, 8 bits per pixel
+            BC7_UNORM,      // block-compressed: color and alpha, 8 bits per pixel
             NUM_PIXEL_FORMATS,
             UNDEFINED
         };
@@ -51,13 +54,22 @@ namespace ROCKY_NAMESPACE
         //! Whether there's an alpha channel
         bool hasAlphaChannel() const;
 
+        //! Whether the pixel format is block-compressed (in 4x4 pixel blocks).
+        //! Compressed images are read-only: write() does nothing and the
+        //! image processing functions don't support them.
+        inline bool isCompressed() const;
+
+        //! Number of mipmap levels in the data, counting the image itself
+        //! as level 0. Only generateMipmaps() makes images with more than one.
+        unsigned mipLevels() const { return _mipLevels; }
+
     public:
         //! Construct an empty (invalid) image
         Image() = default;
 
         //! Construct an image an allocate memory for it,
         //! unless data is non-null, in which case use that memory
-        Image(PixelFormat format, unsigned s, unsigned t, unsigned r = 1);
+        Image(PixelFormat format, unsigned s, unsigned t, unsigned r = 1, unsigned mipLevels = 1);
 
         //! Copy constructor
         Image(const Image& rhs);
@@ -121,7 +133,8 @@ namespace ROCKY_NAMESPACE
             return reinterpret_cast<T*>(_data)[offset];
         }
 
-        //! Read the pixel at a column, row, and layer
+        //! Read the pixel at a column, row, and layer. Compressed images decode
+        //! a whole block for each read, so this is slow for them.
         inline void read(Pixel& pixel, unsigned s, unsigned t, unsigned layer = 0) const;
 
         //! Read the pixel at the location in an iterator
@@ -148,6 +161,26 @@ namespace ROCKY_NAMESPACE
         //! Size of this image in bytes
         inline unsigned sizeInBytes() const;
 
+        //! Size of this image in bytes, including all its mipmap levels
+        inline unsigned sizeInBytesWithMipmaps() const;
+
+        //! Width of a mipmap level
+        inline unsigned mipmapWidth(unsigned level) const;
+
+        //! Height of a mipmap level
+        inline unsigned mipmapHeight(unsigned level) const;
+
+        //! Pointer to the data of a mipmap level (type T). The levels
+        //! follow one another in memory, each half the size of the last.
+        template<class T> const T* mipmapData(unsigned level) const {
+            return reinterpret_cast<const T*>(data_at_miplevel(level));
+        }
+
+        //! Pointer to the data of a mipmap level (type T).
+        template<class T> T* mipmapData(unsigned level) {
+            return reinterpret_cast<T*>(data_at_miplevel(level));
+        }
+
         //! Size of this image in pixels
         inline unsigned sizeInPixels() const;
 
@@ -170,6 +203,12 @@ namespace ROCKY_NAMESPACE
         //! Creates a resized clone of this image
         std::shared_ptr<Image> resize(unsigned width, unsigned height) const;
 
+        //! Creates a clone of this image with a full chain of mipmap levels,
+        //! down to 1x1, each one a 2x2 box filter of the level above it.
+        //! Only 2D images (depth = 1) are supported.
+        //! Changes made to the clone afterwards do not update its mipmaps.
+        std::shared_ptr<Image> generateMipmaps() const;
+
         //! Creates a sharpened clone of this image.
         //! @param strength sharpening kernel strength, 1-5 is typically a reasonable range
         std::shared_ptr<Image> sharpen(
@@ -201,10 +240,11 @@ namespace ROCKY_NAMESPACE
 
     protected:
         unsigned _width = 0, _height = 0, _depth = 0;
+        unsigned _mipLevels = 1;
         PixelFormat _pixelFormat = R8G8B8A8_UNORM;
         unsigned char* _data = nullptr;
 
-        void allocate(PixelFormat format, unsigned s, unsigned t, unsigned r);
+        void allocate(PixelFormat format, unsigned s, unsigned t, unsigned r, unsigned mipLevels = 1);
 
         struct Layout {
             void(*read)(Pixel&, unsigned char*, int);
@@ -212,11 +252,15 @@ namespace ROCKY_NAMESPACE
             int num_components;
             int bytes_per_pixel;
             PixelFormat format;
+            int block_bytes; // bytes per 4x4 block of a compressed format; 0 otherwise
         };
-        static Layout _layouts[7];
+        static Layout _layouts[NUM_PIXEL_FORMATS];
 
         inline unsigned sizeof_miplevel(unsigned level) const;
-        inline unsigned char* data_at_miplevel(unsigned level);
+        inline unsigned char* data_at_miplevel(unsigned level) const;
+        inline unsigned sizeof_region(unsigned width, unsigned height) const;
+
+        void readCompressed(Pixel& pixel, unsigned s, unsigned t, unsigned layer) const;
     };
 
 
@@ -227,8 +271,19 @@ namespace ROCKY_NAMESPACE
         return width() > 0 && height() > 0 && depth() > 0 && _data;
     }
 
+    bool Image::isCompressed() const
+    {
+        return _layouts[pixelFormat()].block_bytes > 0;
+    }
+
     void Image::read(Pixel& pixel, unsigned s, unsigned t, unsigned layer) const
     {
+        if (isCompressed())
+        {
+            readCompressed(pixel, s, t, layer);
+            return;
+        }
+
         _layouts[pixelFormat()].read(
             pixel,
             _data + (width()*height()*layer + width()*t + s)*_layouts[pixelFormat()].bytes_per_pixel,
@@ -265,6 +320,9 @@ namespace ROCKY_NAMESPACE
 
     void Image::write(const Pixel& pixel, unsigned s, unsigned t, unsigned layer)
     {
+        if (isCompressed())
+            return;
+
         _layouts[pixelFormat()].write(
             pixel,
             _data + (width()*height()*layer + height() * t + s)*_layouts[pixelFormat()].bytes_per_pixel,
@@ -273,7 +331,7 @@ namespace ROCKY_NAMESPACE
 
     unsigned Image::sizeInBytes() const
     {
-        return sizeInPixels() * _layouts[pixelFormat()].bytes_per_pixel;
+        return sizeof_region(width(), height());
     }
 
     unsigned Image::sizeInPixels() const
@@ -283,20 +341,50 @@ namespace ROCKY_NAMESPACE
 
     unsigned Image::rowSizeInBytes() const
     {
-        return width() * _layouts[pixelFormat()].bytes_per_pixel;
+        // for compressed formats, one row of blocks
+        auto& layout = _layouts[pixelFormat()];
+        return layout.block_bytes > 0 ?
+            ((width() + 3) / 4) * layout.block_bytes :
+            width() * layout.bytes_per_pixel;
+    }
+
+    unsigned Image::sizeInBytesWithMipmaps() const
+    {
+        unsigned size = 0;
+        for (unsigned level = 0; level < mipLevels(); ++level)
+            size += sizeof_miplevel(level);
+        return size;
     }
 
-    unsigned char* Image::data_at_miplevel(unsigned m)
+    unsigned Image::mipmapWidth(unsigned level) const
+    {
+        return std::max(width() >> level, 1u);
+    }
+
+    unsigned Image::mipmapHeight(unsigned level) const
+    {
+        return std::max(height() >> level, 1u);
+    }
+
+    unsigned char* Image::data_at_miplevel(unsigned m) const
     {
         auto d = _data;
-        for (int i = 0; i < (int)m; ++i)
+        for (unsigned i = 0; i < m; ++i)
             d += sizeof_miplevel(i);
         return d;
     }
 
     unsigned Image::sizeof_miplevel(unsigned level) const
     {
-        return (width() * height() * depth()) >> level;
+        return sizeof_region(mipmapWidth(level), mipmapHeight(level));
+    }
+
+    unsigned Image::sizeof_region(unsigned w, unsigned h) const
+    {
+        auto& layout = _layouts[pixelFormat()];
+        return layout.block_bytes > 0 ?
+            ((w + 3) / 4) * ((h + 3) / 4) * depth() * layout.block_bytes :
+            w * h * depth() * layout.bytes_per_pixel;
     }
 
     unsigned Image::numComponents() const
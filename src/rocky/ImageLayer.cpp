@@ -71,6 +71,8 @@ ImageLayer::construct(const std::string& JSON, const IOOptions& io)
     const auto j = parse_json(JSON);
     get_to(j, "sharpness", sharpness);
     get_to(j, "crop", crop);
+    get_to(j, "texture_compression", textureCompression);
+    get_to(j, "texture_compression_preset", textureCompressionPreset);
 
     setRenderType(RenderType::TERRAIN_SURFACE);
 }
@@ -81,6 +83,8 @@ ImageLayer::to_json() const
     auto j = parse_json(super::to_json());
     set(j, "sharpness", sharpness);
     set(j, "crop", crop);
+    set(j, "texture_compression", textureCompression);
+    set(j, "texture_compression_preset", textureCompressionPreset);
     return j.dump();
 }
 
@@ -20,6 +20,15 @@ namespace ROCKY_NAMESPACE
         //! Sharpness filter strength to apply to the image
         option<float> sharpness = 0.0f;
 
+        //! GPU block compression for this layer's terrain textures:
+        //! "bc1" (opaque), "bc3" or "bc7" (with alpha), or "auto" to pick
+        //! BC1 or BC7 per tile. Unset means uncompressed. Ignored unless the
+        //! GPU supports BC texture formats.
+        option<std::string> textureCompression;
+
+        //! Encoder preset for textureCompression: "fast" or "quality"
+        option<std::string> textureCompressionPreset = { "fast" };
+
         //! Creates an image for the given tile key.
         //! @param key TileKey for which to create an image
         //! @param io IO options
@@ -6,75 +6,237 @@
 #pragma once
 #include <rocky/Common.h>
 #include <rocky/Utils.h>
-#include <mutex>
+#include <atomic>
 #include <list>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace ROCKY_NAMESPACE
 {
     namespace util
     {
-        // Adapted from https://www.geeksforgeeks.org/lru-cache-implementation
-        template<class K, class V>
-        class LRUCache
+        //! Default cost function for LRUCache: each entry costs one unit,
+        //! making the capacity a maximum number of entries.
+        template<class V>
+        struct unit_cost
         {
-        private:
-            mutable std::mutex mutex;
-            int capacity;
-            using E = typename std::pair<K, V>;
-            typename std::list<E> cache;
-            vector_map<K, typename std::list<E>::iterator> map;
+            inline std::size_t operator()(const V&) const { return 1u; }
+        };
 
+        /**
+        * Thread-safe, sharded least-recently-used cache.
+        *
+        * Keys are hashed into independent shards, each with its own lock and
+        * eviction list, so threads working on different keys rarely contend.
+        * Reads only take a shared lock; recency is tracked with a "referenced"
+        * flag and eviction uses the second-chance (CLOCK) approximation of LRU.
+        *
+        * The capacity is expressed in the units returned by the COST functor
+        * (e.g. bytes) and is split evenly across the shards. A capacity of
+        * zero disables the cache.
+        */
+        template<class K, class V, class COST = unit_cost<V>, class HASH = std::hash<K>>
+        class LRUCache
+        {
         public:
-            int hits = 0;
-            int gets = 0;
+            //! Snapshot of cache statistics
+            struct Stats
+            {
+                std::uint64_t gets = 0;
+                std::uint64_t hits = 0;
+                std::uint64_t evictions = 0;
+                std::size_t cost = 0;
+                std::size_t entries = 0;
 
-            LRUCache(int capacity_ = 32) : capacity(capacity_) { }
+                //! Hit ratio [0..1]
+                float hitRatio() const {
+                    return gets > 0 ? (float)hits / (float)gets : 0.0f;
+                }
+            };
+
+            //! Construct a cache
+            //! @param capacity Total capacity in cost units
+            //! @param numShards Number of independently locked shards
+            LRUCache(std::size_t capacity = 32, unsigned numShards = 8) :
+                _shards(std::max(1u, numShards))
+            {
+                setCapacity(capacity);
+            }
+
+            //! Set the total capacity (in cost units) and clear the cache.
+            //! Safe to call while other threads use the cache.
+            inline void setCapacity(std::size_t value)
+            {
+                _capacity = value;
+                auto perShard = (value + _shards.size() - 1) / _shards.size();
+                for (auto& shard : _shards)
+                {
+                    // clear and resize under one lock so no put() lands in between
+                    std::unique_lock lock(shard.mutex);
+                    _cost -= shard.cost;
+                    shard.cost = 0;
+                    shard.map.clear();
+                    shard.list.clear();
+                    shard.capacity = perShard;
+                }
+                _gets = 0, _hits = 0, _evictions = 0;
+            }
 
-            inline void setCapacity(int value)
+            //! Total capacity in cost units.
+            inline std::size_t capacity() const
             {
-                std::scoped_lock L(mutex);
-                cache.clear();
-                map.clear();
-                hits = 0;
-                gets = 0;
-                capacity = std::max(0, value);
+                return _capacity;
             }
 
-            inline V get(const K& key)
+            //! Fetch a value, or a default-constructed V if the key isn't present.
+            inline V get(const K& key) const
             {
-                if (capacity == 0)
+                if (_capacity == 0)
                     return V();
-                std::scoped_lock L(mutex);
-                ++gets;
-                auto it = map.find(key);
-                if (it == map.end())
+
+                auto& shard = shardFor(key);
+                ++_gets;
+
+                std::shared_lock lock(shard.mutex);
+                auto it = shard.map.find(key);
+                if (it == shard.map.end())
                     return V();
-                cache.splice(cache.end(), cache, it->second);
-                ++hits;
-                return it->second->second;
+
+                it->second->referenced.store(true, std::memory_order_relaxed);
+                ++_hits;
+                return it->second->value;
             }
 
+            //! Insert or replace a value.
             inline void put(const K& key, const V& value)
             {
-                if (capacity == 0)
+                if (_capacity == 0)
                     return;
-                std::scoped_lock L(mutex);
-                if (cache.size() == capacity)
+
+                auto cost = COST()(value);
+                auto& shard = shardFor(key);
+
+                std::unique_lock lock(shard.mutex);
+
+                // capacity dropped to zero since the check above
+                if (shard.capacity == 0)
+                    return;
+
+                auto it = shard.map.find(key);
+                if (it != shard.map.end())
+                {
+                    shard.cost -= it->second->cost;
+                    _cost -= it->second->cost;
+                    shard.list.erase(it->second);
+                    shard.map.erase(it);
+                }
+
+                shard.list.emplace_back(key, value, cost);
+                auto newest = std::prev(shard.list.end());
+                shard.map[key] = newest;
+                shard.cost += cost;
+                _cost += cost;
+
+                // evict until we're under budget, but always keep the newest entry.
+                while (shard.cost > shard.capacity && shard.list.size() > 1)
+                {
+                    auto& front = shard.list.front();
+                    if (shard.list.begin() == newest ||
+                        front.referenced.exchange(false, std::memory_order_relaxed))
+                    {
+                        // recently used - give it a second chance
+                        shard.list.splice(shard.list.end(), shard.list, shard.list.begin());
+                    }
+                    else
+                    {
+                        shard.cost -= front.cost;
+                        _cost -= front.cost;
+                        shard.map.erase(front.key);
+                        shard.list.pop_front();
+                        ++_evictions;
+                    }
+                }
+            }
+
+            //! Remove one entry from the cache
+            inline void erase(const K& key)
+            {
+                auto& shard = shardFor(key);
+                std::unique_lock lock(shard.mutex);
+                auto it = shard.map.find(key);
+                if (it != shard.map.end())
                 {
-                    auto first_key = cache.front().first;
-                    cache.pop_front();
-                    map.erase(first_key);
+                    shard.cost -= it->second->cost;
+                    _cost -= it->second->cost;
+                    shard.list.erase(it->second);
+                    shard.map.erase(it);
                 }
-                cache.emplace_back(key, value);
-                map[key] = std::prev(cache.end());
             }
 
+            //! Remove all entries and reset the statistics.
             inline void clear()
             {
-                std::scoped_lock L(mutex);
-                cache.clear();
-                map.clear();
-                gets = 0, hits = 0;
+                for (auto& shard : _shards)
+                {
+                    std::unique_lock lock(shard.mutex);
+                    _cost -= shard.cost;
+                    shard.cost = 0;
+                    shard.map.clear();
+                    shard.list.clear();
+                }
+                _gets = 0, _hits = 0, _evictions = 0;
+            }
+
+            //! Current statistics. Safe to call from any thread.
+            inline Stats stats() const
+            {
+                Stats s;
+                s.gets = _gets;
+                s.hits = _hits;
+                s.evictions = _evictions;
+                s.cost = _cost;
+                for (auto& shard : _shards)
+                {
+                    std::shared_lock lock(shard.mutex);
+                    s.entries += shard.map.size();
+                }
+                return s;
+            }
+
+        private:
+            struct Node
+            {
+                Node(const K& k, const V& v, std::size_t c) : key(k), value(v), cost(c) { }
+                K key;
+                V value;
+                std::size_t cost;
+                mutable std::atomic_bool referenced = { false };
+            };
+
+            struct Shard
+            {
+                mutable std::shared_mutex mutex;
+                std::list<Node> list;
+                std::unordered_map<K, typename std::list<Node>::iterator, HASH> map;
+                std::size_t capacity = 0;
+                std::size_t cost = 0;
+            };
+
+            mutable std::vector<Shard> _shards;
+            std::atomic<std::size_t> _capacity = { 0 };
+            std::atomic<std::size_t> _cost = { 0 };
+            mutable std::atomic<std::uint64_t> _gets = { 0 };
+            mutable std::atomic<std::uint64_t> _hits = { 0 };
+            std::atomic<std::uint64_t> _evictions = { 0 };
+
+            inline Shard& shardFor(const K& key) const
+            {
+                // mix the hash bits so weak hashes (like identity) still spread out
+                std::uint64_t h = HASH()(key);
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                return _shards[h % _shards.size()];
             }
         };
     }
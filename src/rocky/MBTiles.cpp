@@ -9,6 +9,7 @@
 #include "Image.h"
 #include "json.h"
 #include "Context.h"
+#include "Threading.h"
 #include <filesystem>
 
 #include <sqlite3.h>
@@ -38,6 +39,22 @@ MBTiles::Driver::~Driver()
 void
 MBTiles::Driver::close()
 {
+    closeReaders();
+
+    if (_insertTile != nullptr)
+    {
+        sqlite3_finalize((sqlite3_stmt*)_insertTile);
+        _insertTile = nullptr;
+    }
+
+    if (_containsTile != nullptr)
+    {
+        sqlite3_finalize((sqlite3_stmt*)_containsTile);
+        _containsTile = nullptr;
+    }
+
+    _inTransaction = false;
+
     if (_database != nullptr)
     {
         sqlite3* database = (sqlite3*)_database;
@@ -56,8 +73,10 @@ MBTiles::Driver::open(
     const IOOptions& io)
 {
     _name = name;
+    _options = options;
 
     std::string fullFilename = options.uri->full();
+    _filename = fullFilename;
 
     bool readWrite = isWritingRequested;
 
@@ -99,6 +118,15 @@ MBTiles::Driver::open(
             << "Database \"" << fullFilename << "\": " << sqlite3_errmsg(database));
     }
 
+    if (readWrite && options.writeAheadLog == true)
+    {
+        // WAL only needs a sync at checkpoints, which is safe for a tile store
+        if (exec("PRAGMA journal_mode=WAL").failed() || exec("PRAGMA synchronous=NORMAL").failed())
+        {
+            Log()->warn(LC "Failed to enable write-ahead logging on " + fullFilename);
+        }
+    }
+
     // New database setup:
     if (isNewDatabase)
     {
@@ -291,8 +319,6 @@ MBTiles::Driver::readMaxLevel()
 Result<std::shared_ptr<Image>>
 MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
 {
-    std::scoped_lock lock(_mutex);
-
     int z = key.level;
     int x = key.x;
     int y = key.y;
@@ -311,85 +337,126 @@ MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
     auto [numCols, numRows] = key.profile.numTiles(key.level);
     y = numRows - y - 1;
 
-    sqlite3* database = (sqlite3*)_database;
-
-    //Get the image
-    sqlite3_stmt* select = NULL;
-    std::string query = "SELECT tile_data from tiles where zoom_level = ? AND tile_column = ? AND tile_row = ?";
-    int rc = sqlite3_prepare_v2(database, query.c_str(), -1, &select, 0L);
-    if (rc != SQLITE_OK)
+    auto reader = acquireReader();
+    if (reader.status.failed())
     {
-        return Status(Status::GeneralError, util::make_string()
-            << "Failed to prepare SQL: " << query << "; " << sqlite3_errmsg(database));
+        return reader.status;
     }
 
-    bool valid = true;
+    sqlite3_stmt* select = (sqlite3_stmt*)reader->selectTile;
 
     sqlite3_bind_int(select, 1, z);
     sqlite3_bind_int(select, 2, x);
     sqlite3_bind_int(select, 3, y);
 
-    Result<std::shared_ptr<Image>> result;
-    std::string errorMessage;
+    // copy the blob out so we can hand the connection back before doing
+    // the expensive part (decompression and decoding) in parallel.
+    Buffer dataBuffer;
+    bool found = false;
 
-    rc = sqlite3_step(select);
+    int rc = sqlite3_step(select);
     if (rc == SQLITE_ROW)
     {
-        // the pointer returned from _blob gets freed internally by sqlite, supposedly
         const char* data = (const char*)sqlite3_column_blob(select, 0);
         int dataLen = sqlite3_column_bytes(select, 0);
+        dataBuffer = std::string(data, dataLen);
+        found = true;
+    }
 
-        std::string dataBuffer(data, dataLen);
+    sqlite3_reset(select);
+    sqlite3_clear_bindings(select);
+    releaseReader(reader.value);
+
+    if (!found)
+    {
+        return Status(Status::ResourceUnavailable);
+    }
 
 #ifdef ROCKY_HAS_ZLIB
-        // decompress if necessary:
-        if (_options.compress == true)
-        {
-            std::istringstream inputStream(dataBuffer);
-            std::string value;
+    // decompress if necessary:
+    if (_options.compress == true)
+    {
+        BufferStream inputStream(dataBuffer);
+        std::string value;
 
-            if (!util::ZLibCompressor().decompress(inputStream, value))
-            {
-                errorMessage = "Decompression failed";
-                valid = false;
-            }
-            else
-            {
-                dataBuffer = value;
-            }
+        if (!util::ZLibCompressor().decompress(inputStream, value))
+        {
+            return Status(Status::GeneralError, "Decompression failed");
         }
+
+        dataBuffer = std::move(value);
+    }
 #endif // ROCKY_HAS_ZLIB
 
-        // decode the raw image data:
-        if (valid)
+    // decode the raw image data:
+    BufferStream inputStream(dataBuffer);
+    auto result = io.services.readImageFromStream(inputStream, {}, io);
+
+    return result;
+}
+
+Result<MBTiles::Driver::Reader>
+MBTiles::Driver::acquireReader() const
+{
+    {
+        std::scoped_lock lock(_readersMutex);
+        if (!_readers.empty())
         {
-            std::istringstream inputStream(dataBuffer);
-            result = io.services.readImageFromStream(inputStream, {}, io);
+            auto reader = _readers.back();
+            _readers.pop_back();
+            return reader;
         }
     }
 
-    sqlite3_finalize(select);
+    // none available; open another read-only connection to the same file.
+    sqlite3* database = nullptr;
+    int rc = sqlite3_open_v2(_filename.c_str(), &database, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, 0L);
+    if (rc != SQLITE_OK)
+    {
+        Status status(Status::ResourceUnavailable, "Database \"" + _filename + "\": " + sqlite3_errmsg(database));
+        sqlite3_close_v2(database);
+        return status;
+    }
+
+    // wait a little rather than fail if a writer holds the lock
+    sqlite3_busy_timeout(database, 1000);
 
-    if (!valid)
+    sqlite3_stmt* select = nullptr;
+    std::string query = "SELECT tile_data from tiles where zoom_level = ? AND tile_column = ? AND tile_row = ?";
+    rc = sqlite3_prepare_v3(database, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &select, 0L);
+    if (rc != SQLITE_OK)
     {
-        result = Status(Status::GeneralError, errorMessage);
+        Status status(Status::GeneralError, "Failed to prepare SQL: " + query + "; " + sqlite3_errmsg(database));
+        sqlite3_close_v2(database);
+        return status;
     }
 
-    return result;
+    return Reader{ database, select };
 }
 
-
-Status
-MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const IOOptions& io) const
+void
+MBTiles::Driver::releaseReader(Reader reader) const
 {
-    if (!key.valid() || !input)
-        return Status(Status::AssertionFailure);
+    std::scoped_lock lock(_readersMutex);
+    _readers.emplace_back(reader);
+}
 
-    if (!io.services.writeImageToStream)
-        return Status(Status::ServiceUnavailable);
+void
+MBTiles::Driver::closeReaders()
+{
+    std::scoped_lock lock(_readersMutex);
+    for (auto& reader : _readers)
+    {
+        sqlite3_finalize((sqlite3_stmt*)reader.selectTile);
+        sqlite3_close_v2((sqlite3*)reader.database);
+    }
+    _readers.clear();
+}
 
-    std::scoped_lock lock(_mutex);
 
+Result<std::string>
+MBTiles::Driver::encode(std::shared_ptr<Image> input, const IOOptions& io) const
+{
     // encode the data stream:
     std::stringstream buf;
 
@@ -408,7 +475,7 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
         );
     }
 
-    Status wr = io.services.writeImageToStream(image_to_write, buf, _options.format, io);
+    Status wr = io.services.writeImageToStream(image_to_write, buf, _tileFormat, io);
 
     if (wr.failed())
     {
@@ -430,6 +497,14 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
     }
 #endif // ROCKY_HAS_ZLIB
 
+    return value;
+}
+
+Status
+MBTiles::Driver::insert(const TileKey& key, const std::string& value) const
+{
+    // caller must hold _mutex
+
     int z = key.level;
     int x = key.x;
     int y = key.y;
@@ -440,16 +515,22 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
 
     sqlite3* database = (sqlite3*)_database;
 
-    // Prep the insert statement:
-    sqlite3_stmt* insert = NULL;
+    // Prep the insert statement once and reuse it for every tile:
     std::string query = "INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?, ?, ?, ?)";
-    int rc = sqlite3_prepare_v2(database, query.c_str(), -1, &insert, 0L);
-    if (rc != SQLITE_OK)
+    if (_insertTile == nullptr)
     {
-        return Status(Status::GeneralError, util::make_string()
-            << "Failed to prepare SQL: " << query << "; " << sqlite3_errmsg(database));
+        sqlite3_stmt* insert = nullptr;
+        int rc = sqlite3_prepare_v3(database, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &insert, 0L);
+        if (rc != SQLITE_OK)
+        {
+            return Status(Status::GeneralError, util::make_string()
+                << "Failed to prepare SQL: " << query << "; " << sqlite3_errmsg(database));
+        }
+        _insertTile = insert;
     }
 
+    sqlite3_stmt* insert = (sqlite3_stmt*)_insertTile;
+
     // bind parameters:
     sqlite3_bind_int(insert, 1, z);
     sqlite3_bind_int(insert, 2, x);
@@ -459,24 +540,20 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
     sqlite3_bind_blob(insert, 4, value.c_str(), (int)value.length(), SQLITE_STATIC);
 
     // run the sql.
-    bool ok = true;
+    int rc;
     int tries = 0;
     do {
         rc = sqlite3_step(insert);
     } while (++tries < 100 && (rc == SQLITE_BUSY || rc == SQLITE_LOCKED));
 
+    sqlite3_reset(insert);
+    sqlite3_clear_bindings(insert);
+
     if (SQLITE_OK != rc && SQLITE_DONE != rc)
     {
-#if SQLITE_VERSION_NUMBER >= 3007015
         return Status(Status::GeneralError, util::make_string() << "Failed query: " << query << "(" << rc << ")" << sqlite3_errstr(rc) << "; " << sqlite3_errmsg(database));
-#else
-        return Status(Status::GeneralError, make_string() << "Failed query: " << query << "(" << rc << ")" << rc << "; " << sqlite3_errmsg(database));
-#endif
-        ok = false;
     }
 
-    sqlite3_finalize(insert);
-
     // adjust the max level if necessary
     if (key.level > _maxLevel)
     {
@@ -490,6 +567,165 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
     return StatusOK;
 }
 
+Status
+MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const IOOptions& io) const
+{
+    if (!key.valid() || !input)
+        return Status(Status::AssertionFailure);
+
+    if (!io.services.writeImageToStream)
+        return Status(Status::ServiceUnavailable);
+
+    // encode outside the lock so concurrent writers only serialize on the insert
+    auto value = encode(input, io);
+    if (value.status.failed())
+        return value.status;
+
+    std::scoped_lock lock(_mutex);
+    return insert(key, value.value);
+}
+
+Status
+MBTiles::Driver::write(const std::vector<Tile>& tiles, const IOOptions& io)
+{
+    if (!io.services.writeImageToStream)
+        return Status(Status::ServiceUnavailable);
+
+    for (auto& tile : tiles)
+    {
+        if (!tile.key.valid() || !tile.image)
+            return Status(Status::AssertionFailure);
+    }
+
+    // start encoding every tile in the background:
+    // (equally important jobs, so skip the priority queue)
+    auto pool = jobs::get_pool("rocky.mbtiles", std::max(2u, std::thread::hardware_concurrency()));
+    pool->set_scheduling(jobs::scheduling::stealing);
+
+    std::vector<jobs::future<Result<std::string>>> encoded;
+    encoded.reserve(tiles.size());
+
+    for (auto& tile : tiles)
+    {
+        auto image = tile.image;
+        auto job = [this, image, &io](jobs::cancelable&)
+            {
+                return encode(image, io);
+            };
+
+        encoded.emplace_back(jobs::dispatch(job, jobs::context{ "mbtiles encode", pool }));
+    }
+
+    // ...and insert them in order as they finish.
+    std::scoped_lock lock(_mutex);
+
+    bool ownTransaction = !_inTransaction;
+    if (ownTransaction)
+    {
+        auto status = exec("BEGIN TRANSACTION");
+        if (status.failed())
+        {
+            for (auto& e : encoded)
+                e.join(); // jobs reference "io"
+            return status;
+        }
+    }
+
+    Status status;
+    for (unsigned i = 0; i < tiles.size(); ++i)
+    {
+        auto& value = encoded[i].join();
+
+        if (status.ok())
+        {
+            status = value.status.ok() ? insert(tiles[i].key, value.value) : value.status;
+        }
+    }
+
+    if (ownTransaction)
+    {
+        auto end = exec(status.ok() ? "COMMIT TRANSACTION" : "ROLLBACK TRANSACTION");
+        if (status.ok())
+            status = end;
+    }
+
+    return status;
+}
+
+bool
+MBTiles::Driver::contains(const TileKey& key) const
+{
+    std::scoped_lock lock(_mutex);
+
+    // flip Y axis
+    auto [numCols, numRows] = key.profile.numTiles(key.level);
+    int y = numRows - key.y - 1;
+
+    sqlite3* database = (sqlite3*)_database;
+
+    // Prep the query once and reuse it for every key:
+    if (_containsTile == nullptr)
+    {
+        sqlite3_stmt* select = nullptr;
+        std::string query = "SELECT 1 FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ? LIMIT 1";
+        if (sqlite3_prepare_v3(database, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &select, 0L) != SQLITE_OK)
+        {
+            Log()->warn(LC "Failed to prepare SQL: " + query + "; " + sqlite3_errmsg(database));
+            return false;
+        }
+        _containsTile = select;
+    }
+
+    sqlite3_stmt* select = (sqlite3_stmt*)_containsTile;
+
+    sqlite3_bind_int(select, 1, key.level);
+    sqlite3_bind_int(select, 2, key.x);
+    sqlite3_bind_int(select, 3, y);
+
+    bool found = (sqlite3_step(select) == SQLITE_ROW);
+
+    sqlite3_reset(select);
+    sqlite3_clear_bindings(select);
+    return found;
+}
+
+Status
+MBTiles::Driver::beginTransaction()
+{
+    std::scoped_lock lock(_mutex);
+    auto status = exec("BEGIN TRANSACTION");
+    _inTransaction = status.ok();
+    return status;
+}
+
+Status
+MBTiles::Driver::commitTransaction()
+{
+    std::scoped_lock lock(_mutex);
+    auto status = exec("COMMIT TRANSACTION");
+
+    // a failed commit leaves the transaction open; discard it so the
+    // driver never believes it's outside a transaction while inside one
+    if (status.failed())
+        exec("ROLLBACK TRANSACTION");
+
+    _inTransaction = sqlite3_get_autocommit((sqlite3*)_database) == 0;
+    return status;
+}
+
+Status
+MBTiles::Driver::exec(const std::string& sql)
+{
+    char* errorMsg = nullptr;
+    if (SQLITE_OK != sqlite3_exec((sqlite3*)_database, sql.c_str(), 0L, 0L, &errorMsg))
+    {
+        Status status(Status::GeneralError, sql + ": " + (errorMsg ? errorMsg : "unknown error"));
+        sqlite3_free(errorMsg);
+        return status;
+    }
+    return StatusOK;
+}
+
 bool
 MBTiles::Driver::getMetaData(const std::string& key, std::string& value)
 {
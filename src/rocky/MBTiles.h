@@ -10,6 +10,9 @@
 #include <rocky/Status.h>
 #include <rocky/URI.h>
 #include <rocky/TileKey.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace ROCKY_NAMESPACE
 {
@@ -30,6 +33,18 @@ namespace ROCKY_NAMESPACE
 
             //! Whether to use compression on individual tile data
             option<bool> compress = false;
+
+            //! Whether to use SQLite's write-ahead log when writing. Bulk writes
+            //! are much faster and readers are not blocked by the writer, but
+            //! two extra files sit next to the database while it is open.
+            option<bool> writeAheadLog = false;
+        };
+
+        //! One tile to write with Driver::write(tiles, io)
+        struct Tile
+        {
+            TileKey key;
+            std::shared_ptr<Image> image;
         };
 
         /**
@@ -60,14 +75,33 @@ namespace ROCKY_NAMESPACE
                 std::shared_ptr<Image> image,
                 const IOOptions& io) const;
 
+            //! Writes a batch of tiles. The tiles are encoded and compressed in
+            //! parallel and inserted in order as each one is ready, so encoding
+            //! overlaps the inserts. The batch is committed as one transaction
+            //! unless the caller already opened one with beginTransaction().
+            Status write(
+                const std::vector<Tile>& tiles,
+                const IOOptions& io);
+
+            //! Whether the database holds a tile for the key (without decoding it)
+            bool contains(const TileKey& key) const;
+
+            //! Group subsequent writes into one transaction, which is much
+            //! faster than committing each tile on its own.
+            Status beginTransaction();
+
+            //! Commit the writes made since beginTransaction(). If the commit
+            //! fails, the writes are rolled back and the error returned.
+            Status commitTransaction();
+
             void setDataExtents(const DataExtentList&);
             bool getMetaData(const std::string& name, std::string& value);
             bool putMetaData(const std::string& name, const std::string& value);
 
         private:
             void* _database;
-            mutable unsigned _minLevel;
-            mutable unsigned _maxLevel;
+            mutable std::atomic_uint _minLevel;
+            mutable std::atomic_uint _maxLevel;
             std::shared_ptr<Image> _emptyImage;
             Options _options;
             std::string _tileFormat;
@@ -75,10 +109,33 @@ namespace ROCKY_NAMESPACE
             std::string _name;
 
             // because no one knows if/when sqlite3 is threadsafe.
+            // guards the main (read-write) connection.
             mutable std::mutex _mutex;
+            mutable void* _insertTile = nullptr;
+            mutable void* _containsTile = nullptr;
+            bool _inTransaction = false;
+
+            // Read-only connections, each with its own prepared query, so
+            // that reads can run in parallel. A thread borrows one for the
+            // duration of the query only.
+            struct Reader
+            {
+                void* database = nullptr;
+                void* selectTile = nullptr;
+            };
+            mutable std::mutex _readersMutex;
+            mutable std::vector<Reader> _readers;
+            std::string _filename;
+
+            Result<Reader> acquireReader() const;
+            void releaseReader(Reader) const;
+            void closeReaders();
 
             bool createTables();
             void computeLevels();
+            Status exec(const std::string& sql);
+            Result<std::string> encode(std::shared_ptr<Image> image, const IOOptions& io) const;
+            Status insert(const TileKey& key, const std::string& data) const;
             Result<int> readMaxLevel();
         };
     }
@@ -7,6 +7,8 @@
 #include "TileKey.h"
 #include "Math.h"
 #include "json.h"
+#include <mutex>
+#include <unordered_map>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::util;
@@ -20,6 +22,18 @@ const double MERC_MINY = -20037508.34278925;
 const double MERC_MAXX = 20037508.34278925;
 const double MERC_MAXY = 20037508.34278925;
 
+namespace
+{
+    // assigns each distinct profile definition a small number, starting at 1
+    unsigned intern_profile(const std::string& definition)
+    {
+        static std::mutex mutex;
+        static std::unordered_map<std::string, unsigned> indices;
+        std::scoped_lock lock(mutex);
+        return indices.emplace(definition, (unsigned)indices.size() + 1).first->second;
+    }
+}
+
 void
 Profile::setup(
     const SRS& srs,
@@ -79,6 +93,7 @@ Profile::setup(
         std::string temp = to_json();
         _shared->_fullSignature = util::make_string() << std::hex << util::hashString(temp);
         _shared->_hash = std::hash<std::string>()(temp);
+        _shared->_index = intern_profile(temp);
     }
 }
 
@@ -148,6 +148,11 @@ namespace ROCKY_NAMESPACE
         //! Get the hash code for this profile
         inline std::size_t hash() const;
 
+        //! Small number identifying this profile's definition within the
+        //! process; profiles with the same definition share it. Zero for an
+        //! invalid profile. Used to pack a TileKey into its id().
+        inline unsigned index() const;
+
         //! Given an input extent, translate it into one or more
         //! GeoExtents in this profile.
         bool transformAndExtractContiguousExtents(
@@ -187,6 +192,7 @@ namespace ROCKY_NAMESPACE
             std::string _fullSignature;
             std::string _horizSignature;
             std::size_t _hash;
+            unsigned _index = 0;
         };
         std::shared_ptr<Data> _shared;
     };
@@ -196,6 +202,7 @@ namespace ROCKY_NAMESPACE
     const std::string& Profile::getFullSignature() const { return _shared->_fullSignature; }
     const std::string& Profile::getHorizSignature() const { return _shared->_horizSignature; }
     std::size_t Profile::hash() const { return _shared->_hash; }
+    unsigned Profile::index() const { return _shared->_index; }
 }
 
 namespace std {
@@ -597,7 +597,7 @@ ROCKY_NAMESPACE::TMS::readTileMap(const URI& location, const IOOptions& io)
     if (r.status.failed())
         return r.status;
 
-    auto tilemap = parseTileMapFromXML(r->data);
+    auto tilemap = parseTileMapFromXML(r->data.str());
 
     if (tilemap.status.ok())
     {
@@ -715,7 +715,7 @@ TMS::Driver::read(const TileKey& key, bool invertY, bool isMapboxRGB, const URIC
             return fetch.status;
         }
 
-        std::istringstream buf(fetch->data);
+        BufferStream buf(fetch->data);
         auto image_rr = io.services.readImageFromStream(buf, fetch->contentType, io);
 
         if (image_rr.status.failed())
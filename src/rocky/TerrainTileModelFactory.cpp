@@ -7,6 +7,8 @@
 #include "Map.h"
 #include "ElevationLayer.h"
 #include "ImageLayer.h"
+#include "BlockCompressor.h"
+#include "Trace.h"
 
 #define LC "[TerrainTileModelFactory] "
 
@@ -14,20 +16,26 @@ using namespace ROCKY_NAMESPACE;
 
 namespace
 {
+    // The layer shares its heightfields with other callers and its own cache,
+    // so rewrite the NO_DATA values in a copy and leave the original alone.
     void replace_nodata_values(GeoHeightfield& geohf)
     {
         auto grid = geohf.heightfield();
         if (grid)
         {
-            for (unsigned col = 0; col < grid->height(); ++col)
+            bool hasNoData = false;
+            std::as_const(*grid).forEachHeight([&](float h) {
+                hasNoData = hasNoData || h == NO_DATA_VALUE; });
+
+            if (hasNoData)
             {
-                for (unsigned row = 0; row < grid->width(); ++row)
-                {
-                    if (grid->heightAt(col, row) == NO_DATA_VALUE)
-                    {
-                        grid->heightAt(col, row) = 0.0f;
-                    }
-                }
+                auto image = grid->clone();
+                auto copy = Heightfield::create(image.get());
+                copy->forEachHeight([](float& h) {
+                    if (h == NO_DATA_VALUE)
+                        h = 0.0f; });
+
+                geohf = GeoHeightfield(copy, geohf.extent());
             }
         }
     }
@@ -142,6 +150,8 @@ TerrainTileModelFactory::createTileModel(
     const CreateTileManifest& manifest,
     const IOOptions& io) const
 {
+    ROCKY_TRACE_SCOPE_KEY("createTileModel", key);
+
     // Make a new model:
     TerrainTileModel model;
     model.key = key;
@@ -150,6 +160,53 @@ TerrainTileModelFactory::createTileModel(
     // assemble all the components:
     addColorLayers(model, map, key, manifest, io, false);
 
+    // mipmap on this (loading) thread so the whole chain uploads with the tile.
+    // The images may be shared with a cache, so we replace them rather than
+    // modify them.
+    if (mipmapColorLayers)
+    {
+        for (auto& layer : model.colorLayers)
+        {
+            if (layer.image.valid() && layer.image.image()->mipLevels() == 1)
+            {
+                auto mipmapped = layer.image.image()->generateMipmaps();
+                if (mipmapped)
+                    layer.image = GeoImage(mipmapped, layer.image.extent());
+            }
+        }
+    }
+
+    // block-compress the layers that ask for it, mipmaps and all, so the
+    // upload path hands the blocks straight to the GPU (if it can sample them).
+    for (auto& layer : model.colorLayers)
+    {
+        auto* imageLayer = dynamic_cast<const ImageLayer*>(layer.layer.get());
+        if (blockCompressionSupported && imageLayer && imageLayer->textureCompression.has_value() && layer.image.valid() &&
+            !layer.image.image()->isCompressed())
+        {
+            auto& codec = imageLayer->textureCompression.value();
+
+            util::BlockCompressor compressor;
+            compressor.preset = imageLayer->textureCompressionPreset.value() == "quality" ?
+                util::BlockCompressor::Preset::QUALITY :
+                util::BlockCompressor::Preset::FAST;
+
+            compressor.format =
+                codec == "bc1" ? Image::BC1_RGB_UNORM :
+                codec == "bc3" ? Image::BC3_UNORM :
+                codec == "bc7" ? Image::BC7_UNORM :
+                codec == "auto" ? util::BlockCompressor::chooseFormat(*layer.image.image()) :
+                Image::UNDEFINED;
+
+            if (compressor.format != Image::UNDEFINED)
+            {
+                auto compressed = compressor.compress(*layer.image.image());
+                if (compressed)
+                    layer.image = GeoImage(compressed, layer.image.extent());
+            }
+        }
+    }
+
     unsigned border = 0u;
     addElevation(model, map, key, manifest, border, io);
 
@@ -295,6 +352,7 @@ TerrainTileModelFactory::addColorLayers(
                 image.composite(sources, opacities);
 
                 TerrainTileModel::ColorLayer layer;
+                layer.layer = model.colorLayers.front().layer; // composite takes the base layer's settings
                 layer.key = key;
                 layer.revision = tile.revision;
                 layer.matrix = tile.matrix;
@@ -25,6 +25,13 @@ namespace ROCKY_NAMESPACE
         //! Whether to composite all color layers into one
         bool compositeColorLayers = true;
 
+        //! Whether to generate mipmaps for the color layer images
+        bool mipmapColorLayers = false;
+
+        //! Whether the GPU can sample block-compressed textures. Color layers
+        //! with ImageLayer::textureCompression set are compressed only if so.
+        bool blockCompressionSupported = false;
+
     public:
         TerrainTileModelFactory();
 
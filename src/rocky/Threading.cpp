@@ -4,6 +4,7 @@
  * MIT License
  */
 #include "Threading.h"
+#include "Trace.h"
 #include <cstdlib>
 #include <cstring>
 
@@ -17,6 +18,10 @@
 void
 rocky::util::setThreadName(const std::string& name)
 {
+#ifdef ROCKY_HAS_TRACING
+    Trace::setThreadName(name);
+#endif
+
 #if (defined _WIN32 && defined _WIN32_WINNT_WIN10 && defined _WIN32_WINNT && _WIN32_WINNT >= _WIN32_WINNT_WIN10) || (defined __CYGWIN__)
     size_t bufsize = 0;
     wchar_t buf[256];
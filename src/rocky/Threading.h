@@ -8,6 +8,10 @@
 #include <rocky/weejobs.h>
 #include <vector>
 #include <list>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <unordered_map>
 
 namespace ROCKY_NAMESPACE
 {
@@ -127,6 +131,129 @@ namespace ROCKY_NAMESPACE
             Gate<T>* _gate = nullptr;
             T _key;
         };
+
+        /**
+        * Coalesces concurrent requests for the same key into one operation.
+        *
+        * The first caller for a key (the "leader") runs the operation; callers
+        * that arrive while it is in flight wait on a shared future and receive
+        * the same result. Keys are hashed into independently locked shards so
+        * unrelated keys never contend, and finding or retiring a flight is O(1).
+        *
+        * The operation returns an std::optional. An empty result (e.g., because
+        * the leader was canceled) is not shared; each waiter instead retries
+        * the operation itself. A waiter that is canceled itself stops waiting
+        * and returns empty without affecting the flight.
+        */
+        template<typename K, typename V, typename HASH = std::hash<K>>
+        class SingleFlight
+        {
+        public:
+            SingleFlight(unsigned numShards = 16) :
+                _shards(std::max(1u, numShards)) { }
+
+            //! Run "func" for "key", or join the flight already running for it.
+            //! @param key Key identifying the operation
+            //! @param func Callable returning std::optional<V>
+            //! @return Result of the operation, or empty if this caller's
+            //!   own run of "func" returned empty.
+            template<typename FUNC>
+            std::optional<V> run(const K& key, FUNC&& func)
+            {
+                return run(key, std::forward<FUNC>(func), []() { return false; });
+            }
+
+            //! Run "func" for "key", or join the flight already running for it,
+            //! giving up on the wait as soon as "canceled" returns true.
+            //! @param key Key identifying the operation
+            //! @param func Callable returning std::optional<V>
+            //! @param canceled Callable returning true once the caller no longer
+            //!   needs the result; polled while waiting on another caller's flight
+            //! @return Result of the operation, or empty if this caller's
+            //!   own run of "func" returned empty or the caller was canceled.
+            template<typename FUNC, typename CANCELED>
+            std::optional<V> run(const K& key, FUNC&& func, CANCELED&& canceled)
+            {
+                auto& shard = _shards[HASH()(key) % _shards.size()];
+
+                for (;;)
+                {
+                    std::promise<std::optional<V>> promise;
+                    std::shared_future<std::optional<V>> flight;
+                    {
+                        std::unique_lock lock(shard.mutex);
+                        auto i = shard.flights.find(key);
+                        if (i != shard.flights.end())
+                        {
+                            flight = i->second;
+                        }
+                        else
+                        {
+                            shard.flights.emplace(key, promise.get_future().share());
+                        }
+                    }
+
+                    // join an existing flight:
+                    if (flight.valid())
+                    {
+                        while (flight.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready)
+                        {
+                            if (canceled())
+                                return std::nullopt;
+                        }
+
+                        auto& result = flight.get();
+                        if (result.has_value())
+                            return result;
+                        else
+                            continue; // leader gave up; try again
+                    }
+
+                    // lead a new flight:
+                    std::optional<V> result;
+                    try
+                    {
+                        result = func();
+                    }
+                    catch (...)
+                    {
+                        retire(shard, key);
+                        promise.set_value(std::nullopt);
+                        throw;
+                    }
+
+                    retire(shard, key);
+                    promise.set_value(result);
+                    return result;
+                }
+            }
+
+            //! Number of flights currently in progress
+            std::size_t size() const
+            {
+                std::size_t count = 0;
+                for (auto& shard : _shards)
+                {
+                    std::unique_lock lock(shard.mutex);
+                    count += shard.flights.size();
+                }
+                return count;
+            }
+
+        private:
+            struct Shard
+            {
+                mutable std::mutex mutex;
+                std::unordered_map<K, std::shared_future<std::optional<V>>, HASH> flights;
+            };
+            std::vector<Shard> _shards;
+
+            inline void retire(Shard& shard, const K& key)
+            {
+                std::unique_lock lock(shard.mutex);
+                shard.flights.erase(key);
+            }
+        };
     }
 
 } // namepsace rocky::util
@@ -87,6 +87,19 @@ namespace ROCKY_NAMESPACE
             return profile.valid();
         }
 
+        //! Compact identifier for hashing and comparing keys: the profile
+        //! index (6 bits), level (6 bits), x (26 bits) and y (26 bits) packed
+        //! into 64 bits. Keys with equivalent profiles, from up to 63 distinct
+        //! profile definitions, have equal IDs exactly when they are equal, as
+        //! long as x and y fit (e.g. through level 25 in global-geodetic).
+        inline std::uint64_t id() const {
+            return
+                ((std::uint64_t)(profile.index() & 0x3f) << 58) |
+                ((std::uint64_t)(level & 0x3f) << 52) |
+                ((std::uint64_t)(x & 0x3ffffff) << 26) |
+                (std::uint64_t)(y & 0x3ffffff);
+        }
+
         //! Get the quadrant relative to this key's parent.
         unsigned getQuadrant() const;
 
@@ -170,3 +183,15 @@ namespace ROCKY_NAMESPACE
         //}
     };
 }
+
+namespace std {
+    // std::hash specialization for TileKey.
+    // Ignores the profile, consistent with operator==, since keys in a
+    // single container almost always share one.
+    template<> struct hash<rocky::TileKey> {
+        inline size_t operator()(const rocky::TileKey& value) const {
+            std::uint64_t h = ((std::uint64_t)value.level << 56) ^ ((std::uint64_t)value.x << 28) ^ (std::uint64_t)value.y;
+            return (size_t)(h * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+}
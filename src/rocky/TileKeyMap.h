@@ -0,0 +1,190 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/TileKey.h>
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    namespace util
+    {
+        /**
+        * Hash table keyed by TileKey, using open addressing (linear probing)
+        * on the key's packed id(). Lookups hash and compare 64-bit integers,
+        * and compare the full key only when the ids match, since keys beyond
+        * the id's range (very deep levels, too many profiles) can share an id.
+        *
+        * Inserting may rehash, and erasing shifts later entries back, so any
+        * pointer or reference into the table is invalidated by operator[] and
+        * erase. Not thread-safe.
+        */
+        template<class T>
+        class TileKeyMap
+        {
+        public:
+            struct Entry
+            {
+                TileKey key;
+                T value;
+            };
+
+            //! Pointer to the value for a key, or nullptr if absent
+            T* find(const TileKey& key)
+            {
+                auto i = slotOf(key);
+                return i != npos ? &_slots[i]->value : nullptr;
+            }
+
+            //! Pointer to the value for a key, or nullptr if absent
+            const T* find(const TileKey& key) const
+            {
+                auto i = slotOf(key);
+                return i != npos ? &_slots[i]->value : nullptr;
+            }
+
+            //! Value for a key, inserting a default one if absent
+            T& operator[](const TileKey& key)
+            {
+                auto id = key.id();
+                auto i = slotOf(key);
+                if (i != npos)
+                    return _slots[i]->value;
+
+                if ((_size + 1) * 2 > _slots.size())
+                    rehash(std::max(std::size_t(16), _slots.size() * 2));
+
+                for (i = home(id); _slots[i].has_value(); i = (i + 1) & _mask);
+                _slots[i].emplace(Entry{ key, T() });
+                _ids[i] = id;
+                ++_size;
+                return _slots[i]->value;
+            }
+
+            //! Remove a key
+            //! @return true if it was present
+            bool erase(const TileKey& key)
+            {
+                auto i = slotOf(key);
+                if (i == npos)
+                    return false;
+
+                _slots[i].reset();
+                --_size;
+
+                // shift back any entries that probed past the hole, so lookups
+                // never need tombstones
+                for (auto j = (i + 1) & _mask; _slots[j].has_value(); j = (j + 1) & _mask)
+                {
+                    auto k = home(_ids[j]);
+                    bool inPlace = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+                    if (!inPlace)
+                    {
+                        _slots[i] = std::move(_slots[j]);
+                        _ids[i] = _ids[j];
+                        _slots[j].reset();
+                        i = j;
+                    }
+                }
+                return true;
+            }
+
+            //! Remove every entry for which pred(key, value) returns true
+            //! @return number of entries removed
+            template<class PRED>
+            std::size_t erase_if(PRED&& pred)
+            {
+                std::vector<TileKey> doomed;
+                for (auto& slot : _slots)
+                    if (slot.has_value() && pred(slot->key, slot->value))
+                        doomed.emplace_back(slot->key);
+
+                for (auto& key : doomed)
+                    erase(key);
+
+                return doomed.size();
+            }
+
+            //! Call func(key, value) for every entry. Don't insert or erase
+            //! from inside func.
+            template<class FUNC>
+            void for_each(FUNC&& func)
+            {
+                for (auto& slot : _slots)
+                    if (slot.has_value())
+                        func(slot->key, slot->value);
+            }
+
+            //! Number of entries
+            std::size_t size() const { return _size; }
+
+            //! Whether the table is empty
+            bool empty() const { return _size == 0; }
+
+            //! Remove all entries and release the storage
+            void clear()
+            {
+                _slots.clear();
+                _ids.clear();
+                _mask = 0;
+                _size = 0;
+            }
+
+        private:
+            static constexpr std::size_t npos = ~std::size_t(0);
+
+            std::vector<std::optional<Entry>> _slots;
+            std::vector<std::uint64_t> _ids;
+            std::size_t _mask = 0;
+            std::size_t _size = 0;
+
+            // first slot to probe for an id (splitmix64 finalizer)
+            inline std::size_t home(std::uint64_t id) const
+            {
+                id ^= id >> 30; id *= 0xbf58476d1ce4e5b9ULL;
+                id ^= id >> 27; id *= 0x94d049bb133111ebULL;
+                id ^= id >> 31;
+                return (std::size_t)id & _mask;
+            }
+
+            inline std::size_t slotOf(const TileKey& key) const
+            {
+                if (_size == 0)
+                    return npos;
+
+                auto id = key.id();
+                for (auto i = home(id); _slots[i].has_value(); i = (i + 1) & _mask)
+                    if (_ids[i] == id && _slots[i]->key == key)
+                        return i;
+
+                return npos;
+            }
+
+            void rehash(std::size_t capacity)
+            {
+                std::vector<std::optional<Entry>> slots(capacity);
+                std::vector<std::uint64_t> ids(capacity);
+                _mask = capacity - 1;
+
+                for (std::size_t s = 0; s < _slots.size(); ++s)
+                {
+                    if (_slots[s].has_value())
+                    {
+                        auto i = home(_ids[s]);
+                        while (slots[i].has_value())
+                            i = (i + 1) & _mask;
+                        slots[i] = std::move(_slots[s]);
+                        ids[i] = _ids[s];
+                    }
+                }
+
+                _slots.swap(slots);
+                _ids.swap(ids);
+            }
+        };
+    }
+}
@@ -10,6 +10,7 @@
 #include <rocky/VisibleLayer.h>
 #include <rocky/Profile.h>
 #include <rocky/TileKey.h>
+#include <rocky/TileKeyMap.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -152,29 +153,24 @@ namespace ROCKY_NAMESPACE
         {
             const std::lock_guard lock{ _mutex };
             ++_gets;
-            auto iter = _map.find(key);
-            if (iter != _map.end())
+            auto entry = _map.find(key);
+            if (entry)
             {
-                auto result = iter->second.value.lock();
+                auto result = entry->value.lock();
                 if (result) ++_hits;
-                return iter->second;
+                return *entry;
             }
             return {};
         }
 
         //! Add a value to the cache, or return the existing value if
         //! it's already there.
-        const Entry& put(const TileKey& key, const TileKey& valueKey, const std::shared_ptr<Value>& value)
+        Entry put(const TileKey& key, const TileKey& valueKey, const std::shared_ptr<Value>& value)
         {
             const std::lock_guard lock{ _mutex };
-            auto iter = _map.find(key);
-            if (iter != _map.end())
-            {
-                if (iter->second.value.lock())
-                    return iter->second;
-            }
             auto& e = _map[key];
-            e = { valueKey, value };
+            if (!e.value.lock())
+                e = { valueKey, value };
             return e;
         }
 
@@ -182,13 +178,7 @@ namespace ROCKY_NAMESPACE
         void clean()
         {
             const std::lock_guard lock{ _mutex };
-            for (auto itr = _map.begin(), end = _map.end(); itr != end;)
-            {
-                if (!itr->second.value.lock())
-                    itr = _map.erase(itr);
-                else
-                    ++itr;
-            }
+            _map.erase_if([](const TileKey&, const Entry& e) { return e.value.expired(); });
         }
 
         float hitRatio() const
@@ -197,7 +187,7 @@ namespace ROCKY_NAMESPACE
         }
 
     private:
-        mutable std::map<TileKey, Entry> _map;
+        mutable util::TileKeyMap<Entry> _map;
         mutable float _gets = 0.0f;
         mutable float _hits = 0.0f;
         mutable std::mutex _mutex;
@@ -0,0 +1,200 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        const char* name;
+        std::int64_t start; // ns since the trace began
+        std::int64_t duration; // ns
+        std::uint64_t flow;
+        std::string arg;
+    };
+
+    // Each thread appends to its own buffer; the mutex is only contended
+    // while stop() collects the events.
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        unsigned tid = 0u;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    struct Recorder
+    {
+        std::atomic_bool active = { false };
+        std::mutex mutex;
+        std::string filename;
+        Clock::time_point epoch = Clock::now();
+        std::vector<std::shared_ptr<ThreadBuffer>> threads; // outlive their threads
+        unsigned nextTid = 1u;
+    };
+
+    Recorder& recorder()
+    {
+        static Recorder instance;
+        return instance;
+    }
+
+    ThreadBuffer& threadBuffer()
+    {
+        static thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer)
+        {
+            buffer = std::make_shared<ThreadBuffer>();
+            auto& r = recorder();
+            std::scoped_lock lock(r.mutex);
+            buffer->tid = r.nextTid++;
+            r.threads.emplace_back(buffer);
+        }
+        return *buffer;
+    }
+
+    std::int64_t now(const Recorder& r)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - r.epoch).count();
+    }
+
+    std::string escape(const std::string& in)
+    {
+        std::string out;
+        out.reserve(in.size());
+        for (char c : in)
+        {
+            if (c == '"' || c == '\\')
+                out.push_back('\\');
+            if ((unsigned char)c >= 0x20)
+                out.push_back(c);
+        }
+        return out;
+    }
+}
+
+void
+Trace::start(const std::string& filename)
+{
+    auto& r = recorder();
+    std::scoped_lock lock(r.mutex);
+
+    for (auto& thread : r.threads)
+    {
+        std::scoped_lock thread_lock(thread->mutex);
+        thread->events.clear();
+    }
+
+    r.filename = filename;
+    r.epoch = Clock::now();
+    r.active = true;
+}
+
+Status
+Trace::stop()
+{
+    auto& r = recorder();
+    if (!r.active.exchange(false))
+        return StatusOK;
+
+    std::scoped_lock lock(r.mutex);
+
+    FILE* out = std::fopen(r.filename.c_str(), "w");
+    if (!out)
+        return Status(Status::ResourceUnavailable, "Cannot write trace file " + r.filename);
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(out, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"rocky\"}}");
+
+    for (auto& thread : r.threads)
+    {
+        std::vector<Event> events;
+        std::string name;
+        {
+            std::scoped_lock thread_lock(thread->mutex);
+            events.swap(thread->events);
+            name = thread->name;
+        }
+
+        if (!name.empty())
+        {
+            std::fprintf(out, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                thread->tid, escape(name).c_str());
+        }
+
+        for (auto& e : events)
+        {
+            std::fprintf(out, ",\n{\"ph\":\"X\",\"cat\":\"rocky\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                e.name, thread->tid, 1e-3 * (double)e.start, 1e-3 * (double)e.duration);
+
+            if (e.flow != 0u)
+            {
+                std::fprintf(out, ",\"bind_id\":\"0x%llx\",\"flow_in\":true,\"flow_out\":true",
+                    (unsigned long long)e.flow);
+            }
+
+            if (!e.arg.empty())
+            {
+                std::fprintf(out, ",\"args\":{\"key\":\"%s\"}", escape(e.arg).c_str());
+            }
+
+            std::fprintf(out, "}");
+        }
+    }
+
+    std::fprintf(out, "\n]}\n");
+    bool ok = std::ferror(out) == 0;
+    std::fclose(out);
+
+    return ok ? StatusOK : Status(Status::GeneralError, "Failed writing trace file " + r.filename);
+}
+
+bool
+Trace::active()
+{
+    return recorder().active.load(std::memory_order_acquire);
+}
+
+void
+Trace::setThreadName(const std::string& name)
+{
+    auto& buffer = threadBuffer();
+    std::scoped_lock lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void
+Trace::Scope::begin(const char* name, std::uint64_t flow, std::string&& arg)
+{
+    _name = name;
+    _flow = flow;
+    _arg = std::move(arg);
+    _start = now(recorder());
+}
+
+void
+Trace::Scope::end()
+{
+    auto& r = recorder();
+    auto end = now(r);
+
+    // a span that straddles start() or stop() is dropped
+    if (!r.active.load(std::memory_order_relaxed) || _start > end)
+        return;
+
+    auto& buffer = threadBuffer();
+    std::scoped_lock lock(buffer.mutex);
+    buffer.events.emplace_back(Event{ _name, _start, end - _start, _flow, std::move(_arg) });
+}
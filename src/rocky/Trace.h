@@ -0,0 +1,94 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#include <rocky/Status.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * Records timed spans to a Chrome trace event file that you can open
+    * in chrome://tracing or https://ui.perfetto.dev.
+    *
+    * The SDK's instrumentation (the ROCKY_TRACE_* macros) is only compiled
+    * in when you build with ROCKY_SUPPORTS_TRACING; otherwise the macros
+    * expand to nothing. To record, set the ROCKY_TRACE_FILE environment
+    * variable to an output filename, or call start() and stop().
+    */
+    class ROCKY_EXPORT Trace
+    {
+    public:
+        //! Start recording. Spans are held in memory until stop().
+        static void start(const std::string& filename);
+
+        //! Stop recording and write the trace file.
+        static Status stop();
+
+        //! Whether recording is in progress
+        static bool active();
+
+        //! Name the calling thread in the trace
+        static void setThreadName(const std::string& name);
+
+        /**
+        * Span covering the lifetime of this object. Spans created with a
+        * key (e.g. a TileKey) are joined by flow arrows, so you can follow
+        * one tile through each stage of loading.
+        */
+        class ROCKY_EXPORT Scope
+        {
+        public:
+            Scope(const char* name)
+            {
+                if (active())
+                    begin(name, 0u, {});
+            }
+
+            template<class KEY>
+            Scope(const char* name, const KEY& key)
+            {
+                if (active())
+                    begin(name, (std::uint64_t)std::hash<KEY>()(key) | 1u, key.str());
+            }
+
+            ~Scope()
+            {
+                if (_name)
+                    end();
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            void begin(const char* name, std::uint64_t flow, std::string&& arg);
+            void end();
+
+            const char* _name = nullptr;
+            std::uint64_t _flow = 0u;
+            std::int64_t _start = 0;
+            std::string _arg;
+        };
+
+        // Not creatable.
+        Trace() = delete;
+    };
+}
+
+#ifdef ROCKY_HAS_TRACING
+#define ROCKY_TRACE_CONCAT_NX(a, b) a##b
+#define ROCKY_TRACE_CONCAT(a, b) ROCKY_TRACE_CONCAT_NX(a, b)
+//! Records a span for the rest of the enclosing scope.
+#define ROCKY_TRACE_SCOPE(NAME) ROCKY_NAMESPACE::Trace::Scope ROCKY_TRACE_CONCAT(_rocky_trace_, __LINE__)(NAME)
+//! Records a span for the rest of the enclosing scope, linked to other spans with the same key.
+#define ROCKY_TRACE_SCOPE_KEY(NAME, KEY) ROCKY_NAMESPACE::Trace::Scope ROCKY_TRACE_CONCAT(_rocky_trace_, __LINE__)(NAME, KEY)
+#else
+#define ROCKY_TRACE_SCOPE(NAME)
+#define ROCKY_TRACE_SCOPE_KEY(NAME, KEY)
+#endif
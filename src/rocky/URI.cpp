@@ -8,6 +8,7 @@
 #include "URI.h"
 #include "Utils.h"
 #include "Context.h"
+#include "Trace.h"
 #include "Version.h"
 #include "json.h"
 
@@ -17,6 +18,8 @@
 #include <cstdlib>
 #include <random>
 #include <algorithm>
+#include <iterator>
+#include <limits>
 
 #ifdef ROCKY_HAS_HTTPLIB
     #ifdef ROCKY_HAS_OPENSSL
@@ -50,15 +53,15 @@ bool URI::supportsHTTPS()
 }
 
 std::string
-URI::inferContentType(const std::string& buffer)
+URI::inferContentType(std::string_view buffer)
 {
     if (buffer.length() < 16)
         return {};
 
-    if (!strncmp(buffer.c_str(), "<?xml", 5))
+    if (!strncmp(buffer.data(), "<?xml", 5))
         return "text/xml";
 
-    if (!strncmp(buffer.c_str(), "<html", 5))
+    if (!strncmp(buffer.data(), "<html", 5))
         return "text/html";
 
     // .jpg:  FF D8 FF
@@ -71,7 +74,7 @@ URI::inferContentType(const std::string& buffer)
     // .webp: RIFF ???? WEBP
     // .ico   00 00 01 00
     //        00 00 02 00 ( cursor files )
-    const char* data = buffer.c_str();
+    const char* data = buffer.data();
     switch (buffer[0])
     {
     case '\xFF':
@@ -102,6 +105,47 @@ URI::inferContentType(const std::string& buffer)
     return { };
 }
 
+/**
+* A connection held by HTTPConnectionPool: a client object that keeps its
+* socket (or curl's connection cache) open between requests.
+*/
+struct HTTPConnectionPool::Connection
+{
+    Connection(const std::string& in_host, bool keepAlive) :
+        host(in_host)
+#ifdef ROCKY_HAS_HTTPLIB
+        , client(in_host)
+#endif
+    {
+#ifdef ROCKY_HAS_HTTPLIB
+        client.set_keep_alive(keepAlive);
+        client.set_follow_location(true);
+        client.enable_server_certificate_verification(false);
+#endif
+#ifdef ROCKY_HAS_CURL
+        // may be null if curl is out of resources; http_get_curl checks
+        handle = curl_easy_init();
+#endif
+    }
+
+#ifdef ROCKY_HAS_CURL
+    ~Connection()
+    {
+        if (handle)
+            curl_easy_cleanup(handle);
+    }
+
+    CURL* handle = nullptr;
+#endif
+
+    std::string host;
+    std::chrono::steady_clock::time_point lastUsed;
+
+#ifdef ROCKY_HAS_HTTPLIB
+    httplib::Client client;
+#endif
+};
+
 namespace
 {
     static bool httpDebug = !ROCKY_NAMESPACE::util::getEnvVar("HTTP_DEBUG").empty();
@@ -132,7 +176,7 @@ namespace
     struct HTTPResponse
     {
         int status;
-        std::string data;
+        Buffer data;
         std::vector<KeyValuePair> headers;
     };
 
@@ -146,6 +190,30 @@ namespace
         return {};
     }
 
+    // Scoped use of a connection: borrowed from the pool if there is one,
+    // otherwise a one-off connection that closes when the request is done.
+    struct Lease
+    {
+        Lease(std::shared_ptr<HTTPConnectionPool> in_pool, const std::string& host, const IOOptions& io) :
+            pool(in_pool)
+        {
+            if (pool)
+                connection = pool->acquire(host, &io);
+            else
+                connection = std::make_shared<HTTPConnectionPool::Connection>(host, false);
+        }
+
+        ~Lease()
+        {
+            if (pool && connection)
+                pool->release(connection, reusable);
+        }
+
+        std::shared_ptr<HTTPConnectionPool> pool;
+        std::shared_ptr<HTTPConnectionPool::Connection> connection;
+        bool reusable = false;
+    };
+
     bool split_url(
         const std::string& url,
         std::string& proto_host_port,
@@ -187,7 +255,7 @@ namespace
     {
         void write(const char* ptr, size_t realsize)
         {
-            stream.write(ptr, realsize);
+            body.append(ptr, realsize);
         }
 
         void writeHeader(const char* ptr, size_t realsize)
@@ -202,7 +270,7 @@ namespace
             }
         }
 
-        std::stringstream stream;
+        std::string body;
         std::vector<KeyValuePair> headers;
     };
 
@@ -227,7 +295,20 @@ namespace
     {
         HTTPResponse response;
 
-        auto handle = curl_easy_init();
+        std::string proto_host_port, path, query_text;
+        if (!split_url(request.url, proto_host_port, path, query_text))
+            return Status(Status::ConfigurationError);
+
+        // a pooled handle keeps its connections open for the next request
+        Lease lease(io.services.httpPool, proto_host_port, io);
+        if (!lease.connection)
+            return Status(Status::ResourceUnavailable, "Canceled");
+
+        auto handle = lease.connection->handle;
+        if (!handle)
+            return Status(Status::ResourceUnavailable, "Failed to create a CURL handle");
+
+        curl_easy_reset(handle);
 
         curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, stream_object_write_function);
         curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, stream_object_header_function);
@@ -301,11 +382,13 @@ namespace
             break;
         }
 
-        curl_easy_cleanup(handle);
+        curl_slist_free_all(headers);
 
         if (result == CURLE_OK)
         {
-            response.data = so.stream.str();
+            lease.reusable = true;
+
+            response.data = std::move(so.body);
             response.headers = so.headers;
 
             auto t1 = std::chrono::steady_clock::now();
@@ -368,13 +451,12 @@ namespace
 
         try
         {
-            httplib::Client client(proto_host_port);
-
-            // follow redirects
-            client.set_follow_location(true);
+            // borrow a kept-alive connection (follows redirects, no cert verification)
+            Lease lease(io.services.httpPool, proto_host_port, io);
+            if (!lease.connection)
+                return Status(Status::ResourceUnavailable, "Canceled");
 
-            // disable cert verification
-            client.enable_server_certificate_verification(false);
+            auto& client = lease.connection->client;
 
             unsigned max_attempts = std::max(1u, io.maxNetworkAttempts);
 
@@ -392,6 +474,9 @@ namespace
                 auto res = client.Get(path, params, headers);
                 auto t1 = std::chrono::steady_clock::now();
 
+                // a failed exchange may leave the socket in an unknown state
+                lease.reusable = (bool)res;
+
                 if (res)
                 {
                     if (httpDebug)
@@ -481,6 +566,159 @@ namespace
 
 //------------------------------------------------------------------------
 
+HTTPConnectionPool::HTTPConnectionPool(unsigned maxConnectionsPerHost) :
+    _maxPerHost(std::max(1u, maxConnectionsPerHost))
+{
+    //nop
+}
+
+std::shared_ptr<HTTPConnectionPool::Connection>
+HTTPConnectionPool::acquire(const std::string& hostname, const Cancelable* cancelable)
+{
+    std::unique_lock lock(_mutex);
+    auto& host = _hosts[hostname];
+    bool waited = false;
+
+    for (;;)
+    {
+        // most recently used first; it's the least likely to have been closed by the server
+        auto now = std::chrono::steady_clock::now();
+        while (!host.idle.empty())
+        {
+            auto connection = std::move(host.idle.back());
+            host.idle.pop_back();
+            --_stats.idle;
+
+            if (now - connection->lastUsed < idleTimeout)
+            {
+                ++host.active;
+                ++_stats.active;
+                ++_stats.reused;
+                return connection;
+            }
+
+            ++_stats.expired;
+        }
+
+        if (host.active < _maxPerHost)
+            break;
+
+        if (!waited)
+        {
+            ++_stats.waits;
+            waited = true;
+        }
+
+        if (cancelable && cancelable->canceled())
+            return nullptr;
+
+        _released.wait_for(lock, std::chrono::milliseconds(50));
+    }
+
+    ++host.active;
+    ++_stats.active;
+    ++_stats.created;
+    lock.unlock();
+
+    try
+    {
+        return std::make_shared<Connection>(hostname, true);
+    }
+    catch (...)
+    {
+        lock.lock();
+        --host.active;
+        --_stats.active;
+        lock.unlock();
+        _released.notify_all();
+        throw;
+    }
+}
+
+void
+HTTPConnectionPool::release(std::shared_ptr<Connection> connection, bool reusable)
+{
+    if (!connection)
+        return;
+
+    {
+        std::scoped_lock lock(_mutex);
+        auto& host = _hosts[connection->host];
+        --host.active;
+        --_stats.active;
+
+        if (reusable)
+        {
+            connection->lastUsed = std::chrono::steady_clock::now();
+            host.idle.emplace_back(std::move(connection));
+            ++_stats.idle;
+        }
+    }
+
+    // waiters may be waiting on different hosts, so wake them all
+    _released.notify_all();
+}
+
+std::size_t
+HTTPConnectionPool::chooseHost(const std::vector<std::string>& hosts) const
+{
+    if (hosts.size() < 2)
+        return 0;
+
+    // start at a rotating offset so ties spread across the hosts
+    std::size_t start = _next++;
+    std::size_t best = start % hosts.size();
+    long long bestScore = std::numeric_limits<long long>::lowest();
+
+    std::scoped_lock lock(_mutex);
+    for (std::size_t i = 0; i < hosts.size(); ++i)
+    {
+        auto index = (start + i) % hosts.size();
+        long long score = 0;
+
+        auto iter = _hosts.find(hosts[index]);
+        if (iter != _hosts.end())
+        {
+            auto& host = iter->second;
+            score = !host.idle.empty() ?
+                (long long)host.idle.size() :   // a warm connection is waiting
+                -(long long)host.active;         // otherwise, the least busy host
+        }
+
+        if (score > bestScore)
+        {
+            best = index;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+HTTPConnectionPool::Stats
+HTTPConnectionPool::stats() const
+{
+    std::scoped_lock lock(_mutex);
+    return _stats;
+}
+
+void
+HTTPConnectionPool::clear()
+{
+    std::vector<std::shared_ptr<Connection>> closing;
+    {
+        std::scoped_lock lock(_mutex);
+        for (auto& [name, host] : _hosts)
+        {
+            std::move(host.idle.begin(), host.idle.end(), std::back_inserter(closing));
+            host.idle.clear();
+        }
+        _stats.idle = 0;
+    }
+    // connections close here, outside the lock
+}
+
+//------------------------------------------------------------------------
+
 URI::Stream::Stream(std::shared_ptr<std::istream> s) :
     _in(s)
 {
@@ -597,9 +835,36 @@ URI::findRotation()
 IOResult<Content>
 URI::read(const IOOptions& io) const
 {
-    // protect against multiple threads trying to read the same URI at the same time
-    util::ScopedGate<std::string> gate(io.uriGate, full());
+    ROCKY_TRACE_SCOPE("URI::read");
 
+    if (!io.uriFlights)
+    {
+        return readImplementation(io);
+    }
+
+    // Coalesce concurrent requests for the same URI: the first caller does the
+    // actual read and the others share its result.
+    auto result = io.uriFlights->run(full(), [&]() -> std::optional<IOResult<Content>>
+        {
+            auto r = readImplementation(io);
+            if (io.canceled())
+                return std::nullopt; // don't hand a canceled result to the other waiters
+            return r;
+        });
+
+    if (result.has_value())
+    {
+        return result.value();
+    }
+
+    IOResult<Content> canceled(Status(Status::ResourceUnavailable, "Canceled"));
+    canceled.ioCode = IOResult<Content>::RESULT_CANCELED;
+    return canceled;
+}
+
+IOResult<Content>
+URI::readImplementation(const IOOptions& io) const
+{
     if (io.services.contentCache)
     {
         auto cached = io.services.contentCache->get(full());
@@ -608,7 +873,7 @@ URI::read(const IOOptions& io) const
             if (httpDebug)
             {
                 Log()->debug(LC "Cache hit, ratio = "
-                    + std::to_string(100.0f * (float)io.services.contentCache->hits / (float)io.services.contentCache->gets)
+                    + std::to_string(100.0f * io.services.contentCache->stats().hitRatio())
                     + "% (" + full() + ")");
             }
 
@@ -618,20 +883,36 @@ URI::read(const IOOptions& io) const
         }
     }
 
+    // check the persistent cache for remote content:
+    if (io.services.cache && isRemote())
+    {
+        auto cached = io.services.cache->read(full());
+        if (cached.status.ok())
+        {
+            if (io.services.contentCache)
+            {
+                io.services.contentCache->put(full(), cached);
+            }
+
+            IOResult<Content> result(cached.value);
+            result.fromCache = true;
+            return result;
+        }
+    }
+
     Content content;
 
     if (std::filesystem::exists(full()))
     {
-        auto contentType = inferContentTypeFromFileExtension(full());
-
-        ROCKY_TODO("worry about text or binary open mode?");
+        // large files are memory-mapped, so the bytes go straight to the decoder.
+        auto r = Buffer::readFile(full());
+        if (r.status.failed())
+        {
+            return r.status;
+        }
 
-        std::ifstream in(full().c_str(), std::ios_base::in);
-        std::stringstream buf;
-        buf << in.rdbuf() << std::flush;
-        content.data = buf.str();
-        content.contentType = contentType;
-        in.close();
+        content.data = std::move(r.value);
+        content.contentType = inferContentTypeFromFileExtension(full());
     }
 
     else if (isRemote())
@@ -644,13 +925,29 @@ URI::read(const IOOptions& io) const
         }
 
         // resolve a rotation:
-        static int rotator = 0;
-        if (_r0 != std::string::npos && _r1 != std::string::npos)
+        static std::atomic_uint rotator = { 0 };
+        if (_r0 != std::string::npos && _r1 != std::string::npos && _r1 > _r0 + 1)
         {
-            util::replace_in_place(
-                request.url,
-                request.url.substr(_r0, _r1 - _r0 + 1),
-                request.url.substr(_r0 + 1 + (rotator++ % (_r1 - _r0 - 1)), 1));
+            auto pattern = request.url.substr(_r0, _r1 - _r0 + 1);
+            auto choices = _r1 - _r0 - 1;
+            std::size_t pick = rotator++ % choices;
+
+            // with a connection pool, prefer the subdomain that already has a
+            // warm connection over opening a new one to the next in line.
+            if (io.services.httpPool && choices > 1)
+            {
+                std::vector<std::string> hosts(choices);
+                for (std::size_t i = 0; i < choices; ++i)
+                {
+                    auto url = request.url;
+                    util::replace_in_place(url, pattern, pattern.substr(1 + i, 1));
+                    std::string path, query_text;
+                    split_url(url, hosts[i], path, query_text);
+                }
+                pick = io.services.httpPool->chooseHost(hosts);
+            }
+
+            util::replace_in_place(request.url, pattern, pattern.substr(1 + pick, 1));
         }
 
         // make the actual request:
@@ -676,8 +973,14 @@ URI::read(const IOOptions& io) const
 
         content = {
             contentType,
-            r.value.data
+            std::move(r.value.data),
+            std::chrono::system_clock::now()
         };
+
+        if (io.services.cache)
+        {
+            io.services.cache->write(full(), content);
+        }
     }
     else
     {
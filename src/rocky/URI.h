@@ -8,8 +8,13 @@
 #include <rocky/Common.h>
 #include <rocky/IOTypes.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ROCKY_NAMESPACE
@@ -133,7 +138,7 @@ namespace ROCKY_NAMESPACE
         static std::string urlEncode(const std::string& value);
 
         //! Try to infer a content-type from a string of bytes.
-        static std::string inferContentType(const std::string& value);
+        static std::string inferContentType(std::string_view value);
 
 
     protected:
@@ -144,6 +149,7 @@ namespace ROCKY_NAMESPACE
 
         void set(const std::string& location, const URIContext& context);
         void findRotation();
+        IOResult<Content> readImplementation(const IOOptions& io) const;
     };
 
     /**
@@ -154,4 +160,81 @@ namespace ROCKY_NAMESPACE
         std::string text;
         URI href;
     };
+
+    /**
+    * Pool of reusable HTTP connections, keyed by protocol, host and port.
+    *
+    * Keeping connections alive between requests saves a TCP (and TLS)
+    * handshake per tile. The number of simultaneous connections to one
+    * host is capped; a request beyond the cap waits for another to finish.
+    * Install one in IOOptions::services.httpPool to enable pooling.
+    */
+    class ROCKY_EXPORT HTTPConnectionPool
+    {
+    public:
+        //! Snapshot of pool statistics
+        struct Stats
+        {
+            std::uint64_t created = 0;  // new connections opened
+            std::uint64_t reused = 0;   // requests served by an idle connection
+            std::uint64_t waits = 0;    // requests that waited for a host at capacity
+            std::uint64_t expired = 0;  // idle connections closed after idleTimeout
+            std::size_t active = 0;     // connections currently in use
+            std::size_t idle = 0;       // connections available for reuse
+
+            //! Fraction of requests that reused a connection [0..1]
+            float reuseRatio() const {
+                auto total = created + reused;
+                return total > 0 ? (float)reused / (float)total : 0.0f;
+            }
+        };
+
+        //! Construct a pool
+        //! @param maxConnectionsPerHost Maximum simultaneous connections to any one host
+        HTTPConnectionPool(unsigned maxConnectionsPerHost = 6);
+
+        //! Maximum simultaneous connections to any one host
+        inline unsigned maxConnectionsPerHost() const { return _maxPerHost; }
+
+        //! How long an unused connection stays open before it is discarded
+        std::chrono::seconds idleTimeout = std::chrono::seconds(10);
+
+        //! Given a set of interchangeable hosts (like the subdomains of a URI
+        //! rotation), the index of the one that can take a request soonest:
+        //! hosts with idle connections first, then the least busy.
+        std::size_t chooseHost(const std::vector<std::string>& hosts) const;
+
+        //! Current statistics. Safe to call from any thread.
+        Stats stats() const;
+
+        //! Close all idle connections
+        void clear();
+
+    public: // used by the HTTP client
+
+        //! Opaque connection (defined by the HTTP implementation)
+        struct Connection;
+
+        //! Borrow a connection to a host ("proto://host:port"), waiting if
+        //! the host is at capacity. Returns nullptr if canceled while waiting.
+        std::shared_ptr<Connection> acquire(const std::string& host, const Cancelable* cancelable);
+
+        //! Return a connection to the pool. Pass reusable = false if the
+        //! connection is in an unknown state and should be closed.
+        void release(std::shared_ptr<Connection> connection, bool reusable);
+
+    private:
+        struct Host
+        {
+            std::vector<std::shared_ptr<Connection>> idle;
+            unsigned active = 0;
+        };
+
+        unsigned _maxPerHost;
+        mutable std::mutex _mutex;
+        std::condition_variable _released;
+        std::unordered_map<std::string, Host> _hosts;
+        mutable std::atomic_uint _next = { 0 };
+        Stats _stats;
+    };
 }
@@ -0,0 +1,194 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    namespace util
+    {
+        /**
+        * Per-frame allowance of bytes to upload to the GPU, shared by every
+        * thread that uploads textures (the terrain pager, the entity compiler).
+        * Call nextFrame() once per frame to restore the allowance.
+        *
+        * The first claim of a frame always succeeds, however large, so an
+        * upload bigger than the whole budget still goes through eventually.
+        * Thread-safe.
+        */
+        class UploadBudget
+        {
+        public:
+            //! Bytes allowed per frame; zero means unlimited
+            void setLimit(std::uint64_t bytes)
+            {
+                std::scoped_lock lock(_mutex);
+                _limit = bytes;
+            }
+
+            //! Bytes allowed per frame; zero means unlimited
+            std::uint64_t limit() const
+            {
+                std::scoped_lock lock(_mutex);
+                return _limit;
+            }
+
+            //! Starts a new frame, restoring the full allowance and waking
+            //! any thread waiting in claim().
+            void nextFrame()
+            {
+                {
+                    std::scoped_lock lock(_mutex);
+                    _claimed = 0;
+                }
+                _cv.notify_all();
+            }
+
+            //! Claims bytes from this frame's allowance without waiting.
+            //! @return true if the bytes were granted
+            bool tryClaim(std::uint64_t bytes)
+            {
+                std::scoped_lock lock(_mutex);
+                return claimLocked(bytes);
+            }
+
+            //! Claims bytes from this frame's allowance, waiting for later
+            //! frames if this one is spent.
+            //! @return true if the bytes were granted before the timeout
+            bool claim(std::uint64_t bytes, std::chrono::milliseconds timeout)
+            {
+                std::unique_lock lock(_mutex);
+                return _cv.wait_for(lock, timeout, [&]() { return claimLocked(bytes); });
+            }
+
+            //! Bytes claimed so far this frame
+            std::uint64_t claimed() const
+            {
+                std::scoped_lock lock(_mutex);
+                return _claimed;
+            }
+
+            //! Bytes left this frame
+            std::uint64_t available() const
+            {
+                std::scoped_lock lock(_mutex);
+                if (_limit == 0)
+                    return std::numeric_limits<std::uint64_t>::max();
+                return _claimed < _limit ? _limit - _claimed : 0;
+            }
+
+        private:
+            mutable std::mutex _mutex;
+            std::condition_variable _cv;
+            std::uint64_t _limit = 0;
+            std::uint64_t _claimed = 0;
+
+            bool claimLocked(std::uint64_t bytes)
+            {
+                if (_limit > 0 && _claimed > 0 && _claimed + bytes > _limit)
+                    return false;
+                _claimed += bytes;
+                return true;
+            }
+        };
+
+        /**
+        * Queue of pending GPU uploads that hands them out in batches, most
+        * important first, within an UploadBudget. T is whatever the caller needs
+        * to perform the upload later. Not thread-safe.
+        */
+        template<class T>
+        class UploadQueue
+        {
+        public:
+            struct Batch
+            {
+                std::vector<T> items;
+                std::uint64_t bytes = 0;
+            };
+
+            //! Queue an upload of the given size
+            void push(T item, std::uint64_t bytes)
+            {
+                _items.emplace_back(Entry{ std::move(item), bytes });
+            }
+
+            //! Remove every upload for which pred(item) returns true
+            //! @return number of uploads removed
+            template<class PRED>
+            std::size_t erase_if(PRED&& pred)
+            {
+                auto end = std::remove_if(_items.begin(), _items.end(),
+                    [&](const Entry& e) { return pred(e.item); });
+                auto count = (std::size_t)std::distance(end, _items.end());
+                _items.erase(end, _items.end());
+                return count;
+            }
+
+            //! Takes the next batch of uploads in descending priority(item) order,
+            //! claiming their bytes from the budget, and stops at the first one
+            //! the budget cannot cover. Uploads that don't fit stay queued.
+            template<class PRIORITY>
+            Batch nextBatch(UploadBudget& budget, PRIORITY&& priority)
+            {
+                Batch batch;
+
+                std::vector<std::pair<float, std::size_t>> order;
+                order.reserve(_items.size());
+                for (std::size_t i = 0; i < _items.size(); ++i)
+                    order.emplace_back(priority(_items[i].item), i);
+
+                std::stable_sort(order.begin(), order.end(),
+                    [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+                std::vector<Entry> leftovers;
+                bool full = false;
+                for (auto& [p, i] : order)
+                {
+                    auto& entry = _items[i];
+                    full = full || !budget.tryClaim(entry.bytes);
+                    if (full)
+                    {
+                        leftovers.emplace_back(std::move(entry));
+                        continue;
+                    }
+
+                    batch.bytes += entry.bytes;
+                    batch.items.emplace_back(std::move(entry.item));
+                }
+
+                _items.swap(leftovers);
+                return batch;
+            }
+
+            //! Number of queued uploads
+            std::size_t size() const { return _items.size(); }
+
+            //! Whether the queue is empty
+            bool empty() const { return _items.empty(); }
+
+            //! Drop all queued uploads
+            void clear() { _items.clear(); }
+
+        private:
+            struct Entry
+            {
+                T item;
+                std::uint64_t bytes = 0;
+            };
+            std::vector<Entry> _items;
+        };
+    }
+}
@@ -6,6 +6,7 @@
 #include "Utils.h"
 #include "sha1.h"
 #include "Context.h"
+#include "Trace.h"
 #include <cctype>
 #include <cstring>
 #include <cstdlib>
@@ -513,6 +514,10 @@ rocky::util::isEnvVarSet(const char* name)
 void
 rocky::util::setThreadName(const char* name)
 {
+#ifdef ROCKY_HAS_TRACING
+    Trace::setThreadName(name);
+#endif
+
 #if (defined _WIN32 && defined _WIN32_WINNT_WIN10 && defined _WIN32_WINNT && _WIN32_WINNT >= _WIN32_WINNT_WIN10) || (defined __CYGWIN__)
     wchar_t buf[256];
     mbstowcs(buf, name, 256);
@@ -15,4 +15,7 @@
 #include <rocky/MBTilesImageLayer.h>
 #include <rocky/MBTilesElevationLayer.h>
 #include <rocky/AzureImageLayer.h>
+#include <rocky/Buffer.h>
+#include <rocky/DiskCache.h>
+#include <rocky/Trace.h>
 #include <rocky/contrib/EarthFileImporter.h>
@@ -6,6 +6,7 @@
 #include "Application.h"
 #include "MapManipulator.h"
 #include "json.h"
+#include <rocky/Trace.h>
 
 #include "ecs/MeshSystem.h"
 #include "ecs/LineSystem.h"
@@ -40,7 +41,7 @@ namespace
 
         if (map_file.status.ok())
         {
-            auto parse_result = mapNode.from_json(map_file->data, context->io.from(location));
+            auto parse_result = mapNode.from_json(map_file->data.str(), context->io.from(location));
             if (parse_result.failed())
             {
                 status = parse_result;
@@ -446,6 +447,8 @@ Application::frame()
 
     t_start = std::chrono::steady_clock::now();
 
+    ROCKY_TRACE_SCOPE("frame");
+
     // whether we need to render a new frame based on the renderOnDemand state:
     context->renderingEnabled =
         context->renderContinuously == true ||
@@ -464,7 +467,10 @@ Application::frame()
         auto num_windows = viewer->windows().size();
 
         // Update the scene graph (see AppUpdateOperation)
-        viewer->update();
+        {
+            ROCKY_TRACE_SCOPE("update");
+            viewer->update();
+        }
 
         // it's possible that an update operation will shut down the viewer:
         if (!viewer->active())
@@ -484,7 +490,10 @@ Application::frame()
 
         // Event handling happens after updating the scene, otherwise
         // things like tethering to a moving node will be one frame behind
-        viewer->handleEvents();
+        {
+            ROCKY_TRACE_SCOPE("events");
+            viewer->handleEvents();
+        }
 
         if (!viewer->active())
         {
@@ -494,11 +503,17 @@ Application::frame()
 
         t_record = std::chrono::steady_clock::now();
 
-        viewer->recordAndSubmit();
+        {
+            ROCKY_TRACE_SCOPE("record");
+            viewer->recordAndSubmit();
+        }
 
         t_present = std::chrono::steady_clock::now();
 
-        viewer->present();
+        {
+            ROCKY_TRACE_SCOPE("present");
+            viewer->present();
+        }
 
         auto t_end = std::chrono::steady_clock::now();
         stats.frame = std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start);
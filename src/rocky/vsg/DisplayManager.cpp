@@ -294,6 +294,23 @@ DisplayManager::addWindow(vsg::ref_ptr<vsg::WindowTraits> traits)
 
     auto window = vsg::Window::create(traits);
 
+    // The first window creates the device lazily, so there's still time to
+    // enable BC texture sampling (for compressed terrain imagery) if the
+    // physical device supports it.
+    if (!traits->device)
+    {
+        auto physicalDevice = window->getOrCreatePhysicalDevice();
+        if (physicalDevice && physicalDevice->getFeatures().textureCompressionBC)
+        {
+            if (!traits->deviceFeatures)
+            {
+                traits->deviceFeatures = vsg::DeviceFeatures::create();
+            }
+            traits->deviceFeatures->get().textureCompressionBC = VK_TRUE;
+            context->textureCompressionBC = true;
+        }
+    }
+
     addWindow(window);
 
     return window;
@@ -138,6 +138,27 @@ namespace ROCKY_NAMESPACE
             return vsg_data;
         }
 
+        //! Returns a vsg::Data structure pointing to the 4x4 blocks of a
+        //! block-compressed image without taking ownership of the data.
+        //! The array dimensions count blocks, not pixels.
+        template<typename T>
+        vsg::ref_ptr<vsg::Data> wrapBlocks(std::shared_ptr<Image> image, VkFormat format)
+        {
+            unsigned
+                width = (image->width() + 3) / 4,
+                height = (image->height() + 3) / 4;
+
+            T* data = image->data<T>();
+
+            vsg::Data::Properties props;
+            props.format = format;
+            props.blockWidth = 4;
+            props.blockHeight = 4;
+            props.allocatorType = vsg::ALLOCATOR_TYPE_NO_DELETE;
+
+            return vsg::Array2D<T>::create(width, height, data, props);
+        }
+
         //! Wraps a rocky Image object in a VSG Data object.
         //! The source Image is not cleared in the process and data is now shared between the two.
         inline vsg::ref_ptr<vsg::Data> wrapImageData(std::shared_ptr<Image> image)
@@ -167,12 +188,22 @@ namespace ROCKY_NAMESPACE
             case Image::R64_SFLOAT:
                 return wrap<double>(image, VK_FORMAT_R64_SFLOAT);
                 break;
+            case Image::BC1_RGB_UNORM:
+                return wrapBlocks<vsg::block64>(image, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+                break;
+            case Image::BC3_UNORM:
+                return wrapBlocks<vsg::block128>(image, VK_FORMAT_BC3_UNORM_BLOCK);
+                break;
+            case Image::BC7_UNORM:
+                return wrapBlocks<vsg::block128>(image, VK_FORMAT_BC7_UNORM_BLOCK);
+                break;
             };
 
             return { };
         }
 
-        //! Wraps a rocky Image object in a VSG Data object. Data is shared.
+        //! Wraps a rocky Image object in a VSG Data object. Data is shared,
+        //! including any mipmap levels the image carries.
         inline vsg::ref_ptr<vsg::Data> wrapImageInVSG(std::shared_ptr<Image> image)
         {
             if (!image)
@@ -180,7 +211,7 @@ namespace ROCKY_NAMESPACE
 
             auto data = wrapImageData(image);
             data->properties.origin = vsg::TOP_LEFT;
-            data->properties.maxNumMipmaps = 1;
+            data->properties.maxNumMipmaps = image->mipLevels();
 
             return data;
         }
@@ -6,7 +6,9 @@
 #include "VSGContext.h"
 #include "MapNode.h"
 #include "Utils.h"
+#include <rocky/DiskCache.h>
 #include <rocky/Image.h>
+#include <rocky/Trace.h>
 #include <rocky/URI.h>
 
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -136,9 +138,18 @@ namespace
             if (!options || _features.extensionFeatureMap.count(options->extensionHint) == 0)
                 return {};
 
-            std::stringstream buf;
-            buf << in.rdbuf() << std::flush;
-            std::string data = buf.str();
+            // decode straight from the source memory when we can
+            Buffer data;
+            if (auto bs = dynamic_cast<BufferStream*>(&in))
+            {
+                data = bs->buffer().slice(bs->tellg());
+            }
+            else
+            {
+                std::stringstream buf;
+                buf << in.rdbuf() << std::flush;
+                data = buf.str();
+            }
 
             std::string gdal_driver =
                 options->extensionHint.string() == ".webp" ? "webp" :
@@ -147,7 +158,7 @@ namespace
                 options->extensionHint.string() == ".png" ? "png" :
                 "";
 
-            auto result = GDAL::readImage((unsigned char*)data.c_str(), data.length(), gdal_driver);
+            auto result = GDAL::readImage((unsigned char*)data.data(), data.size(), gdal_driver);
 
             if (result.status.ok())
                 return util::moveImageToVSG(result.value);
@@ -406,7 +417,7 @@ VSGContextImpl::ctor(int& argc, char** argv)
         auto result = URI(location).read(io);
         if (result.status.ok())
         {
-            std::stringstream buf(result.value.data);
+            BufferStream buf(result.value.data);
             return io.services.readImageFromStream(buf, result.value.contentType, io);
         }
         return Result<std::shared_ptr<Image>>(Status(Status::ResourceUnavailable, "Data is null"));
@@ -430,6 +441,8 @@ VSGContextImpl::ctor(int& argc, char** argv)
     // extension in the options structure as a hint.
     io.services.readImageFromStream = [options(readerWriterOptions)](std::istream& location, std::string contentType, const rocky::IOOptions& io) -> Result<std::shared_ptr<Image>>
         {
+            ROCKY_TRACE_SCOPE("decode image");
+
             // try the mime-type mapping:
             auto i = ext_for_mime_type.find(contentType);
             if (i != ext_for_mime_type.end())
@@ -479,9 +492,56 @@ VSGContextImpl::ctor(int& argc, char** argv)
             return Status(Status::ServiceUnavailable, "No image reader for \"" + contentType + "\"");
         };
 
-    io.services.contentCache = std::make_shared<ContentCache>(128);
+#ifdef ROCKY_HAS_GDAL
+    // Image encoding (e.g. for writing tiles to an MBTiles database) uses GDAL.
+    io.services.writeImageToStream = [](std::shared_ptr<Image> image, std::ostream& out, std::string contentType, const rocky::IOOptions& io) -> Status
+        {
+            static const std::unordered_map<std::string, std::string> gdal_driver_for_mime_type = {
+                { "image/jpg", "JPEG" },
+                { "image/jpeg", "JPEG" },
+                { "image/png", "PNG" },
+                { "image/tif", "GTiff" },
+                { "image/tiff", "GTiff" },
+                { "image/webp", "WEBP" },
+                { "jpg", "JPEG" },
+                { "jpeg", "JPEG" },
+                { "png", "PNG" },
+                { "tif", "GTiff" },
+                { "tiff", "GTiff" },
+                { "webp", "WEBP" }
+            };
+
+            auto i = gdal_driver_for_mime_type.find(util::toLower(contentType));
+            if (i == gdal_driver_for_mime_type.end())
+                return Status(Status::ServiceUnavailable, "No image writer for \"" + contentType + "\"");
+
+            auto result = GDAL::writeImage(image, i->second);
+            if (result.status.failed())
+                return result.status;
+
+            out.write(result.value.data(), result.value.size());
+            return out.good() ? StatusOK : Status(Status::GeneralError, "Failed to write image");
+        };
+#endif
+
+    io.services.contentCache = std::make_shared<ContentCache>(64 * 1024 * 1024);
+
+    // Optional persistent cache for remote content
+    auto cache_path = util::getEnvVar("ROCKY_CACHE_PATH");
+    if (!cache_path.empty())
+    {
+        auto max_mb = util::as<std::uint64_t>(util::getEnvVar("ROCKY_CACHE_MAX_SIZE_MB"), 0u);
+        auto cache = DiskCache::create(cache_path, max_mb * 1048576u);
+        cache->maxAge = std::chrono::seconds(util::as<long>(util::getEnvVar("ROCKY_CACHE_MAX_AGE"), 0L));
+        if (cache->status().ok())
+            io.services.cache = cache;
+    }
 
-    io.uriGate = std::make_shared<util::Gate<std::string>>();
+    // Keep-alive connections for remote reads
+    auto max_connections = util::as<unsigned>(util::getEnvVar("ROCKY_HTTP_MAX_CONNECTIONS_PER_HOST"), 6u);
+    io.services.httpPool = std::make_shared<HTTPConnectionPool>(max_connections);
+
+    io.uriFlights = std::make_shared<util::SingleFlight<std::string, IOResult<Content>>>();
 }
 
 vsg::ref_ptr<vsg::Device>
@@ -539,6 +599,12 @@ VSGContextImpl::compile(vsg::ref_ptr<vsg::Object> compilable)
     ROCKY_SOFT_ASSERT(viewer.valid(), "Developer: failure to set VSGContext->viewer");
     ROCKY_SOFT_ASSERT_AND_RETURN(compilable.valid(), void());
 
+    // a viewer without windows (e.g. a headless tool) has nothing to compile with
+    if (!viewer || !viewer->compileManager)
+        return;
+
+    ROCKY_TRACE_SCOPE("VSGContext::compile");
+
     // note: this can block (with a fence) until a compile traversal is available.
     // Be sure to group as many compiles together as possible for maximum performance.
     auto cr = viewer->compileManager->compile(compilable);
@@ -590,6 +656,9 @@ VSGContextImpl::update()
 
     bool updates_occurred = false;
 
+    // restore this frame's GPU upload allowance
+    uploadBudget.nextFrame();
+
     if (_compileResult)
     {
         std::unique_lock lock(_compileMutex);
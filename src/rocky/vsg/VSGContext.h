@@ -5,6 +5,7 @@
  */
 #pragma once
 #include <rocky/Context.h>
+#include <rocky/UploadQueue.h>
 #include <rocky/vsg/Common.h>
 #include <vsg/all.h>
 #include <deque>
@@ -52,6 +53,15 @@ namespace ROCKY_NAMESPACE
         //! Whether rendering is enabled in the current frame.
         bool renderingEnabled = true;
 
+        //! Whether the shared device can sample BC (block-compressed) textures.
+        //! DisplayManager enables the feature when the hardware supports it.
+        std::atomic_bool textureCompressionBC = { false };
+
+        //! Bytes of texture data to upload to the GPU per frame, shared by the
+        //! terrain pager and the entity compiler. The terrain's "uploadBudgetKB"
+        //! setting sets the limit; unlimited by default.
+        util::UploadBudget uploadBudget;
+
         //! Shared shader compile settings. Use this to insert shader defines
         //! that should be used throughout the application; things like enabling
         //! lighting, debug visuals, etc.
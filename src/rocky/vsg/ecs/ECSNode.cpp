@@ -4,11 +4,42 @@
  * MIT License
  */
 #include "ECSNode.h"
+#include <set>
 
 ROCKY_ABOUT(entt, ENTT_VERSION);
 
 using namespace ROCKY_NAMESPACE;
 
+namespace
+{
+    // Sums the texture data that compiling a subgraph will upload, i.e. the
+    // images not yet compiled on the device. Shared images count once.
+    struct CountUploadBytes : public vsg::ConstVisitor
+    {
+        std::uint32_t deviceID = 0;
+        std::set<const vsg::Data*> seen;
+        std::uint64_t bytes = 0;
+
+        void apply(const vsg::Object& object) override
+        {
+            object.traverse(*this);
+        }
+
+        void apply(const vsg::DescriptorImage& descriptor) override
+        {
+            for (auto& info : descriptor.imageInfoList)
+            {
+                if (info && info->imageView && info->imageView->image &&
+                    info->imageView->vk(deviceID) == VK_NULL_HANDLE)
+                {
+                    auto& data = info->imageView->image->data;
+                    if (data && seen.insert(data.get()).second)
+                        bytes += data->dataSize();
+                }
+            }
+        }
+    };
+}
 
 ecs::ECSNode::ECSNode(ecs::Registry& reg) :
     registry(reg)
@@ -72,6 +103,27 @@ ecs::EntityNodeFactory::start()
                         // compile everything (creates any new vulkan objects)
                         if (group->children.size() > 0)
                         {
+                            // new textures count against the same per-frame upload
+                            // budget as the terrain's, so wait for an allowance.
+                            auto device = (*batch.context)->device();
+                            if (device)
+                            {
+                                CountUploadBytes counter;
+                                counter.deviceID = device->deviceID;
+                                group->accept(counter);
+
+                                // the allowance renews each frame, so make sure one comes
+                                auto& budget = (*batch.context)->uploadBudget;
+                                while (counter.bytes > 0 && buffers.use_count() > 1)
+                                {
+                                    if (budget.tryClaim(counter.bytes))
+                                        break;
+                                    (*batch.context)->requestFrame();
+                                    if (budget.claim(counter.bytes, std::chrono::milliseconds(500)))
+                                        break;
+                                }
+                            }
+
                             // compile all the results at once:
                             (*batch.context)->compile(group);
 
@@ -12,6 +12,7 @@
 #include <rocky/Horizon.h>
 #include <rocky/vsg/Utils.h>
 #include <rocky/vsg/ViewLocal.h>
+#include <rocky/vsg/terrain/TerrainView.h>
 #include <vsg/nodes/MatrixTransform.h>
 #include <vsg/vk/State.h>
 #include <vsg/maths/vec3.h>
@@ -46,6 +47,9 @@ namespace ROCKY_NAMESPACE
         //! and horizon checks)
         inline bool isVisible(vsg::RecordTraversal& rv) const;
 
+        //! Same visibility check for a headless view
+        inline bool isVisible(const TerrainView& view) const;
+
         //! Force a recompute of the bounding box and culling information
         const vsg::dsphere& recomputeBound();
 
@@ -119,4 +123,32 @@ namespace ROCKY_NAMESPACE
 
         return true;
     }
+
+    inline bool SurfaceNode::isVisible(const TerrainView& view) const
+    {
+        for (auto& face : view.frustum)
+        {
+            int p;
+            for (p = 0; p < 8; ++p)
+                if (vsg::distance(face, _worldPoints[p]) > 0.0)
+                    break;
+
+            if (p == 8)
+                return false;
+        }
+
+        if (view.horizon)
+        {
+            if (_horizonCullingPoint_valid)
+                return view.horizon->isVisible(_horizonCullingPoint);
+
+            for (int p = 0; p < 4; ++p)
+                if (view.horizon->isVisible(_worldPoints[p]))
+                    return true;
+
+            return false;
+        }
+
+        return true;
+    }
 }
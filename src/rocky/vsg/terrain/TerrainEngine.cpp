@@ -36,7 +36,12 @@ TerrainEngine::TerrainEngine(
 
     worldSRS = profile.srs().isGeodetic() ? profile.srs().geocentricSRS() : profile.srs();
 
-    jobs::get_pool(loadSchedulerName)->set_concurrency(settings.concurrency);
+    auto pool = jobs::get_pool(loadSchedulerName);
+    pool->set_concurrency(settings.concurrency);
+
+    // thousands of tile loads can be queued at once; keep them in a heap and
+    // refresh their priorities once per frame (see TerrainNode::update).
+    pool->set_scheduling(jobs::scheduling::heap);
 }
 
 
@@ -64,6 +69,28 @@ TerrainEngine::createTile(const TileKey& key, vsg::ref_ptr<TerrainTileNode> pare
     tile->surface->addChild(tile->stategroup);
     tile->addChild(tile->surface);
     tile->host = tiles._host;
+    tile->residency = tiles._residency;
+
+    // Geometry memory: the vertex arrays (kept on the CPU and copied to the GPU)
+    // and the CPU-only proxies. Pooled geometry is shared among tiles, so this
+    // overstates the total a little, which errs on the safe side of a budget.
+    TerrainResidency::Bytes geometryBytes;
+    auto count = [&geometryBytes](const vsg::Data* data, bool onGPU)
+    {
+        if (data)
+        {
+            geometryBytes.cpu += data->dataSize();
+            if (onGPU)
+                geometryBytes.gpu += data->dataSize();
+        }
+    };
+    for (auto& array : geometry->arrays)
+        count(array ? array->data.get() : nullptr, true);
+    count(geometry->proxy_verts, false);
+    count(geometry->proxy_normals, false);
+    count(geometry->proxy_uvs, false);
+    count(geometry->proxy_indices, false);
+    tile->setGeometryBytes(geometryBytes);
 
     // inherit model data from the parent
     if (parent)
@@ -135,6 +135,9 @@ TerrainNode::update(VSGContext context)
 
             if (engine->tiles.update(context->viewer->getFrameStamp(), context->io, engine))
                 changes = true;
+
+            // the camera may have moved, so refresh the load priorities
+            jobs::get_pool(engine->loadSchedulerName)->reprioritize();
             
             engine->geometryPool.sweep(engine->context);
         }
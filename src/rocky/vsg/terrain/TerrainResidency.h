@@ -0,0 +1,72 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <atomic>
+#include <cstdint>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Running totals of the memory held by terrain tiles, on the CPU and on
+     * the GPU. Tiles add their share as they get geometry and data, and
+     * remove it when they release it or are destroyed (on whatever thread
+     * that happens), so the totals are thread-safe.
+     */
+    class TerrainResidency
+    {
+    public:
+        struct Bytes
+        {
+            std::int64_t cpu = 0;
+            std::int64_t gpu = 0;
+
+            Bytes& operator += (const Bytes& rhs) { cpu += rhs.cpu; gpu += rhs.gpu; return *this; }
+            Bytes& operator -= (const Bytes& rhs) { cpu -= rhs.cpu; gpu -= rhs.gpu; return *this; }
+        };
+
+        //! Account for newly resident memory
+        void add(const Bytes& bytes)
+        {
+            auto cpu = (_cpu += bytes.cpu);
+            auto gpu = (_gpu += bytes.gpu);
+            raise(_peakCpu, cpu);
+            raise(_peakGpu, gpu);
+        }
+
+        //! Account for released memory
+        void remove(const Bytes& bytes)
+        {
+            _cpu -= bytes.cpu;
+            _gpu -= bytes.gpu;
+        }
+
+        //! Memory resident now
+        Bytes current() const
+        {
+            return { _cpu.load(), _gpu.load() };
+        }
+
+        //! Most memory ever resident at once
+        Bytes peak() const
+        {
+            return { _peakCpu.load(), _peakGpu.load() };
+        }
+
+    private:
+        std::atomic<std::int64_t> _cpu = { 0 };
+        std::atomic<std::int64_t> _gpu = { 0 };
+        std::atomic<std::int64_t> _peakCpu = { 0 };
+        std::atomic<std::int64_t> _peakGpu = { 0 };
+
+        static void raise(std::atomic<std::int64_t>& peak, std::int64_t value)
+        {
+            auto prev = peak.load();
+            while (value > prev && !peak.compare_exchange_weak(prev, value));
+        }
+    };
+}
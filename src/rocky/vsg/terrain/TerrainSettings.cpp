@@ -22,6 +22,14 @@ TerrainSettings::from_json(const std::string& JSON)
     get_to(j, "skirt_ratio", skirtRatio);
     get_to(j, "color", color);
     get_to(j, "concurrency", concurrency);
+    get_to(j, "progressive", progressive);
+    get_to(j, "prioritized_loading", prioritizedLoading);
+    get_to(j, "max_loads_in_flight", maxLoadsInFlight);
+    get_to(j, "merge_budget_us", mergeBudgetMicros);
+    get_to(j, "cpu_budget_mb", cpuBudgetMB);
+    get_to(j, "gpu_budget_mb", gpuBudgetMB);
+    get_to(j, "upload_budget_kb", uploadBudgetKB);
+    get_to(j, "color_mipmaps", colorMipmaps);
 
     return Status_OK;
 }
@@ -39,5 +47,13 @@ TerrainSettings::to_json() const
     set(j, "skirt_ratio", skirtRatio);
     set(j, "color", color);
     set(j, "concurrency", concurrency);
+    set(j, "progressive", progressive);
+    set(j, "prioritized_loading", prioritizedLoading);
+    set(j, "max_loads_in_flight", maxLoadsInFlight);
+    set(j, "merge_budget_us", mergeBudgetMicros);
+    set(j, "cpu_budget_mb", cpuBudgetMB);
+    set(j, "gpu_budget_mb", gpuBudgetMB);
+    set(j, "upload_budget_kb", uploadBudgetKB);
+    set(j, "color_mipmaps", colorMipmaps);
     return j.dump();
 }
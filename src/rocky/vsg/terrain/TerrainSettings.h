@@ -57,6 +57,51 @@ namespace ROCKY_NAMESPACE
         //! Number of threads dedicated to loading terrain data
         option<unsigned> concurrency = 4;
 
+        //! Whether to load every level of detail before the next one (true), or
+        //! to subdivide straight to the level the view needs and load only the
+        //! tiles that will be drawn (false). In the latter case a tile renders
+        //! the data of its nearest loaded ancestor until its own data arrives.
+        option<bool> progressive = true;
+
+        //! Whether to load tile data in order of screen-space error, keeping at
+        //! most "maxLoadsInFlight" loads queued or running, and canceling loads
+        //! for tiles that are no longer in use. When false, every request is
+        //! dispatched as soon as the tile asks for it.
+        option<bool> prioritizedLoading = false;
+
+        //! Maximum number of tile data loads queued or running at once
+        //! when "prioritizedLoading" is set.
+        option<unsigned> maxLoadsInFlight = 16;
+
+        //! Time allowed each frame for merging loaded tile data into the scene,
+        //! in microseconds. Merges that don't fit wait for the next frame. At
+        //! least one merge runs every frame regardless.
+        option<unsigned> mergeBudgetMicros = 2000;
+
+        //! Limit on the CPU memory held by terrain tiles, in megabytes. When
+        //! over the limit, the pager releases the tiles that have gone longest
+        //! without being seen, never those being drawn. Zero means no limit.
+        option<unsigned> cpuBudgetMB = 0;
+
+        //! Limit on the GPU memory held by terrain tiles, in megabytes,
+        //! enforced like "cpuBudgetMB". Zero means no limit.
+        option<unsigned> gpuBudgetMB = 0;
+
+        //! Tile texture data to upload to the GPU each frame, in kilobytes.
+        //! When set, loading threads don't upload the textures they load;
+        //! instead the pager submits them in batches, most important first,
+        //! to a dedicated upload thread, and merges each tile once its upload
+        //! completes. At least one upload goes through each frame regardless.
+        //! The limit applies to the context's shared upload budget, so entity
+        //! textures (icons, for example) count against it too.
+        //! Zero means each loading thread uploads its own tile's textures.
+        option<unsigned> uploadBudgetKB = 0;
+
+        //! Whether to generate mipmaps for tile imagery on the loading threads
+        //! and upload them with the tile. Mipmaps prevent shimmering and keep
+        //! texture reads cache-friendly where tiles are seen at grazing angles.
+        option<bool> colorMipmaps = false;
+
     public: // internal runtime settings, not serialized.
 
         //! TEMPORARY.
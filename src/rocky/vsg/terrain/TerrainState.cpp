@@ -65,7 +65,7 @@ TerrainState::createDefaultDescriptors(VSGContext& context)
 
     // color channel
     // TODO: more than one - make this an array?
-    // TODO: activate mipmapping
+    // Mipmaps arrive with the images when TerrainSettings::colorMipmaps is set.
     texturedefs.color = { COLOR_TEX_NAME, COLOR_TEX_BINDING, vsg::Sampler::create(), {} };
     texturedefs.color.sampler->minFilter = VK_FILTER_LINEAR;
     texturedefs.color.sampler->magFilter = VK_FILTER_LINEAR;
@@ -258,7 +258,8 @@ TerrainTileRenderModel
 TerrainState::updateRenderModel(
     const TerrainTileRenderModel& oldRenderModel,
     const TerrainTileModel& dataModel,
-    VSGContext& runtime) const
+    VSGContext& runtime,
+    bool compile) const
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(status.ok(), oldRenderModel);
     ROCKY_SOFT_ASSERT_AND_RETURN(pipelineConfig.valid(), oldRenderModel);
@@ -356,7 +357,10 @@ TerrainState::updateRenderModel(
     );
 
     // Compile the objects. Everything should be under the bind command.
-    runtime->compile(descriptors.bind);
+    if (compile)
+    {
+        runtime->compile(descriptors.bind);
+    }
 
 #if 0
     // Temporary:
@@ -41,10 +41,13 @@ namespace ROCKY_NAMESPACE
         //! and creates or updates all the necessary descriptors and commands.
         //! After calling this, you will need to install the find bind command
         //! in your stategroup.
+        //! @param compile Whether to compile the new descriptors right away;
+        //!   pass false if you will compile (upload) them yourself later
         TerrainTileRenderModel updateRenderModel(
             const TerrainTileRenderModel& oldRenderModel,
             const TerrainTileModel& newDataModel,
-            VSGContext& runtime) const;
+            VSGContext& runtime,
+            bool compile = true) const;
 
         //! Status of the factory.
         Status status;
@@ -40,12 +40,59 @@ namespace
     }; 
 }
 
+TerrainTileNode::~TerrainTileNode()
+{
+    if (residency)
+    {
+        residency->remove(_dataBytes);
+        residency->remove(_geometryBytes);
+    }
+}
+
+TerrainResidency::Bytes
+TerrainTileNode::dataBytes() const
+{
+    std::scoped_lock lock(_bytesMutex);
+    return _dataBytes;
+}
+
+TerrainResidency::Bytes
+TerrainTileNode::geometryBytes() const
+{
+    std::scoped_lock lock(_bytesMutex);
+    return _geometryBytes;
+}
+
 void
-TerrainTileNode::accept(vsg::RecordTraversal& rv) const
+TerrainTileNode::setDataBytes(const TerrainResidency::Bytes& bytes)
 {
-    ROCKY_SOFT_ASSERT_AND_RETURN(host != nullptr, void());
+    // the swap must be atomic, or a loader and the pager releasing the tile
+    // could both remove the same old value and skew the totals
+    std::scoped_lock lock(_bytesMutex);
+    if (residency)
+    {
+        residency->remove(_dataBytes);
+        residency->add(bytes);
+    }
+    _dataBytes = bytes;
+}
+
+void
+TerrainTileNode::setGeometryBytes(const TerrainResidency::Bytes& bytes)
+{
+    std::scoped_lock lock(_bytesMutex);
+    if (residency)
+    {
+        residency->remove(_geometryBytes);
+        residency->add(bytes);
+    }
+    _geometryBytes = bytes;
+}
 
-    auto frame = rv.getFrameStamp()->frameCount;
+void
+TerrainTileNode::touch(const vsg::FrameStamp* fs, float range) const
+{
+    auto frame = fs->frameCount;
 
     // is this a new frame (since the last time we were here)?
     auto new_frame = lastTraversalFrame.exchange(frame) != frame;
@@ -53,51 +100,68 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
     // swap out the range; used for page out
     lastTraversalRange.exchange(std::min(
         (float)(new_frame ? FLT_MAX : (float)lastTraversalRange),
-        (float)distanceTo(bound.center, rv.getState())));
+        range));
 
     // swap out the time; used for page out
-    lastTraversalTime.exchange(rv.getFrameStamp()->time);
+    lastTraversalTime.exchange(fs->time);
 
     if (subtilesExist())
     {
         needsSubtiles = false;
     }
+}
+
+bool
+TerrainTileNode::subtilesInRange(double d, double viewportHeight) const
+{
+    auto min_screen_height_ratio = (host->settings().tilePixelSize + host->settings().screenSpaceError) / viewportHeight;
+
+    // TODO: someday, when we support orthographic cameras, look at this approach 
+    // that would theoritically keep the same LOD across the visible scene:
+    //double tile_height = surface->localbbox.max.y - surface->localbbox.min.y;
+    //return (d > 0.0) && (tile_height > (d * min_screen_height_ratio));
+
+    return (d > 0.0) && (bound.r > (d * min_screen_height_ratio));
+}
 
-    if (surface->isVisible(rv))
+template<class IN_RANGE, class DRAW_SUBTILES, class DRAW_SELF>
+void
+TerrainTileNode::selectLOD(const vsg::FrameStamp* fs, float range, bool visible, IN_RANGE&& inRange,
+    DRAW_SUBTILES&& drawSubtiles, DRAW_SELF&& drawSelf, vsg::RecordTraversal& rv) const
+{
+    auto frame = fs->frameCount;
+    touch(fs, range);
+
+    if (visible)
     {
-        auto state = rv.getState();
+        lastVisibleFrame = frame;
 
         // should we subdivide?
-        auto& vp = state->_commandBuffer->viewDependentState->viewportData->at(0);
-        auto min_screen_height_ratio = (host->settings().tilePixelSize + host->settings().screenSpaceError) / vp[3];
-        auto d = state->lodDistance(bound);
-        bool subtilesInRange = (d > 0.0) && (bound.r > (d * min_screen_height_ratio));
+        bool refine = inRange();
 
-        // TODO: someday, when we support orthographic cameras, look at this approach 
-        // that would theoritically keep the same LOD across the visible scene:
-        //double tile_height = surface->localbbox.max.y - surface->localbbox.min.y;
-        //return (d > 0.0) && (tile_height > (d * min_screen_height_ratio));
-
-        if (subtilesInRange && subtilesExist())
+        if (refine && subtilesExist())
         {
             // children are available, traverse them now.
-            children[1]->accept(rv);
+            lastSubtilesUseFrame = frame;
+            drawSubtiles();
 
 #ifdef AGGRESSIVE_PAGEOUT
             // always ping all children at once so the system can never
             // delete one of a quad.
-            host->ping(subTile(0), this, rv);
-            host->ping(subTile(1), this, rv);
-            host->ping(subTile(2), this, rv);
-            host->ping(subTile(3), this, rv);
+            for (unsigned i = 0; i < 4; ++i)
+                host->ping(subTile(i), this, rv);
 #endif
         }
         else
         {
             // children do not exist or are out of range; use this tile's geometry
-            children[0]->accept(rv);
+            drawSelf();
 
-            if (subtilesInRange && subtilesLoader.empty())
+            if (!refine)
+            {
+                lastLeafFrame = frame;
+            }
+            else if (subtilesLoader.empty())
             {
                 needsSubtiles = true;
             }
@@ -109,10 +173,8 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
     {
         // always ping all children at once so the system can never
         // delete one of a quad.
-        host->ping(subTile(0), this, rv);
-        host->ping(subTile(1), this, rv);
-        host->ping(subTile(2), this, rv);
-        host->ping(subTile(3), this, rv);
+        for (unsigned i = 0; i < 4; ++i)
+            host->ping(subTile(i), this, rv);
     }
 #endif
 
@@ -123,6 +185,36 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
     }
 }
 
+void
+TerrainTileNode::accept(vsg::RecordTraversal& rv) const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(host != nullptr, void());
+
+    auto state = rv.getState();
+
+    selectLOD(rv.getFrameStamp(), distanceTo(bound.center, state), surface->isVisible(rv),
+        [&]() {
+            auto& vp = state->_commandBuffer->viewDependentState->viewportData->at(0);
+            return subtilesInRange(state->lodDistance(bound), vp[3]);
+        },
+        [&]() { children[1]->accept(rv); },
+        [&]() { children[0]->accept(rv); },
+        rv);
+}
+
+void
+TerrainTileNode::traverse(const TerrainView& view, vsg::RecordTraversal& rv) const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(host != nullptr && view.frameStamp, void());
+
+    // a headless view records nothing, so drawing this tile is a no-op
+    selectLOD(view.frameStamp, (float)vsg::length(bound.center - view.eye), surface->isVisible(view),
+        [&]() { return subtilesInRange(view.lodDistance(bound), view.viewportHeight); },
+        [&]() { for (unsigned i = 0; i < 4; ++i) subTile(i)->traverse(view, rv); },
+        []() { },
+        rv);
+}
+
 void
 TerrainTileNode::inheritFrom(vsg::ref_ptr<TerrainTileNode> parent)
 {
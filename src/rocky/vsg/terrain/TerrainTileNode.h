@@ -8,6 +8,7 @@
 #include <rocky/vsg/Common.h>
 #include <rocky/vsg/terrain/SurfaceNode.h>
 #include <rocky/vsg/terrain/TerrainTileHost.h>
+#include <rocky/vsg/terrain/TerrainResidency.h>
 #include <rocky/Threading.h>
 #include <rocky/TileKey.h>
 #include <rocky/Image.h>
@@ -96,6 +97,25 @@ namespace ROCKY_NAMESPACE
         mutable std::atomic<uint64_t> lastTraversalFrame = { 0 };
         mutable std::atomic<vsg::time_point> lastTraversalTime;
         mutable std::atomic<float> lastTraversalRange = { FLT_MAX };
+        mutable std::atomic<uint64_t> lastVisibleFrame = { 0 };
+        mutable std::atomic<uint64_t> lastSubtilesUseFrame = { 0 }; // last frame that drew the subtiles instead of this tile
+        mutable std::atomic<uint64_t> lastLeafFrame = { 0 }; // last frame a view drew this tile and didn't want its subtiles
+
+        //! Totals to which this tile reports the memory it holds
+        std::shared_ptr<TerrainResidency> residency;
+
+        //! Memory held by this tile's own (not inherited) data
+        TerrainResidency::Bytes dataBytes() const;
+
+        //! Memory held by this tile's geometry
+        TerrainResidency::Bytes geometryBytes() const;
+
+        //! Set the memory held by this tile's own data, and update the residency totals.
+        //! Safe to call from a loader thread while the pager releases the tile.
+        void setDataBytes(const TerrainResidency::Bytes& bytes);
+
+        //! Set the memory held by this tile's geometry, and update the residency totals
+        void setGeometryBytes(const TerrainResidency::Bytes& bytes);
 
         //! Update this node (placeholder).
         //! @return true if any changes occur.
@@ -104,12 +124,22 @@ namespace ROCKY_NAMESPACE
     public:
         //! Customized cull traversal
         void accept(vsg::RecordTraversal& visitor) const override;
+
+        //! Same LOD selection and paging as accept(), but driven by a
+        //! headless view instead of a record traversal's Vulkan state.
+        //! The traversal is only passed through to the host's ping().
+        void traverse(const TerrainView& view, vsg::RecordTraversal& visitor) const;
         
     protected:
 
         mutable bool needsSubtiles = false;
         mutable bool needsUpdate = false;
         TerrainTileHost* host = nullptr;
+        mutable std::mutex _bytesMutex;
+        TerrainResidency::Bytes _dataBytes;
+        TerrainResidency::Bytes _geometryBytes;
+
+        virtual ~TerrainTileNode();
 
         // set the tile's render model equal to the specified parent's
         // render model, and then apply a scale bias matrix so it
@@ -118,6 +148,18 @@ namespace ROCKY_NAMESPACE
 
     private:
 
+        //! Record that the tile was visited this frame at "range" from the camera
+        void touch(const vsg::FrameStamp* fs, float range) const;
+
+        //! Whether the tile is close enough to the camera to need its subtiles
+        bool subtilesInRange(double lodDistance, double viewportHeight) const;
+
+        //! LOD selection and paging shared by accept() and traverse(): draws
+        //! either the subtiles or this tile, and pings the host so they stay resident.
+        template<class IN_RANGE, class DRAW_SUBTILES, class DRAW_SELF>
+        void selectLOD(const vsg::FrameStamp* fs, float range, bool visible, IN_RANGE&& inRange,
+            DRAW_SUBTILES&& drawSubtiles, DRAW_SELF&& drawSelf, vsg::RecordTraversal& rv) const;
+
         //! Whether child tiles are present
         inline bool subtilesExist() const
         {
@@ -9,6 +9,7 @@
 #include "../Utils.h"
 
 #include <rocky/ElevationLayer.h>
+#include <rocky/Trace.h>
 #include <rocky/ImageLayer.h>
 #include <rocky/Map.h>
 #include <rocky/TerrainTileModelFactory.h>
@@ -22,6 +23,17 @@ using namespace ROCKY_NAMESPACE;
 
 #define RP_DEBUG if(false) Log()->info
 
+namespace
+{
+    // Priority for prioritized loading and for merging: the tile's size over
+    // its distance from the camera, which is proportional to its screen-space
+    // error. Larger values go first.
+    inline float load_priority(const TerrainTileNode* tile)
+    {
+        return (float)tile->bound.r / std::max((float)tile->lastTraversalRange, 1.0f);
+    }
+}
+
 //----------------------------------------------------------------------------
 
 TerrainTilePager::TerrainTilePager(
@@ -50,6 +62,9 @@ TerrainTilePager::releaseAll()
     _loadData.clear();
     _mergeData.clear();
     _updateData.clear();
+    _loading.clear();
+    _mergeQueue.clear();
+    _uploadQueue.clear();
 }
 
 void
@@ -69,12 +84,18 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
     {
         _tracker.use(tile, info.trackerToken);
     }
+    info.lastPing = _lastUpdate;
+
+    // A tile whose data was evicted to meet a memory budget doesn't
+    // load it again until it's visible.
+    if (info.evicted && tile->lastVisibleFrame >= _lastUpdate)
+        info.evicted = false;
+
+    bool needsData = info.dataLoader.empty() && !info.evicted;
 
     // next, see if the tile needs anything.
     // "progressive" means do not load LOD N+1 until LOD N is complete.
-    // This is currently the only option.
-    const bool progressive = true;
-    if (progressive)
+    if (_settings.progressive.value())
     {
         // If this tile is fully merged, and it needs children, queue them up to load.
         if (info.dataMerger.available() && tile->needsSubtiles)
@@ -85,7 +106,7 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
         if (parent == nullptr)
         {
             // If this is a root tile, and it needs data, queue that up:
-            if (info.dataLoader.empty())
+            if (needsData)
             {
                 _loadData.emplace_back(tile->key);
             }
@@ -94,21 +115,50 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
         {
             // If this is a non-root tile that needs data, check to make sure the 
             // parent's tile is done loaded before queueing that up.
-            auto& parent_info = _tiles[parent->key];
-            if (!parent_info.tile)
+            // (find, don't insert: an insert could move "info")
+            auto parent_info = _tiles.find(parent->key);
+            if (!parent_info || !parent_info->tile)
             {
-                ROCKY_SOFT_ASSERT_AND_RETURN(parent_info.tile, void());
+                ROCKY_SOFT_ASSERT_AND_RETURN(parent_info && parent_info->tile, void());
             }
-            if (parent_info.tile && parent_info.dataMerger.available() && info.dataLoader.empty())
+            if (parent_info->dataMerger.available() && needsData)
             {
                 _loadData.push_back(tile->key);
             }
         }
     }
+    else
+    {
+        // "Skip-LOD": subdivide as soon as the view calls for it without waiting
+        // for this tile's data. New subtiles inherit whatever this tile has, which
+        // is ultimately the data of the nearest ancestor that loaded. We do wait for
+        // a load that's already running, since the subtiles copy its result.
+        bool refining = tile->needsSubtiles && tile->key.level < _settings.maxLevelOfDetail.value();
+
+        // Only load tiles that are going to be drawn, i.e. that are not being
+        // replaced by their subtiles. With several views, one may refine a tile
+        // that another draws as-is; the latter still needs its data. Root tiles
+        // always load, so there is always an ancestor to fall back on.
+        bool subtilesInUse = tile->lastSubtilesUseFrame >= _lastUpdate;
+        bool drawnAsLeaf = tile->lastLeafFrame >= _lastUpdate;
+        bool load = needsData && (parent == nullptr || drawnAsLeaf || !(refining || subtilesInUse));
+
+        // A load writes this tile's render model while new subtiles read it to
+        // inherit from, so never run the two at once: the load goes first, and
+        // the subtiles follow once it's done.
+        if (load && !info.childrenCreator.working())
+        {
+            _loadData.push_back(tile->key);
+        }
+        else if (refining && !load && !info.dataLoader.working())
+        {
+            _createChildren.push_back(tile->key);
+        }
+    }
 
     // If a data-load is complete and ready to merge, queue it up.
-    // This will only queue one merge per frame to prevent overloading
-    // the (synchronous) update cycle in VSG.
+    // The merges run in update(), within a time budget, to prevent
+    // overloading the (synchronous) update cycle in VSG.
     if (info.dataLoader.available() && info.dataMerger.empty())
     {
         _mergeData.push_back(tile->key);
@@ -147,10 +197,9 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, std::sh
     // update any tiles that asked for it
     for (auto& key : _updateData)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
+        if (auto info = _tiles.find(key))
         {
-            if (iter->second.tile->update(fs, io))
+            if (info->tile->update(fs, io))
                 changes = true;
         }
     }
@@ -159,11 +208,10 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, std::sh
     // launch any "new subtiles" requests
     for (auto& key : _createChildren)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
+        if (auto info = _tiles.find(key))
         {
-            requestCreateChildren(iter->second, engine); // parent, context
-            iter->second.tile->needsSubtiles = false;
+            requestCreateChildren(*info, engine); // parent, context
+            info->tile->needsSubtiles = false;
         }
 
         changes = true;
@@ -171,25 +219,32 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, std::sh
     _createChildren.clear();
 
     // launch any data loading requests
-    for (auto& key : _loadData)
+    if (_settings.prioritizedLoading.value())
+    {
+        updatePrioritizedLoads(io, engine);
+    }
+    else
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
+        for (auto& key : _loadData)
         {
-            requestLoadData(iter->second, io, engine);
-        }
+            if (auto info = _tiles.find(key))
+            {
+                if (requestLoadData(*info, io, engine))
+                    ++_stats.loadsRequested;
+            }
 
-        changes = true;
+            changes = true;
+        }
     }
     _loadData.clear();
 
     // schedule any data merging requests
     for (auto& key : _mergeData)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
+        if (auto info = _tiles.find(key))
         {
-            requestMergeData(iter->second, io, engine);
+            if (requestMergeData(*info, io, engine))
+                ++_stats.loadsMerged;
         }
 
         changes = true;
@@ -207,10 +262,20 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, std::sh
             if (!tile->doNotExpire)
             {
                 auto key = tile->key;
-                auto parent_iter = _tiles.find(key.createParentKey());
-                if (parent_iter != _tiles.end())
+
+                // count work thrown away with the tile
+                if (auto info = _tiles.find(key))
                 {
-                    auto parent = parent_iter->second.tile;
+                    if (info->dataLoader.working())
+                        ++_stats.loadsCanceled;
+                    else if (info->dataLoader.available() && info->dataLoader.value() && info->dataMerger.empty())
+                        ++_stats.loadsDiscarded;
+                }
+                ++_stats.tilesExpired;
+
+                if (auto parent_info = _tiles.find(key.createParentKey()))
+                {
+                    auto parent = parent_info->tile;
                     if (parent.valid())
                     {
                         // Feed the children to the garbage disposal before removing them
@@ -232,6 +297,23 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, std::sh
         _tracker.flush(~0, dispose);
     }
 
+    // stay within the memory budgets
+    enforceBudgets(engine);
+
+    // upload what we can this frame; finished uploads join the merge queue
+    if (_settings.uploadBudgetKB.value() > 0)
+    {
+        if (runUploads(engine))
+            changes = true;
+    }
+
+    // merge what we can this frame; expired tiles have canceled theirs by now
+    if (!_mergeQueue.empty())
+    {
+        runMerges();
+        changes = true;
+    }
+
     // synchronize
     _lastUpdate = fs->frameCount;
 
@@ -242,12 +324,349 @@ vsg::ref_ptr<TerrainTileNode>
 TerrainTilePager::getTile(const TileKey& key) const
 {
     std::scoped_lock lock(_mutex);
-    auto iter = _tiles.find(key);
+    auto info = _tiles.find(key);
     return
-        iter != _tiles.end() ? iter->second.tile :
+        info ? info->tile :
         vsg::ref_ptr<TerrainTileNode>(nullptr);
 }
 
+void
+TerrainTilePager::updatePrioritizedLoads(const IOOptions& io, std::shared_ptr<TerrainEngine> engine)
+{
+    // Forget loads that finished (or whose tile expired), and cancel any whose
+    // tile was not pinged last frame. If the tile comes back into use it will
+    // ask for the load again.
+    auto retire = [&](const TileKey& key)
+    {
+        auto info = _tiles.find(key);
+        if (!info || !info->dataLoader.working())
+            return true;
+
+        if (info->lastPing < _lastUpdate)
+        {
+            info->dataLoader.reset();
+            ++_stats.loadsCanceled;
+            return true;
+        }
+
+        return false;
+    };
+    _loading.erase(std::remove_if(_loading.begin(), _loading.end(), retire), _loading.end());
+
+    // Rank this frame's requests. The camera moves, so we recompute the
+    // priorities every frame rather than keeping a queue.
+    std::vector<std::pair<float, TileInfo*>> ranked;
+    ranked.reserve(_loadData.size());
+    for (auto& key : _loadData)
+    {
+        auto info = _tiles.find(key);
+        if (info && info->dataLoader.empty())
+            ranked.emplace_back(load_priority(info->tile), info);
+    }
+
+    std::sort(ranked.begin(), ranked.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    // Dispatch the most important ones, as many as the in-flight limit allows.
+    // The rest wait; they will ask again next frame if they're still needed.
+    const std::size_t maxInFlight = std::max(1u, _settings.maxLoadsInFlight.value());
+    std::size_t next = 0;
+    for (; next < ranked.size() && _loading.size() < maxInFlight; ++next)
+    {
+        auto& info = *ranked[next].second;
+        if (requestLoadData(info, io, engine))
+        {
+            ++_stats.loadsRequested;
+            _loading.emplace_back(info.tile->key);
+        }
+    }
+
+    _stats.loadsPending = ranked.size() - next;
+    _stats.loadsInFlight = _loading.size();
+}
+
+void
+TerrainTilePager::runMerges()
+{
+    // Most important first: the same measure as prioritized loading, so
+    // nearby tiles that fill the most of the screen sharpen first.
+    std::vector<std::pair<float, std::size_t>> order;
+    order.reserve(_mergeQueue.size());
+    for (std::size_t i = 0; i < _mergeQueue.size(); ++i)
+    {
+        auto tile = _mergeQueue[i].tile.ref_ptr();
+        order.emplace_back(tile ? load_priority(tile) : -FLT_MAX, i);
+    }
+
+    std::sort(order.begin(), order.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::microseconds(_settings.mergeBudgetMicros.value());
+
+    std::vector<MergeTask> leftovers;
+    bool merged = false;
+    for (auto& [priority, i] : order)
+    {
+        auto& task = _mergeQueue[i];
+
+        // abandoned (the tile expired); drop it
+        if (task.operation->canceled())
+            continue;
+
+        // always merge at least one so we never stall
+        if (merged && std::chrono::steady_clock::now() - start >= budget)
+        {
+            leftovers.emplace_back(std::move(task));
+            continue;
+        }
+
+        task.operation->run();
+        merged = true;
+    }
+
+    _mergeQueue.swap(leftovers);
+
+    auto micros = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    _stats.mergeBacklog = _mergeQueue.size();
+    _stats.mergeMicros = micros;
+    _stats.maxMergeMicros = std::max(_stats.maxMergeMicros, micros);
+}
+
+bool
+TerrainTilePager::runUploads(std::shared_ptr<TerrainEngine> engine)
+{
+    // hand the merges of completed uploads over to the merge queue
+    {
+        std::scoped_lock lock(_uploadsDone->mutex);
+        for (auto& merge : _uploadsDone->merges)
+            _mergeQueue.emplace_back(std::move(merge));
+        _uploadsDone->merges.clear();
+    }
+
+    _stats.uploadBytes = 0;
+
+    // One batch in flight at a time. While it transfers, new uploads queue up
+    // here instead of blocking this thread (or a loading thread) on a fence.
+    if (_uploadBatch.working())
+    {
+        _stats.uploadBacklog = _uploadQueue.size();
+        return true;
+    }
+
+    // drop uploads whose tiles expired
+    _uploadQueue.erase_if([](const UploadTask& task) { return task.merge.operation->canceled(); });
+
+    _stats.uploadBacklog = 0;
+
+    if (_uploadQueue.empty())
+        return false;
+
+    // Most important first, same as merging. The budget is shared with other
+    // uploads (entity textures, for example), so it may already be spent.
+    auto& budget = engine->context->uploadBudget;
+    budget.setLimit((std::uint64_t)_settings.uploadBudgetKB.value() * 1024);
+
+    auto batch = _uploadQueue.nextBatch(budget, [](const UploadTask& task)
+        {
+            auto tile = task.merge.tile.ref_ptr();
+            return tile ? load_priority(tile) : -FLT_MAX;
+        });
+
+    _stats.uploadBacklog = _uploadQueue.size();
+
+    if (batch.items.empty())
+        return true;
+
+    auto objects = vsg::Objects::create();
+    std::vector<MergeTask> merges;
+    for (auto& task : batch.items)
+    {
+        objects->addChild(task.object);
+        merges.emplace_back(std::move(task.merge));
+    }
+    auto bytes = batch.bytes;
+
+    // The batch compiles as one unit, so it records one transfer command buffer
+    // and waits on one fence, on the upload thread. Once it completes, the
+    // tiles' merges go to the merge queue for the next update to pick up.
+    auto done = _uploadsDone;
+    auto upload = [engine, objects, merges, done](Cancelable&) -> bool
+    {
+        ROCKY_TRACE_SCOPE("upload");
+
+        engine->context->compile(objects);
+
+        {
+            std::scoped_lock lock(done->mutex);
+            done->merges.insert(done->merges.end(), merges.begin(), merges.end());
+        }
+
+        engine->context->requestFrame();
+        return true;
+    };
+
+    _uploadBatch = jobs::dispatch(
+        upload,
+        jobs::context {
+            "upload " + std::to_string(merges.size()) + " tiles",
+            jobs::get_pool("rocky::terrain_uploader", 1),
+            nullptr,
+            nullptr
+        });
+
+    _stats.uploadBytes = bytes;
+    _stats.uploadBytesTotal += bytes;
+    _stats.uploadBacklog = _uploadQueue.size();
+    ++_stats.uploadBatches;
+    _stats.uploadStallsAvoided += merges.size() - 1;
+
+    return true;
+}
+
+void
+TerrainTilePager::enforceBudgets(std::shared_ptr<TerrainEngine> engine)
+{
+    const std::int64_t MB = 1048576;
+    TerrainResidency::Bytes budget{
+        (std::int64_t)_settings.cpuBudgetMB.value() * MB,
+        (std::int64_t)_settings.gpuBudgetMB.value() * MB };
+
+    if (budget.cpu == 0 && budget.gpu == 0)
+        return;
+
+    auto over = [&]() {
+        auto resident = _residency->current();
+        return
+            (budget.cpu > 0 && resident.cpu > budget.cpu) ||
+            (budget.gpu > 0 && resident.gpu > budget.gpu);
+    };
+
+    if (!over())
+        return;
+
+    // Two ways to free memory without touching anything drawn last frame:
+    // - collapse a tile whose subtiles exist but weren't drawn, releasing its
+    //   whole subtree (the tile itself stays, as the fallback);
+    // - unload the data of a leaf tile that wasn't visible, reverting it to
+    //   its parent's; it loads again once it's visible.
+    // We take the least recently visible candidates first.
+    struct Candidate
+    {
+        std::uint64_t lastVisible;
+        bool collapse;
+        TerrainTileNode* tile;
+        TileInfo* info;
+    };
+    std::vector<Candidate> candidates;
+
+    _tiles.for_each([&](const TileKey&, TileInfo& info)
+        {
+            auto tile = info.tile.get();
+            if (!tile)
+                return;
+
+            if (tile->subtilesExist())
+            {
+                if (tile->lastSubtilesUseFrame < _lastUpdate)
+                    candidates.push_back({ tile->lastVisibleFrame, true, tile, &info });
+            }
+            else if (!tile->doNotExpire && tile->lastVisibleFrame < _lastUpdate &&
+                info.dataMerger.available() && (tile->dataBytes().cpu > 0 || tile->dataBytes().gpu > 0))
+            {
+                candidates.push_back({ tile->lastVisibleFrame, false, tile, &info });
+            }
+        });
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const Candidate& lhs, const Candidate& rhs) {
+            return lhs.lastVisible != rhs.lastVisible ? lhs.lastVisible < rhs.lastVisible : lhs.collapse > rhs.collapse;
+        });
+
+    // Releases the memory of a subtree from the totals right away. The nodes
+    // themselves go through deferred disposal and would otherwise keep counting
+    // against the budget for several frames. Any data still loading is
+    // canceled first so it doesn't report bytes for a released tile.
+    std::function<void(TerrainTileNode*)> release = [&](TerrainTileNode* tile)
+        {
+            if (tile->subtilesExist())
+            {
+                for (unsigned i = 0; i < 4; ++i)
+                    release(tile->subTile(i));
+            }
+
+            auto info = _tiles.find(tile->key);
+            if (info)
+            {
+                info->dataLoader.reset();
+                info->dataMerger.reset();
+            }
+
+            tile->setDataBytes({});
+            tile->setGeometryBytes({});
+        };
+
+    for (auto& c : candidates)
+    {
+        if (!over())
+            break;
+
+        auto tile = c.tile;
+
+        if (c.collapse)
+        {
+            // an earlier collapse may have released this one already
+            if (!tile->subtilesExist())
+                continue;
+
+            for (unsigned i = 0; i < 4; ++i)
+                release(tile->subTile(i));
+
+            // same as when a tile expires: the subtiles stop getting pinged
+            // and leave the table at the next flush
+            engine->context->dispose(tile->children[1]);
+            tile->children.resize(1);
+            tile->needsSubtiles = false;
+            c.info->childrenCreator.reset();
+        }
+        else
+        {
+            // the subtiles copy their parent's data, so wait for any running load
+            auto parent_info = _tiles.find(tile->key.createParentKey());
+            if (!parent_info || !parent_info->tile || parent_info->dataLoader.working())
+                continue;
+
+            tile->setDataBytes({});
+
+            tile->inheritFrom(parent_info->tile);
+            tile->renderModel = engine->stateFactory.updateRenderModel(tile->renderModel, {}, engine->context);
+
+            for (auto command : tile->stategroup->stateCommands)
+                engine->context->dispose(command);
+            tile->stategroup->stateCommands.clear();
+            tile->stategroup->stateCommands.emplace_back(tile->renderModel.descriptors.bind);
+
+            c.info->dataLoader.reset();
+            c.info->dataMerger.reset();
+            c.info->evicted = true;
+        }
+
+        ++_stats.tilesEvicted;
+    }
+}
+
+TerrainTilePager::Stats
+TerrainTilePager::stats() const
+{
+    std::scoped_lock lock(_mutex);
+    auto stats = _stats;
+    stats.residentBytes = _residency->current();
+    stats.peakResidentBytes = _residency->peak();
+    return stats;
+}
+
 void
 TerrainTilePager::requestCreateChildren(TileInfo& info, std::shared_ptr<TerrainEngine> engine) const
 {
@@ -268,6 +687,8 @@ TerrainTilePager::requestCreateChildren(TileInfo& info, std::shared_ptr<TerrainE
         auto parent = weak_parent.ref_ptr();
         if (parent)
         {
+            ROCKY_TRACE_SCOPE_KEY("create children", parent->key);
+
             auto quad = vsg::QuadGroup::create();
 
             for (unsigned quadrant = 0; quadrant < 4; ++quadrant)
@@ -325,15 +746,15 @@ TerrainTilePager::requestCreateChildren(TileInfo& info, std::shared_ptr<TerrainE
         });
 }
 
-void
+bool
 TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::shared_ptr<TerrainEngine> engine) const
 {
-    ROCKY_SOFT_ASSERT_AND_RETURN(info.tile, void());
+    ROCKY_SOFT_ASSERT_AND_RETURN(info.tile, false);
 
     // make sure we're not already working on it
     if (info.dataLoader.working() || info.dataLoader.available())
     {
-        return;
+        return false;
     }
 
     auto key = info.tile->key;
@@ -342,15 +763,26 @@ TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::s
     //RP_DEBUG("requestLoadData -> {}", key.str());
 
     CreateTileManifest manifest;
-    const IOOptions io(in_io);
 
-    auto load = [key, tile, manifest, engine, io](Cancelable& p) -> bool
+    // tell the layers which tile this is, so they can batch it with its siblings
+    IOOptions io(in_io);
+    io.quadLoadKey = key;
+
+    // with an upload budget, the pager uploads the textures later, in batches
+    bool compile = _settings.uploadBudgetKB.value() == 0;
+    bool mipmaps = _settings.colorMipmaps.value();
+
+    auto load = [key, tile, manifest, engine, io, compile, mipmaps](Cancelable& p) -> bool
     {
         if (p.canceled())
             return false;
 
+        ROCKY_TRACE_SCOPE_KEY("load data", key);
+
         TerrainTileModelFactory factory;
         factory.compositeColorLayers = true;
+        factory.mipmapColorLayers = mipmaps;
+        factory.blockCompressionSupported = engine->context->textureCompressionBC;
 
         auto dataModel = factory.createTileModel(
             engine->map.get(),
@@ -358,15 +790,26 @@ TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::s
             manifest,
             IOOptions(io, p));
 
-        if (!dataModel.empty())
+        // the pager may have canceled us while loading
+        if (!dataModel.empty() && !p.canceled())
         {
             auto newRenderModel = engine->stateFactory.updateRenderModel(
                 tile->renderModel,
                 dataModel,
-                engine->context);
+                engine->context,
+                compile);
 
             tile->renderModel = newRenderModel;
 
+            // the textures are uploaded as-is and the images stay in memory for
+            // sampling, so the data costs the same on the CPU and the GPU
+            std::int64_t bytes = 0;
+            if (dataModel.colorLayers.size() > 0 && dataModel.colorLayers[0].image.valid())
+                bytes += dataModel.colorLayers[0].image.image()->sizeInBytesWithMipmaps();
+            if (dataModel.elevation.heightfield.valid())
+                bytes += dataModel.elevation.heightfield.heightfield()->sizeInBytes();
+            tile->setDataBytes({ bytes, bytes });
+
             engine->context->requestFrame();
 
             return true;
@@ -378,10 +821,13 @@ TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::s
     // a callback that will return the loading priority of a tile
     // we must use a WEAK pointer to allow job cancelation to work
     vsg::observer_ptr<TerrainTileNode> tile_weak(info.tile);
-    auto priority_func = [tile_weak]() -> float
+    bool prioritized = _settings.prioritizedLoading.value();
+    auto priority_func = [tile_weak, prioritized]() -> float
     {
         vsg::ref_ptr<TerrainTileNode> tile = tile_weak.ref_ptr();
-        return tile ? -(sqrt(tile->lastTraversalRange) * tile->key.level) : -FLT_MAX;
+        if (!tile)
+            return -FLT_MAX;
+        return prioritized ? load_priority(tile) : -(sqrt(tile->lastTraversalRange) * tile->key.level);
     };
 
     info.dataLoader = jobs::dispatch(
@@ -392,17 +838,19 @@ TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::s
             priority_func,
             nullptr
         } );
+
+    return true;
 }
 
-void
-TerrainTilePager::requestMergeData(TileInfo& info, const IOOptions& in_io, std::shared_ptr<TerrainEngine> engine) const
+bool
+TerrainTilePager::requestMergeData(TileInfo& info, const IOOptions& in_io, std::shared_ptr<TerrainEngine> engine)
 {
-    ROCKY_SOFT_ASSERT_AND_RETURN(info.tile, void());
+    ROCKY_SOFT_ASSERT_AND_RETURN(info.tile, false);
 
     // make sure we're not already working on it
     if (info.dataMerger.working() || info.dataMerger.available())
     {
-        return;
+        return false;
     }
 
     auto key = info.tile->key;
@@ -411,13 +859,19 @@ TerrainTilePager::requestMergeData(TileInfo& info, const IOOptions& in_io, std::
     if (info.dataLoader.value() == false)
     {
         info.dataMerger.resolve(true);
-        return;
+        return false;
     }
 
-    // operation to dispose of the old state command and replace it with a new one:
-    auto merge = [key, engine](Cancelable& c)
+    vsg::observer_ptr<TerrainTileNode> weak_tile(info.tile);
+
+    // operation to dispose of the old state command and replace it with a new one.
+    // It runs under the pager's lock, so it mustn't call back into the pager;
+    // if the tile expired, the operation will be canceled and never get here.
+    auto merge = [key, engine, weak_tile](Cancelable& c)
     {
-        auto tile = engine->tiles.getTile(key);
+        ROCKY_TRACE_SCOPE_KEY("merge", key);
+
+        auto tile = weak_tile.ref_ptr();
         if (tile)
         {
             for (auto c : tile->stategroup->stateCommands)
@@ -435,12 +889,17 @@ TerrainTilePager::requestMergeData(TileInfo& info, const IOOptions& in_io, std::
     auto merge_operation = util::PromiseOperation<bool>::create(merge);
     info.dataMerger = merge_operation->future();
 
-    vsg::observer_ptr<TerrainTileNode> weak_tile(info.tile);
-    auto priority_func = [weak_tile]() -> float
+    if (_settings.uploadBudgetKB.value() > 0)
     {
-        auto tile = weak_tile.ref_ptr();
-        return tile ? -(sqrt(tile->lastTraversalRange) * tile->key.level) : -FLT_MAX;
-    };
+        // upload the new textures first; the merge follows when that completes
+        _uploadQueue.push(
+            { info.tile->renderModel.descriptors.bind, { merge_operation, weak_tile } },
+            (std::uint64_t)std::max(std::int64_t(0), info.tile->dataBytes().gpu));
+    }
+    else
+    {
+        _mergeQueue.push_back({ merge_operation, weak_tile });
+    }
 
-    engine->context->onNextUpdate(merge_operation, priority_func);
+    return true;
 }
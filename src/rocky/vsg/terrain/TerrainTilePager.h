@@ -7,9 +7,11 @@
 
 #include <rocky/vsg/VSGContext.h>
 #include <rocky/vsg/terrain/TerrainTileNode.h>
+#include <rocky/vsg/Utils.h>
 #include <rocky/SentryTracker.h>
+#include <rocky/TileKeyMap.h>
+#include <rocky/UploadQueue.h>
 #include <chrono>
-#include <map>
 
 namespace ROCKY_NAMESPACE
 {
@@ -37,9 +39,54 @@ namespace ROCKY_NAMESPACE
             jobs::future<vsg::ref_ptr<vsg::Node>> childrenCreator;
             jobs::future<bool> dataLoader;
             jobs::future<bool> dataMerger;
+            std::uint64_t lastPing = 0; // value of _lastUpdate when last pinged
+            bool evicted = false; // data released to meet a memory budget
         };
 
-        using TileTable = std::map<TileKey, TileInfo>;
+        using TileTable = util::TileKeyMap<TileInfo>;
+
+        //! Paging counters, cumulative since the pager was created
+        //! except where noted
+        struct Stats
+        {
+            //! Data loads dispatched
+            std::uint64_t loadsRequested = 0;
+            //! Loaded data scheduled to merge into the scene
+            std::uint64_t loadsMerged = 0;
+            //! Loads still queued or running when their tile expired
+            std::uint64_t loadsCanceled = 0;
+            //! Loads that finished, but whose tile expired before the merge
+            std::uint64_t loadsDiscarded = 0;
+            //! Tiles paged out
+            std::uint64_t tilesExpired = 0;
+            //! Loads waiting for a slot after the last update (prioritized loading only)
+            std::uint64_t loadsPending = 0;
+            //! Loads queued or running after the last update (prioritized loading only)
+            std::uint64_t loadsInFlight = 0;
+            //! Merges left waiting for a later frame after the last update
+            std::uint64_t mergeBacklog = 0;
+            //! Time spent merging in the last update, in microseconds
+            std::uint64_t mergeMicros = 0;
+            //! Longest time spent merging in any one update, in microseconds
+            std::uint64_t maxMergeMicros = 0;
+            //! Tiles whose data or subtiles were released to meet a memory budget
+            std::uint64_t tilesEvicted = 0;
+            //! Memory held by terrain tiles now (not cumulative)
+            TerrainResidency::Bytes residentBytes;
+            //! Most memory held by terrain tiles at once
+            TerrainResidency::Bytes peakResidentBytes;
+            //! Texture data submitted for upload in the last update, in bytes (upload budget only)
+            std::uint64_t uploadBytes = 0;
+            //! Total texture data submitted for upload, in bytes (upload budget only)
+            std::uint64_t uploadBytesTotal = 0;
+            //! Uploads left waiting for a later frame after the last update (upload budget only)
+            std::uint64_t uploadBacklog = 0;
+            //! Upload batches submitted; each waits on a single fence (upload budget only)
+            std::uint64_t uploadBatches = 0;
+            //! Uploads that shared a batch, and therefore a fence wait, with
+            //! an earlier upload instead of stalling on their own
+            std::uint64_t uploadStallsAvoided = 0;
+        };
 
     public:
         //! Consturct the tile manager.
@@ -77,6 +124,9 @@ namespace ROCKY_NAMESPACE
         //! @return The tile, if it exists
         vsg::ref_ptr<TerrainTileNode> getTile(const TileKey& key) const;
 
+        //! Snapshot of the paging counters
+        Stats stats() const;
+
         TileTable _tiles;
         Tracker _tracker;
         std::uint64_t _lastUpdate = 0;
@@ -90,26 +140,75 @@ namespace ROCKY_NAMESPACE
         std::vector<TileKey> _loadData;
         std::vector<TileKey> _mergeData;
         std::vector<TileKey> _updateData;
+        std::vector<TileKey> _loading;
+
+        struct MergeTask
+        {
+            vsg::ref_ptr<util::PromiseOperation<bool>> operation;
+            vsg::observer_ptr<TerrainTileNode> tile;
+        };
+        std::vector<MergeTask> _mergeQueue;
+
+        struct UploadTask
+        {
+            vsg::ref_ptr<vsg::Object> object;
+            MergeTask merge;
+        };
+        util::UploadQueue<UploadTask> _uploadQueue;
+        jobs::future<bool> _uploadBatch;
+
+        // merges whose uploads completed, handed over by the upload thread
+        struct UploadsDone
+        {
+            std::mutex mutex;
+            std::vector<MergeTask> merges;
+        };
+        std::shared_ptr<UploadsDone> _uploadsDone = std::make_shared<UploadsDone>();
 
         unsigned _firstLOD = 0u;
+        Stats _stats;
+        std::shared_ptr<TerrainResidency> _residency = std::make_shared<TerrainResidency>();
 
     private:
 
+        //! Dispatches the loads in _loadData in screen-space-error order, up to
+        //! the in-flight limit, after canceling loads for tiles no longer pinged.
+        void updatePrioritizedLoads(
+            const IOOptions& io,
+            std::shared_ptr<TerrainEngine> terrain);
+
+        //! Runs queued merges, most important first, until the frame's
+        //! merge budget is spent.
+        void runMerges();
+
+        //! Collects the merges of finished uploads, and submits the next batch
+        //! of uploads, most important first, within the context's upload budget.
+        //! @return true if any uploads are pending or running
+        bool runUploads(
+            std::shared_ptr<TerrainEngine> terrain);
+
+        //! Releases the least recently visible tile memory until the
+        //! residency totals are within the CPU and GPU budgets.
+        void enforceBudgets(
+            std::shared_ptr<TerrainEngine> terrain);
+
         //! Loads the geometry for 4 new subtiles, and inherits their data models from a parent.
         void requestCreateChildren(
             TileInfo& info,
             std::shared_ptr<TerrainEngine> terrain) const;
 
         //! Loads new data for a tile that was prepped in loadSubtiles
-        void requestLoadData(
+        //! @return true if a new load was dispatched
+        bool requestLoadData(
             TileInfo& info,
             const IOOptions& io,
             std::shared_ptr<TerrainEngine> terrain) const;
 
-        //! Merges the new data model loaded in loadData.
-        void requestMergeData(
+        //! Queues a merge of the new data model loaded in loadData.
+        //! @return true if a merge was scheduled
+        bool requestMergeData(
             TileInfo& info,
             const IOOptions& io,
-            std::shared_ptr<TerrainEngine> terrain) const;
+            std::shared_ptr<TerrainEngine> terrain);
     };
 }
@@ -0,0 +1,85 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <rocky/Horizon.h>
+#include <vsg/maths/plane.h>
+#include <vsg/maths/sphere.h>
+#include <vsg/ui/FrameStamp.h>
+#include <array>
+#include <cmath>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Camera state for paging the terrain without a window or GPU
+     * (benchmarks, tools). TerrainTileNode::traverse() uses this in place
+     * of the vsg::State that a record traversal provides.
+     */
+    struct TerrainView
+    {
+        //! Camera position in world coordinates
+        vsg::dvec3 eye;
+
+        //! Unit view direction in world coordinates
+        vsg::dvec3 look;
+
+        //! World-space frustum planes (left, right, bottom, top, near), facing inward
+        std::array<vsg::dplane, 5> frustum;
+
+        //! Projection scale factor, i.e. 1/tan(fovy/2)
+        double focalLength = 1.0;
+
+        //! Height of the viewport in pixels
+        double viewportHeight = 1080.0;
+
+        //! Horizon for occlusion culling (geocentric terrain only)
+        std::shared_ptr<Horizon> horizon;
+
+        //! Current frame
+        vsg::ref_ptr<vsg::FrameStamp> frameStamp;
+
+        //! Perspective view from "eye" toward "center"
+        static TerrainView lookAt(
+            const vsg::dvec3& eye, const vsg::dvec3& center, const vsg::dvec3& up,
+            double fovyDegrees, double aspectRatio, double viewportHeight, double nearPlane = 1.0)
+        {
+            TerrainView view;
+            view.eye = eye;
+            view.look = vsg::normalize(center - eye);
+            auto right = vsg::normalize(vsg::cross(view.look, up));
+            auto realUp = vsg::cross(right, view.look);
+
+            double halfV = 0.5 * fovyDegrees * 3.14159265358979323846 / 180.0;
+            double halfH = std::atan(std::tan(halfV) * aspectRatio);
+            view.focalLength = 1.0 / std::tan(halfV);
+            view.viewportHeight = viewportHeight;
+
+            auto plane = [&](const vsg::dvec3& n, double offset) {
+                return vsg::dplane(n, -vsg::dot(n, eye) - offset);
+            };
+
+            view.frustum[0] = plane(view.look * std::sin(halfH) + right * std::cos(halfH), 0.0);
+            view.frustum[1] = plane(view.look * std::sin(halfH) - right * std::cos(halfH), 0.0);
+            view.frustum[2] = plane(view.look * std::sin(halfV) + realUp * std::cos(halfV), 0.0);
+            view.frustum[3] = plane(view.look * std::sin(halfV) - realUp * std::cos(halfV), 0.0);
+            view.frustum[4] = plane(view.look, nearPlane);
+            return view;
+        }
+
+        //! Same as vsg::State::lodDistance: the sphere's depth in view space
+        //! divided by the projection scale, or -1 if it's outside the frustum.
+        double lodDistance(const vsg::dsphere& bs) const
+        {
+            for (auto& face : frustum)
+                if (vsg::distance(face, bs.center) < -bs.radius)
+                    return -1.0;
+
+            return std::abs(vsg::dot(bs.center - eye, look)) / focalLength;
+        }
+    };
+}
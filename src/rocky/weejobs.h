@@ -8,9 +8,13 @@
 #include <atomic>
 #include <cfloat>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <type_traits>
@@ -44,6 +48,13 @@
 #define WEEJOBS_NO_DISCARD
 #endif
 
+// Coroutine support (jobs::task, co_await on a jobs::future) when compiling as C++20
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define WEEJOBS_HAS_COROUTINES 1
+#endif
+
 /**
 * weejobs is an API for scheduling a task to run in the background.
 * Please read the README.md file for more information.
@@ -302,6 +313,7 @@ namespace WEEJOBS_NAMESPACE
             std::mutex _continuation_mutex;
             std::function<void()> _continuation;
             std::atomic_bool _continuation_ran = { false };
+            std::vector<std::function<void()>> _waiters;
         };
 
     public:
@@ -444,6 +456,19 @@ namespace WEEJOBS_NAMESPACE
             return _shared.use_count();
         }
 
+        //! Calls "func" once, in the thread that resolves the promise, when the
+        //! result becomes available. Any number of these may be added. Returns
+        //! false without calling "func" if the result is already available.
+        //! Keep "func" short; to do real work, dispatch a job from it.
+        bool on_available(std::function<void()> func)
+        {
+            std::lock_guard<std::mutex> lock(_shared->_continuation_mutex);
+            if (available())
+                return false;
+            _shared->_waiters.emplace_back(std::move(func));
+            return true;
+        }
+
         //! Add a continuation to this future. The continuation will be dispatched
         //! when this object's result becomes available; that result will be the input
         //! value to the continuation function. The continuation function in turn must
@@ -468,15 +493,24 @@ namespace WEEJOBS_NAMESPACE
 
         void fire_continuation()
         {
-            std::lock_guard<std::mutex> lock(_shared->_continuation_mutex);
+            std::vector<std::function<void()>> waiters;
+            {
+                std::lock_guard<std::mutex> lock(_shared->_continuation_mutex);
+
+                if (_shared->_continuation && !_shared->_continuation_ran.exchange(true))
+                    _shared->_continuation();
 
-            if (_shared->_continuation && !_shared->_continuation_ran.exchange(true))
-                _shared->_continuation();
+                // Zero out the continuation function immediately after running it.
+                // This is important because the continuation might hold a reference to a promise
+                // that might hamper cancelation.
+                _shared->_continuation = nullptr;
 
-            // Zero out the continuation function immediately after running it.
-            // This is important because the continuation might hold a reference to a promise
-            // that might hamper cancelation.
-            _shared->_continuation = nullptr;
+                waiters.swap(_shared->_waiters);
+            }
+
+            // outside the lock, since a waiter may resume a coroutine
+            for (auto& waiter : waiters)
+                waiter();
         }
     };
 
@@ -490,6 +524,27 @@ namespace WEEJOBS_NAMESPACE
         {
             context ctx;
             std::function<bool()> _delegate;
+            float _priority = 0.0f; // cached priority, used by scheduling::heap
+            std::chrono::steady_clock::time_point _queued; // when dispatched
+            std::uint64_t _seq = 0u; // dispatch order within the pool
+
+            job() = default;
+
+            job(const context& c, const std::function<bool()>& delegate) :
+                ctx(c),
+                _delegate(delegate) { }
+
+            //! Evaluates and caches the job's priority
+            inline void update_priority()
+            {
+                _priority = ctx.priority ? ctx.priority() : 0.0f;
+            }
+
+            //! Heap ordering on the cached priority
+            static bool lower_cached_priority(const job& lhs, const job& rhs)
+            {
+                return lhs._priority < rhs._priority;
+            }
 
             bool operator < (const job& rhs) const
             {
@@ -500,8 +555,272 @@ namespace WEEJOBS_NAMESPACE
         };
 
         inline bool steal_job(class jobpool* thief, detail::job& stolen);
+
+        /**
+        * Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+        * Work-Stealing for Weak Memory Models", 2013).
+        *
+        * One thread (the owner) pushes and pops at the bottom; any other
+        * thread may steal from the top. None of the operations take a lock.
+        * The buffer grows as needed; retired buffers are kept until the
+        * deque is destroyed because a thief may still be reading one.
+        */
+        template<typename T>
+        class ws_deque
+        {
+        public:
+            ws_deque(std::int64_t capacity = 64)
+            {
+                _buffers.emplace_back(new buffer(capacity));
+                _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+            }
+
+            //! Add an item at the bottom (owner only)
+            void push(T item)
+            {
+                auto b = _bottom.load(std::memory_order_relaxed);
+                auto t = _top.load(std::memory_order_acquire);
+                auto a = _buffer.load(std::memory_order_relaxed);
+                if (b - t > a->capacity - 1)
+                {
+                    _buffers.emplace_back(a->grow(b, t));
+                    a = _buffers.back().get();
+                    _buffer.store(a, std::memory_order_release);
+                }
+                a->put(b, item);
+                std::atomic_thread_fence(std::memory_order_release);
+                _bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            //! Remove the item at the bottom (owner only)
+            bool pop(T& item)
+            {
+                auto b = _bottom.load(std::memory_order_relaxed) - 1;
+                auto a = _buffer.load(std::memory_order_relaxed);
+                _bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto t = _top.load(std::memory_order_relaxed);
+
+                bool found = false;
+                if (t <= b)
+                {
+                    item = a->get(b);
+                    found = true;
+                    if (t == b)
+                    {
+                        // last item; race against thieves for it
+                        found = _top.compare_exchange_strong(t, t + 1,
+                            std::memory_order_seq_cst, std::memory_order_relaxed);
+                        _bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                }
+                else
+                {
+                    _bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return found;
+            }
+
+            //! Remove the item at the top (any thread)
+            bool steal(T& item)
+            {
+                auto t = _top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto b = _bottom.load(std::memory_order_acquire);
+                if (t < b)
+                {
+                    auto a = _buffer.load(std::memory_order_acquire);
+                    T x = a->get(t);
+                    if (!_top.compare_exchange_strong(t, t + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed))
+                    {
+                        return false; // lost the race
+                    }
+                    item = x;
+                    return true;
+                }
+                return false;
+            }
+
+            //! Approximate number of items
+            std::int64_t size() const
+            {
+                auto b = _bottom.load(std::memory_order_relaxed);
+                auto t = _top.load(std::memory_order_relaxed);
+                return b > t ? b - t : 0;
+            }
+
+        private:
+            struct buffer
+            {
+                std::int64_t capacity;
+                std::unique_ptr<std::atomic<T>[]> items;
+
+                buffer(std::int64_t c) : capacity(c), items(new std::atomic<T>[c]) { }
+
+                T get(std::int64_t i) const {
+                    return items[i & (capacity - 1)].load(std::memory_order_relaxed);
+                }
+                void put(std::int64_t i, T x) {
+                    items[i & (capacity - 1)].store(x, std::memory_order_relaxed);
+                }
+                buffer* grow(std::int64_t b, std::int64_t t) const {
+                    auto bigger = new buffer(capacity * 2);
+                    for (auto i = t; i != b; ++i)
+                        bigger->put(i, get(i));
+                    return bigger;
+                }
+            };
+
+            std::atomic<std::int64_t> _top = { 0 };
+            std::atomic<std::int64_t> _bottom = { 0 };
+            std::atomic<buffer*> _buffer;
+            std::vector<std::unique_ptr<buffer>> _buffers; // owner only
+        };
+
+        /**
+        * A pool thread's own job deque under scheduling::stealing.
+        */
+        struct worker
+        {
+            std::atomic_bool owned = { false }; // claimed by a running thread
+            class jobpool* pool = nullptr;
+            unsigned index = 0u;
+            ws_deque<job*> deque;
+        };
+
+        //! The worker slot claimed by the calling thread, if any
+        inline worker*& this_worker()
+        {
+            static thread_local worker* w = nullptr;
+            return w;
+        }
     }
 
+    /**
+    * Histogram of durations with lock-free recording, for job latency
+    * metrics. Buckets are logarithmic with four per power of two (about
+    * 25% resolution) from one microsecond up to several days.
+    */
+    class histogram
+    {
+    public:
+        using duration = std::chrono::steady_clock::duration;
+
+        //! Add one sample
+        void record(duration value)
+        {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(value).count();
+            auto u = static_cast<std::uint64_t>(std::max(us, (decltype(us))0));
+            _buckets[bucket_of(u)].fetch_add(1u, std::memory_order_relaxed);
+            _sum_us.fetch_add(u, std::memory_order_relaxed);
+        }
+
+        //! Number of samples
+        std::uint64_t count() const
+        {
+            std::uint64_t total = 0u;
+            for (auto& b : _buckets)
+                total += b.load(std::memory_order_relaxed);
+            return total;
+        }
+
+        //! Mean of all samples
+        std::chrono::microseconds mean() const
+        {
+            auto n = count();
+            return std::chrono::microseconds(n > 0 ? _sum_us.load(std::memory_order_relaxed) / n : 0u);
+        }
+
+        //! Value below which fraction "p" (0..1) of the samples fall; this
+        //! is the upper bound of the bucket containing that sample.
+        std::chrono::microseconds percentile(double p) const
+        {
+            std::uint64_t snapshot[num_buckets];
+            std::uint64_t total = 0u;
+            for (unsigned i = 0; i < num_buckets; ++i)
+                total += (snapshot[i] = _buckets[i].load(std::memory_order_relaxed));
+
+            if (total == 0u)
+                return std::chrono::microseconds(0);
+
+            auto target = static_cast<std::uint64_t>(std::ceil(std::min(std::max(p, 0.0), 1.0) * (double)total));
+            target = std::max(target, (std::uint64_t)1u);
+
+            std::uint64_t running = 0u;
+            for (unsigned i = 0; i < num_buckets; ++i)
+            {
+                running += snapshot[i];
+                if (running >= target)
+                    return std::chrono::microseconds(upper_bound_of(i));
+            }
+            return std::chrono::microseconds(upper_bound_of(num_buckets - 1));
+        }
+
+        //! Discard all samples
+        void reset()
+        {
+            for (auto& b : _buckets)
+                b.store(0u, std::memory_order_relaxed);
+            _sum_us = 0u;
+        }
+
+    private:
+        static constexpr unsigned num_buckets = 160u;
+        std::atomic<std::uint64_t> _buckets[num_buckets] = { };
+        std::atomic<std::uint64_t> _sum_us = { 0u };
+
+        static unsigned bucket_of(std::uint64_t us)
+        {
+            if (us < 4u)
+                return (unsigned)us;
+
+            unsigned log2 = 0u;
+            for (unsigned shift = 32u; shift > 0u; shift >>= 1)
+            {
+                if (us >> (log2 + shift))
+                    log2 += shift;
+            }
+
+            unsigned sub = (unsigned)(us >> (log2 - 2u)) & 3u;
+            return std::min((log2 - 1u) * 4u + sub, num_buckets - 1u);
+        }
+
+        static std::uint64_t upper_bound_of(unsigned bucket)
+        {
+            if (bucket < 4u)
+                return bucket;
+
+            unsigned log2 = bucket / 4u + 1u;
+            std::uint64_t sub = bucket % 4u;
+            return ((5u + sub) << (log2 - 2u)) - 1u;
+        }
+    };
+
+    /**
+    * How a job pool picks the next job to run.
+    */
+    enum class scheduling
+    {
+        //! Call every queued job's priority function on each dequeue and run
+        //! the highest. Always current, but each dequeue is O(n) under the
+        //! queue lock. This is the default.
+        scan,
+
+        //! Keep the queue in a heap ordered by priorities evaluated when each
+        //! job is queued. Dequeues are O(log n). Priorities are re-evaluated
+        //! in one batch by reprioritize() (e.g. once per frame) or when the
+        //! refresh interval has elapsed.
+        heap,
+
+        //! Give each pool thread its own lock-free deque. Jobs dispatched
+        //! from a pool thread go onto that thread's deque; jobs dispatched
+        //! from elsewhere go into a shared inbox. Idle threads steal from
+        //! the others. Priorities are ignored, so use this for pools of
+        //! short, equally important jobs where dispatch overhead matters.
+        stealing
+    };
+
     /**
     * A priority-sorted collection of jobs that are running or waiting
     * to run in a thread pool.
@@ -521,6 +840,19 @@ namespace WEEJOBS_NAMESPACE
             std::atomic_uint postprocessing = { 0u };
             std::atomic_uint canceled = { 0u };
             std::atomic_uint total = { 0u };
+            std::atomic_uint peak_pending = { 0u }; // most jobs ever queued at once
+            std::atomic<std::uint64_t> completed = { 0u }; // jobs that finished running (or were canceled when they started)
+            std::atomic<std::uint64_t> reordered = { 0u }; // jobs that started before one dispatched earlier
+            histogram wait; // time from dispatch until the job starts
+            histogram execution; // time the job spends running
+
+            //! Clears the histograms and the peak queue depth
+            void reset_latency()
+            {
+                wait.reset();
+                execution.reset();
+                peak_pending = pending.load();
+            }
         };
 
     public:
@@ -565,13 +897,97 @@ namespace WEEJOBS_NAMESPACE
             _can_steal_work = value;
         }
 
+        //! Sets how this pool chooses the next job to run. Default is scheduling::scan.
+        //! Jobs already queued move over to the new mode.
+        void set_scheduling(scheduling value)
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (_scheduling != value)
+            {
+                scheduling previous;
+                {
+                    // _dispatch_delegate re-reads the mode under one of these
+                    // two locks, so once we switch nothing more gets pushed
+                    // to the old mode's queues
+                    std::lock_guard<std::mutex> inbox_lock(_inbox_mutex);
+                    previous = _scheduling.exchange(value);
+
+                    if (value == scheduling::stealing)
+                    {
+                        for (auto& job : _queue)
+                        {
+                            _inbox.push_back(new detail::job(std::move(job)));
+                        }
+                        _inbox_size = _inbox.size();
+                        _queue.clear();
+                    }
+                }
+
+                if (previous == scheduling::stealing)
+                {
+                    // pool threads hand over anything they took into
+                    // their own deques when they notice
+                    detail::job* job;
+                    while (_take_any(job, nullptr))
+                    {
+                        _queue.emplace_back(std::move(*job));
+                        delete job;
+                    }
+                }
+
+                if (value == scheduling::heap)
+                {
+                    _reprioritize();
+                }
+
+                _block.notify_all();
+            }
+        }
+
+        //! How this pool chooses the next job to run
+        scheduling get_scheduling() const
+        {
+            return _scheduling;
+        }
+
+        //! With scheduling::heap, re-evaluate all priorities automatically
+        //! when a job is taken and at least this much time has passed since
+        //! the last evaluation. Zero (the default) means only reprioritize()
+        //! refreshes them.
+        void set_priority_refresh_interval(std::chrono::steady_clock::duration value)
+        {
+            _refresh_interval = value;
+        }
+
+        //! With scheduling::heap, re-evaluates the priority of every queued
+        //! job and rebuilds the heap. Call this when the inputs to the
+        //! priority functions change, e.g. once per frame after the camera
+        //! moves. Does nothing with scheduling::scan.
+        void reprioritize()
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (_scheduling == scheduling::heap)
+            {
+                _reprioritize();
+            }
+        }
+
         //! Discard all queued jobs
         void cancel_all()
         {
             std::lock_guard<std::mutex> lock(_queue_mutex);
-            _queue.clear();
-            _metrics.canceled += _metrics.pending;
-            _metrics.pending = 0;
+            if (_scheduling == scheduling::stealing)
+            {
+                unsigned count = _discard_all();
+                _metrics.canceled += count;
+                _metrics.pending -= count;
+            }
+            else
+            {
+                _queue.clear();
+                _metrics.canceled += _metrics.pending;
+                _metrics.pending = 0;
+            }
         }
 
         //! Schedule an asynchronous task on this scheduler
@@ -590,13 +1006,16 @@ namespace WEEJOBS_NAMESPACE
 
                 if (_target_concurrency > 0)
                 {
-                    std::lock_guard<std::mutex> lock(_queue_mutex);
-
-                    _queue.emplace_back(detail::job{ context, delegate });
-
-                    _metrics.pending++;
-                    _metrics.total++;
-                    _block.notify_one();
+                    detail::job job(context, delegate);
+                    job._queued = std::chrono::steady_clock::now();
+                    job._seq = _next_seq++;
+
+                    // set_scheduling can switch modes at any time, so retry
+                    // until the push lands under the lock for the current mode
+                    bool prioritized = false;
+                    while (!(_scheduling == scheduling::stealing ?
+                        _push_stealing(job) :
+                        _push_queued(job, prioritized)));
                 }
                 else
                 {
@@ -611,16 +1030,125 @@ namespace WEEJOBS_NAMESPACE
             }
         }
 
+        //! Count one more queued job
+        inline void _queued_one()
+        {
+            auto depth = ++_metrics.pending;
+            if (depth > _metrics.peak_pending)
+            {
+                _metrics.peak_pending = depth; // approximate under contention
+            }
+            _metrics.total++;
+        }
+
+        //! Pushes a job to the calling worker's deque, or the inbox if the
+        //! caller is not one of our workers. Returns false without pushing
+        //! if the pool is no longer in scheduling::stealing.
+        inline bool _push_stealing(detail::job& job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_inbox_mutex);
+                if (_scheduling != scheduling::stealing)
+                {
+                    return false;
+                }
+
+                auto self = detail::this_worker();
+                if (self && self->pool == this)
+                {
+                    self->deque.push(new detail::job(std::move(job)));
+                }
+                else
+                {
+                    _inbox.push_back(new detail::job(std::move(job)));
+                    _inbox_size = _inbox.size();
+                }
+
+                _queued_one();
+            }
+
+            // only pay for the wakeup when a thread is actually asleep
+            if (_sleepers > 0)
+            {
+                std::lock_guard<std::mutex> lock(_queue_mutex);
+                _block.notify_one();
+            }
+            return true;
+        }
+
+        //! Pushes a job to the shared queue. Returns false without pushing
+        //! if the pool has switched to scheduling::stealing.
+        inline bool _push_queued(detail::job& job, bool& prioritized)
+        {
+            // evaluate the priority before taking the lock
+            if (_scheduling == scheduling::heap && !prioritized)
+            {
+                job.update_priority();
+                prioritized = true;
+            }
+
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (_scheduling == scheduling::stealing)
+            {
+                return false;
+            }
+
+            if (_scheduling == scheduling::heap && !prioritized)
+            {
+                job.update_priority();
+            }
+
+            _queue.emplace_back(std::move(job));
+
+            if (_scheduling == scheduling::heap)
+            {
+                std::push_heap(_queue.begin(), _queue.end(), detail::job::lower_cached_priority);
+            }
+
+            _queued_one();
+            _block.notify_one();
+            return true;
+        }
+
         //! removes the highest priority job from the queue and places it
         //! in output. Returns true if a job was taken, false if the queue
         //! was empty.
         inline bool _take_job(detail::job& output, bool lock)
         {
-            if (lock)
+            if (_scheduling == scheduling::stealing)
+            {
+                // another pool is stealing from us; no need for the queue lock
+                detail::job* job;
+                if (!_done && _take_any(job, nullptr))
+                {
+                    output = std::move(*job);
+                    delete job;
+                    _metrics.pending--;
+                    return true;
+                }
+                return false;
+            }
+            else if (lock)
             {
                 std::lock_guard<std::mutex> lock(_queue_mutex);
                 return _take_job(output, false);
             }
+            else if (!_done && !_queue.empty() && _scheduling == scheduling::heap)
+            {
+                auto interval = _refresh_interval.load();
+                if (interval.count() > 0 &&
+                    std::chrono::steady_clock::now() - _last_refresh >= interval)
+                {
+                    _reprioritize();
+                }
+
+                std::pop_heap(_queue.begin(), _queue.end(), detail::job::lower_cached_priority);
+                output = std::move(_queue.back());
+                _queue.pop_back();
+
+                _metrics.pending--;
+                return true;
+            }
             else if (!_done && !_queue.empty())
             {
                 auto ptr = _queue.end();
@@ -662,6 +1190,138 @@ namespace WEEJOBS_NAMESPACE
             _queue.reserve(256);
         }
 
+        //! Under scheduling::stealing, takes a job for the calling thread:
+        //! from its own deque, then the inbox, then the other threads' deques.
+        //! Does not touch the pending count.
+        inline bool _take_any(detail::job*& output, detail::worker* self)
+        {
+            if (self && self->deque.pop(output))
+            {
+                return true;
+            }
+
+            if (_inbox_size > 0)
+            {
+                std::lock_guard<std::mutex> lock(_inbox_mutex);
+                if (!_inbox.empty())
+                {
+                    output = _inbox.front();
+                    _inbox.pop_front();
+
+                    // take a share of the rest so the other threads can
+                    // steal from us instead of contending for the inbox
+                    if (self)
+                    {
+                        auto share = std::min(_inbox.size() / 2, (std::size_t)32);
+                        for (std::size_t i = 0; i < share; ++i)
+                        {
+                            self->deque.push(_inbox.front());
+                            _inbox.pop_front();
+                        }
+                    }
+
+                    _inbox_size = _inbox.size();
+                    return true;
+                }
+            }
+
+            unsigned count = _num_workers;
+            unsigned start = self ? self->index + 1 : 0u;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                auto victim = _workers[(start + i) % count].load(std::memory_order_acquire);
+                if (victim && victim != self && victim->deque.steal(output))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        //! Claims a free worker slot for the calling thread, creating one
+        //! if necessary. Returns nullptr if all slots are taken.
+        inline detail::worker* _claim_worker()
+        {
+            unsigned count = _num_workers;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                auto w = _workers[i].load(std::memory_order_acquire);
+                bool expected = false;
+                if (w && w->owned.compare_exchange_strong(expected, true))
+                {
+                    return (detail::this_worker() = w);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(_inbox_mutex);
+            if (_num_workers < max_workers)
+            {
+                auto w = new detail::worker();
+                w->owned = true;
+                w->pool = this;
+                w->index = _num_workers;
+                _worker_storage.emplace_back(w);
+                _workers[w->index].store(w, std::memory_order_release);
+                _num_workers++;
+                return (detail::this_worker() = w);
+            }
+            return nullptr;
+        }
+
+        //! Gives up the calling thread's worker slot. Outside of
+        //! scheduling::stealing, moves anything left in its deque
+        //! to the queue first.
+        inline void _release_worker(detail::worker* self)
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (_scheduling != scheduling::stealing)
+            {
+                detail::job* job;
+                while (self->deque.pop(job))
+                {
+                    _queue.emplace_back(std::move(*job));
+                    delete job;
+                }
+                if (_scheduling == scheduling::heap)
+                {
+                    _reprioritize();
+                }
+                _block.notify_all();
+            }
+            detail::this_worker() = nullptr;
+            self->owned = false;
+        }
+
+        //! Removes and deletes every job in the inbox and the worker deques,
+        //! releasing their groups. Returns the number removed.
+        inline unsigned _discard_all()
+        {
+            unsigned count = 0u;
+            detail::job* job;
+            while (_take_any(job, nullptr))
+            {
+                if (job->ctx.group != nullptr)
+                {
+                    job->ctx.group->release();
+                }
+                delete job;
+                ++count;
+            }
+            return count;
+        }
+
+        //! Refreshes cached priorities and rebuilds the heap (queue must be locked)
+        inline void _reprioritize()
+        {
+            for (auto& job : _queue)
+            {
+                job.update_priority();
+            }
+            std::make_heap(_queue.begin(), _queue.end(), detail::job::lower_cached_priority);
+            _last_refresh = std::chrono::steady_clock::now();
+        }
+
         //! Pulls queued jobs and runs them in whatever thread run() is called from.
         //! Runs in a loop until _done is set.
         inline void run();
@@ -677,6 +1337,9 @@ namespace WEEJOBS_NAMESPACE
 
         bool _can_steal_work = true;
         std::vector<detail::job> _queue;
+        std::atomic<scheduling> _scheduling = { scheduling::scan };
+        std::atomic<std::chrono::steady_clock::duration> _refresh_interval = { std::chrono::steady_clock::duration(0) };
+        std::chrono::steady_clock::time_point _last_refresh;
         mutable std::mutex _queue_mutex; // protect access to the queue
         mutable std::mutex _quit_mutex; // protects access to _done
         std::atomic<unsigned> _target_concurrency; // target number of concurrent threads in the pool
@@ -684,6 +1347,20 @@ namespace WEEJOBS_NAMESPACE
         bool _done = false; // set to true when threads should exit
         std::vector<std::thread> _threads; // threads in the pool
         metrics_t _metrics; // metrics for this pool
+
+        // scheduling::stealing
+        static constexpr unsigned max_workers = 256u;
+        std::deque<detail::job*> _inbox; // jobs dispatched from outside the pool
+        std::atomic<std::size_t> _inbox_size = { 0u };
+        std::mutex _inbox_mutex; // protects _inbox and _worker_storage
+        std::atomic<detail::worker*> _workers[max_workers] = { }; // slots visible to thieves
+        std::atomic<unsigned> _num_workers = { 0u };
+        std::vector<std::unique_ptr<detail::worker>> _worker_storage;
+        std::atomic<unsigned> _sleepers = { 0u }; // threads waiting on _block
+
+        // metrics
+        std::atomic<std::uint64_t> _next_seq = { 0u };
+        std::atomic<std::uint64_t> _last_seq = { 0u };
     };
 
     class metrics
@@ -906,18 +1583,71 @@ namespace WEEJOBS_NAMESPACE
 
     inline void jobpool::run()
     {
+        detail::worker* self = nullptr;
+        unsigned idle = 0u;
+
         while (!_done)
         {
             detail::job next;
             bool have_next = false;
+            bool foreign = false; // stolen from another pool
             {
-                if (_can_steal_work && instance()._stealing_allowed)
+                if (_scheduling == scheduling::stealing)
+                {
+                    if (!self)
+                    {
+                        self = _claim_worker();
+                    }
+
+                    detail::job* job;
+                    if (_take_any(job, self))
+                    {
+                        next = std::move(*job);
+                        delete job;
+                        _metrics.pending--;
+                        have_next = true;
+                    }
+                    else if (_can_steal_work && instance()._stealing_allowed)
+                    {
+                        have_next = foreign = detail::steal_job(this, next);
+                    }
+
+                    if (have_next)
+                    {
+                        idle = 0u;
+                    }
+                    else if (++idle < 64u)
+                    {
+                        // new work usually shows up soon; stay awake a little while
+                        std::this_thread::yield();
+                    }
+                    else
+                    {
+                        std::unique_lock<std::mutex> lock(_queue_mutex);
+                        _sleepers++;
+                        _block.wait(lock, [this]() {
+                            return
+                                _metrics.pending > 0 || _done ||
+                                _scheduling != scheduling::stealing ||
+                                (_can_steal_work && instance()._stealing_allowed && get_metrics()->total_pending() > 0);
+                            });
+                        _sleepers--;
+                        idle = 0u;
+                    }
+                }
+                else if (self)
+                {
+                    // left scheduling::stealing
+                    _release_worker(self);
+                    self = nullptr;
+                }
+                else if (_can_steal_work && instance()._stealing_allowed)
                 {
                     {
                         std::unique_lock<std::mutex> lock(_queue_mutex);
 
                         // work-stealing enabled: wait until any queue is non-empty
-                        _block.wait(lock, [this]() { return get_metrics()->total_pending() > 0 || _done; });
+                        _block.wait(lock, [this]() { return get_metrics()->total_pending() > 0 || _done || _scheduling == scheduling::stealing; });
 
                         if (!_done && !_queue.empty())
                         {
@@ -927,7 +1657,7 @@ namespace WEEJOBS_NAMESPACE
 
                     if (!_done && !have_next)
                     {
-                        have_next = detail::steal_job(this, next);
+                        have_next = foreign = detail::steal_job(this, next);
                     }
                 }
                 else
@@ -935,7 +1665,7 @@ namespace WEEJOBS_NAMESPACE
                     std::unique_lock<std::mutex> lock(_queue_mutex);
 
                     // wait until just our local queue is non-empty
-                    _block.wait(lock, [this] { return !_queue.empty() || _done; });
+                    _block.wait(lock, [this] { return !_queue.empty() || _done || _scheduling == scheduling::stealing; });
 
                     if (!_done && !_queue.empty())
                     {
@@ -950,10 +1680,20 @@ namespace WEEJOBS_NAMESPACE
 
                 auto t0 = std::chrono::steady_clock::now();
 
+                _metrics.wait.record(t0 - next._queued);
+
+                if (!foreign && next._seq < _last_seq.exchange(next._seq))
+                {
+                    _metrics.reordered++;
+                }
+
                 bool job_executed = next._delegate();
 
                 auto duration = std::chrono::steady_clock::now() - t0;
 
+                _metrics.execution.record(duration);
+                _metrics.completed++;
+
                 if (job_executed == false)
                 {
                     _metrics.canceled++;
@@ -970,14 +1710,22 @@ namespace WEEJOBS_NAMESPACE
 
             // See if we no longer need this thread because the
             // target concurrency has been reduced
-            std::lock_guard<std::mutex> lock(_quit_mutex);
-
             if (_target_concurrency < _metrics.concurrency)
             {
-                _metrics.concurrency--;
-                break;
+                std::lock_guard<std::mutex> lock(_quit_mutex);
+
+                if (_target_concurrency < _metrics.concurrency)
+                {
+                    _metrics.concurrency--;
+                    break;
+                }
             }
         }
+
+        if (self)
+        {
+            _release_worker(self);
+        }
     }
 
     inline void jobpool::start_threads()
@@ -1019,6 +1767,8 @@ namespace WEEJOBS_NAMESPACE
         }
         _queue.clear();
 
+        _discard_all();
+
         // wake up all threads so they can exit
         _block.notify_all();
     }
@@ -1050,9 +1800,9 @@ namespace WEEJOBS_NAMESPACE
             {
                 if (pool != thief)
                 {
-                    if (static_cast<std::size_t>(pool->_queue.size()) > max_num_jobs)
+                    if (static_cast<std::size_t>(pool->_metrics.pending) > max_num_jobs)
                     {
-                        max_num_jobs = pool->_queue.size();
+                        max_num_jobs = pool->_metrics.pending;
                         pool_with_most_jobs = pool;
                     }
                 }
@@ -1205,6 +1955,176 @@ namespace WEEJOBS_NAMESPACE
         }
     }
 
+#ifdef WEEJOBS_HAS_COROUTINES
+
+    namespace detail
+    {
+        // Suspends a coroutine until a future's result is available. With a
+        // pool in the context, the coroutine resumes as a job in that pool;
+        // otherwise it resumes in the thread that resolved the future.
+        template<typename T>
+        struct future_awaiter
+        {
+            future<T> _future;
+            context _context;
+
+            bool await_ready() const
+            {
+                return _future.available();
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                auto con = _context;
+                return _future.on_available([handle, con]()
+                    {
+                        if (con.pool)
+                            dispatch([handle]() { handle.resume(); }, con);
+                        else
+                            handle.resume();
+                    });
+            }
+
+            T await_resume() const
+            {
+                return _future.value();
+            }
+        };
+
+        // Moves a coroutine into a job pool.
+        struct resume_on_awaiter
+        {
+            context _context;
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                dispatch([handle]() { handle.resume(); }, _context);
+            }
+
+            void await_resume() const { }
+        };
+
+        struct canceled_t { };
+
+        struct canceled_awaiter
+        {
+            bool _canceled;
+            bool await_ready() const { return true; }
+            void await_suspend(std::coroutine_handle<>) { }
+            bool await_resume() const { return _canceled; }
+        };
+    }
+
+    //! Inside a jobs::task, co_await task_canceled returns true if nothing
+    //! is waiting for the task's result anymore.
+    constexpr detail::canceled_t task_canceled{};
+
+    //! co_await on a future suspends the coroutine until the result is
+    //! available, without occupying a thread, and returns a copy of it.
+    template<typename T>
+    inline detail::future_awaiter<T> operator co_await(const future<T>& f)
+    {
+        return detail::future_awaiter<T>{ f, {} };
+    }
+
+    //! co_await resume_on(...) moves the calling jobs::task into a job pool.
+    //! Futures awaited later in the same task also resume in that pool.
+    inline detail::resume_on_awaiter resume_on(const context& con)
+    {
+        return detail::resume_on_awaiter{ con };
+    }
+
+    //! co_await resume_on(pool) moves the calling jobs::task into a job pool.
+    inline detail::resume_on_awaiter resume_on(jobpool* pool)
+    {
+        context con;
+        con.pool = pool;
+        return detail::resume_on_awaiter{ con };
+    }
+
+    /**
+    * Coroutine that runs as a series of jobs and resolves a future with its
+    * co_return value. The task starts in the calling thread; use
+    * co_await resume_on(pool) to move it into a pool. A task waiting on a
+    * future (co_await) holds no thread while it waits.
+    *
+    *   jobs::task<int> load(jobs::jobpool* pool) {
+    *       co_await jobs::resume_on(pool);
+    *       auto bytes = co_await fetch();    // a jobs::future
+    *       co_return decode(bytes);
+    *   }
+    *   jobs::future<int> result = load(pool);
+    *
+    * If every copy of the result future goes away, the task is canceled and
+    * co_await task_canceled returns true; the task should then co_return.
+    * A task waiting on a future that is never resolved is never destroyed.
+    */
+    template<typename T>
+    class task
+    {
+    public:
+        struct promise_type
+        {
+            future<T> _result;
+            context _context;
+
+            task get_return_object() { return task(_result); }
+
+            std::suspend_never initial_suspend() noexcept { return {}; }
+
+            std::suspend_never final_suspend() noexcept { return {}; }
+
+            void return_value(const T& value) { _result.resolve(value); }
+
+            void return_value(T&& value) { _result.resolve(std::move(value)); }
+
+            void unhandled_exception() { throw; }
+
+            //! remember the pool so later co_awaits resume there
+            detail::resume_on_awaiter await_transform(detail::resume_on_awaiter a)
+            {
+                _context = a._context;
+                return a;
+            }
+
+            detail::canceled_awaiter await_transform(detail::canceled_t)
+            {
+                return detail::canceled_awaiter{ _result.canceled() };
+            }
+
+            template<typename U>
+            detail::future_awaiter<U> await_transform(const future<U>& f)
+            {
+                return detail::future_awaiter<U>{ f, _context };
+            }
+
+            template<typename A>
+            A&& await_transform(A&& a)
+            {
+                return std::forward<A>(a);
+            }
+        };
+
+        //! The future result of this task
+        const future<T>& result() const
+        {
+            return _result;
+        }
+
+        operator future<T>() const
+        {
+            return _result;
+        }
+
+    private:
+        task(const future<T>& result) : _result(result) { }
+        future<T> _result;
+    };
+
+#endif // WEEJOBS_HAS_COROUTINES
+
     //! Total number of pending jobs across all schedulers
     inline int metrics::total_pending() const
     {
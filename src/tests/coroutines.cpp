@@ -0,0 +1,97 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+// weejobs coroutine support (jobs::task) needs C++20, while rocky and its
+// main test suite build as C++17. These tests build on their own, as C++20,
+// against the weejobs header alone.
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <rocky/weejobs.h>
+#include <atomic>
+
+#ifndef WEEJOBS_HAS_COROUTINES
+#error "weejobs coroutine support requires a C++20 compiler with coroutines"
+#endif
+
+WEEJOBS_INSTANCE;
+
+TEST_CASE("Coroutines")
+{
+    auto io = jobs::get_pool("rocky.tests.io", 8);
+    auto cpu = jobs::get_pool("rocky.tests.cpu", 1);
+
+    auto fetch = [io](int i) {
+        return jobs::dispatch([i](jobs::cancelable&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return i; }, jobs::context{ "fetch", io });
+        };
+
+    SECTION("Chained waits")
+    {
+        // two waits per task; the single cpu thread is never blocked by them
+        auto load = [&](int i) -> jobs::task<int> {
+            co_await jobs::resume_on(cpu);
+            int a = co_await fetch(i);
+            int b = co_await fetch(a * 2);
+            co_return a + b;
+            };
+
+        std::vector<jobs::future<int>> results;
+        for (int i = 0; i < 16; ++i)
+            results.emplace_back(load(i));
+
+        int sum = 0;
+        for (auto& r : results)
+            sum += r.join();
+        CHECK(sum == 3 * 120);
+    }
+
+    SECTION("Ready future")
+    {
+        // awaiting a future that's already resolved doesn't suspend
+        jobs::future<int> ready;
+        ready.resolve(7);
+
+        auto caller = std::this_thread::get_id();
+        std::thread::id ranOn;
+        auto add = [&]() -> jobs::task<int> {
+            int v = co_await ready;
+            ranOn = std::this_thread::get_id();
+            co_return v + 1;
+            };
+
+        jobs::future<int> result = add();
+        CHECK(result.available());
+        CHECK(result.value() == 8);
+        CHECK(ranOn == caller);
+    }
+
+    SECTION("Canceled")
+    {
+        jobs::future<int> gate;
+        std::atomic_int observed = { -1 };
+
+        auto work = [&]() -> jobs::task<int> {
+            co_await gate;
+            observed = (co_await jobs::task_canceled) ? 1 : 0;
+            co_return 0;
+            };
+
+        // nothing holds the result, so the task sees that it was canceled
+        work();
+        gate.resolve(1);
+        CHECK(observed == 1);
+
+        // while someone holds the result, it runs to completion
+        gate = {};
+        observed = -1;
+        jobs::future<int> result = work();
+        gate.resolve(1);
+        CHECK(observed == 0);
+        CHECK(result.available());
+    }
+}
@@ -2,11 +2,20 @@
 #include "catch.hpp"
 
 #include <rocky/rocky.h>
+#include <rocky/BlockCompressor.h>
+#include <rocky/MBTiles.h>
+#include <rocky/TerrainTileModelFactory.h>
+#include <rocky/UploadQueue.h>
+#include <filesystem>
 #include <random>
 
 #define ROCKY_EXPOSE_JSON_FUNCTIONS
 #include <rocky/json.h>
 
+#ifdef ROCKY_HAS_HTTPLIB
+#include <httplib.h>
+#endif
+
 using namespace ROCKY_NAMESPACE;
 
 namespace
@@ -18,6 +27,39 @@ namespace
             return StatusOK;
         }
     };
+
+    // Elevation layer that counts how often it generates a tile, and can hold
+    // generation open until a test releases the gate.
+    class CountingElevationLayer : public Inherit<ElevationLayer, CountingElevationLayer>
+    {
+    public:
+        mutable std::atomic_int calls = { 0 };
+        std::shared_future<void> gate;
+
+        Status openImplementation(const IOOptions& io) override {
+            auto r = super::openImplementation(io);
+            if (r.ok())
+                profile = Profile("global-geodetic");
+            return r;
+        }
+
+    protected:
+        Result<GeoHeightfield> createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const override {
+            ++calls;
+            if (gate.valid())
+                gate.wait();
+            auto hf = Heightfield::create(17, 17);
+            hf->fill(100.0f);
+            hf->heightAt(0, 0) = NO_DATA_VALUE;
+            return GeoHeightfield(hf, key.extent());
+        }
+    };
+
+    struct CancelFlag : public Cancelable
+    {
+        std::atomic_bool value = { false };
+        bool canceled() const override { return value; }
+    };
 }
 
 TEST_CASE("json")
@@ -89,6 +131,48 @@ TEST_CASE("TileKey")
     CHECK(TileKey(2, 0, 0, p).quadKey() == "000");
     CHECK(TileKey(2, 1, 0, p).quadKey() == "001");
     CHECK(TileKey(2, 5, 1, p).quadKey() == "103");
+
+    // packed IDs match exactly when the keys do
+    Profile p2("global-geodetic");
+    Profile m("spherical-mercator");
+    CHECK(TileKey(5, 7, 3, p).id() == TileKey(5, 7, 3, p2).id());
+    CHECK(TileKey(5, 7, 3, p).id() != TileKey(5, 3, 7, p).id());
+    CHECK(TileKey(5, 7, 3, p).id() != TileKey(4, 7, 3, p).id());
+    CHECK(TileKey(5, 7, 3, p).id() != TileKey(5, 7, 3, m).id());
+
+    SECTION("TileKeyMap")
+    {
+        util::TileKeyMap<int> table;
+        for (unsigned i = 0; i < 1000; ++i)
+            table[TileKey(8, i % 64, i / 64, p)] = (int)i;
+        CHECK(table.size() == 1000);
+        CHECK(table.find(TileKey(8, 5, 2, p2)) != nullptr);
+        CHECK(*table.find(TileKey(8, 5, 2, p2)) == 133);
+        CHECK(table.find(TileKey(8, 5, 2, m)) == nullptr);
+
+        // erasing must not lose entries that probed past the erased ones
+        for (unsigned i = 0; i < 1000; i += 2)
+            CHECK(table.erase(TileKey(8, i % 64, i / 64, p)));
+        CHECK(table.size() == 500);
+        bool allFound = true;
+        for (unsigned i = 1; i < 1000; i += 2)
+            allFound = allFound && table.find(TileKey(8, i % 64, i / 64, p)) && *table.find(TileKey(8, i % 64, i / 64, p)) == (int)i;
+        CHECK(allFound);
+
+        CHECK(table.erase_if([](const TileKey& key, int) { return key.x < 32; }) == 256);
+        CHECK(table.size() == 244);
+
+        // keys past the id's 26-bit x range share an id but stay distinct
+        TileKey deep(27, 5, 0, p), alias(27, 5 + (1u << 26), 0, p);
+        CHECK(deep.id() == alias.id());
+        table[deep] = -1;
+        table[alias] = -2;
+        CHECK(*table.find(deep) == -1);
+        CHECK(*table.find(alias) == -2);
+        CHECK(table.erase(deep));
+        CHECK(table.find(deep) == nullptr);
+        CHECK(*table.find(alias) == -2);
+    }
 }
 
 TEST_CASE("Threading")
@@ -110,6 +194,319 @@ TEST_CASE("Threading")
     CHECK(f2.empty() == false);
     CHECK(f2.available() == true);
     CHECK(f2.value() == 123);
+
+    SECTION("SingleFlight")
+    {
+        util::SingleFlight<std::string, int> flights;
+        std::atomic_int calls = { 0 };
+        std::vector<std::thread> threads;
+        std::vector<int> results(8);
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&, i]()
+                {
+                    auto r = flights.run("key", [&]() -> std::optional<int>
+                        {
+                            ++calls;
+                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                            return 42;
+                        });
+                    results[i] = r.value_or(0);
+                });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        CHECK(calls == 1);
+        CHECK(std::count(results.begin(), results.end(), 42) == 8);
+        CHECK(flights.size() == 0);
+    }
+
+    SECTION("Heap scheduling")
+    {
+        auto pool = jobs::get_pool("rocky.tests.heap", 1);
+        pool->set_scheduling(jobs::scheduling::heap);
+
+        // hold the only thread while the jobs are queued
+        std::promise<void> gate;
+        auto open = gate.get_future().share();
+        jobs::dispatch([open]() { open.wait(); }, jobs::context{ "gate", pool });
+        while (pool->metrics()->running == 0)
+            std::this_thread::yield();
+
+        std::vector<float> priorities = { 3, 9, 1, 7, 5 };
+        std::vector<float> order;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<float>> inputs;
+        auto group = jobs::jobgroup::create();
+        for (auto p : priorities)
+        {
+            auto priority = inputs.emplace_back(std::make_shared<float>(p));
+            jobs::dispatch([&, p]() { std::scoped_lock lock(mutex); order.push_back(p); },
+                jobs::context{ "job", pool, [priority]() { return *priority; }, group });
+        }
+
+        // priorities are cached until the next reprioritize()
+        *inputs[2] = 10.0f;
+        pool->reprioritize();
+
+        gate.set_value();
+        group->join();
+        CHECK(order == std::vector<float>{ 1, 9, 7, 5, 3 });
+    }
+
+    SECTION("Work stealing")
+    {
+        auto pool = jobs::get_pool("rocky.tests.stealing", 4);
+        pool->set_scheduling(jobs::scheduling::stealing);
+
+        // jobs that dispatch more jobs from inside the pool
+        std::atomic<int> count = { 0 };
+        auto group = jobs::jobgroup::create();
+        std::function<void(int)> node = [&](int depth)
+            {
+                count++;
+                if (depth > 0)
+                {
+                    for (int i = 0; i < 2; ++i)
+                        jobs::dispatch([&node, depth]() { node(depth - 1); }, jobs::context{ "node", pool, {}, group });
+                }
+            };
+        jobs::dispatch([&]() { node(10); }, jobs::context{ "root", pool, {}, group });
+        group->join();
+        CHECK(count == 2047);
+
+        std::vector<jobs::future<int>> results;
+        for (int i = 0; i < 100; ++i)
+            results.emplace_back(jobs::dispatch([i](jobs::cancelable&) { return i * 2; }, jobs::context{ "future", pool }));
+        int sum = 0;
+        for (auto& r : results)
+            sum += r.join();
+        CHECK(sum == 9900);
+        CHECK(pool->metrics()->pending == 0);
+    }
+
+    SECTION("Switching scheduling")
+    {
+        auto pool = jobs::get_pool("rocky.tests.switching", 4);
+
+        // dispatch from outside and inside the pool while the mode flips
+        std::atomic<int> count = { 0 };
+        std::atomic<bool> dispatching = { true };
+        auto group = jobs::jobgroup::create();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]()
+                {
+                    for (int i = 0; i < 2000; ++i)
+                    {
+                        jobs::dispatch([&]()
+                            {
+                                count++;
+                                jobs::dispatch([&]() { count++; }, jobs::context{ "inner", pool, {}, group });
+                            },
+                            jobs::context{ "outer", pool, {}, group });
+                    }
+                });
+        }
+
+        std::thread switcher([&]()
+            {
+                jobs::scheduling modes[] = { jobs::scheduling::stealing, jobs::scheduling::scan, jobs::scheduling::heap };
+                for (int i = 0; dispatching; ++i)
+                {
+                    pool->set_scheduling(modes[i % 3]);
+                    std::this_thread::yield();
+                }
+            });
+
+        for (auto& t : threads)
+            t.join();
+        dispatching = false;
+        switcher.join();
+
+        group->join();
+        CHECK(count == 16000);
+        CHECK(pool->metrics()->pending == 0);
+    }
+
+    SECTION("Latency metrics")
+    {
+        jobs::histogram h;
+        for (int i = 1; i <= 1000; ++i)
+            h.record(std::chrono::microseconds(i));
+        CHECK(h.count() == 1000);
+        CHECK(h.mean().count() == 500);
+        CHECK(h.percentile(0.5).count() >= 500);
+        CHECK(h.percentile(0.5).count() < 625); // within a bucket
+        CHECK(h.percentile(1.0).count() >= 1000);
+
+        auto pool = jobs::get_pool("rocky.tests.metrics", 1);
+        auto group = jobs::jobgroup::create();
+        for (int i = 0; i < 10; ++i)
+            jobs::dispatch([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }, jobs::context{ "job", pool, {}, group });
+        group->join();
+
+        auto m = pool->metrics();
+        CHECK(m->completed == 10);
+        CHECK(m->execution.count() == 10);
+        CHECK(m->execution.percentile(0.5) >= std::chrono::milliseconds(1));
+        CHECK(m->peak_pending >= 1);
+    }
+}
+
+TEST_CASE("LRUCache")
+{
+    struct StringCost {
+        std::size_t operator()(const std::string& s) const { return s.size(); }
+    };
+
+    // single shard so eviction order is deterministic
+    util::LRUCache<int, std::string, StringCost> cache(30, 1);
+    cache.put(1, std::string(10, 'a'));
+    cache.put(2, std::string(10, 'b'));
+    cache.put(3, std::string(10, 'c'));
+    CHECK(cache.stats().cost == 30);
+
+    // touch 1 so it survives the next eviction
+    CHECK(cache.get(1) == std::string(10, 'a'));
+    cache.put(4, std::string(10, 'd'));
+    CHECK(cache.get(2).empty());
+    CHECK(cache.get(1).empty() == false);
+
+    // an entry larger than the budget evicts everything else
+    cache.put(5, std::string(40, 'e'));
+    auto stats = cache.stats();
+    CHECK(stats.entries == 1);
+    CHECK(stats.cost == 40);
+    CHECK(stats.gets == 3);
+    CHECK(stats.hits == 2);
+    CHECK(stats.evictions == 4);
+
+    cache.setCapacity(0);
+    cache.put(6, "x");
+    CHECK(cache.get(6).empty());
+
+    // resizing while other threads read and write keeps the accounting whole
+    util::LRUCache<int, std::string, StringCost> shared(1000, 8);
+    std::atomic_bool done = { false };
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            for (int i = 0; !done; ++i) {
+                shared.put(t * 100000 + (i % 5000), std::string(8, 'x'));
+                shared.get(t * 100000 + ((i * 7) % 5000));
+            } });
+    }
+    for (int i = 0; i < 200; ++i)
+        shared.setCapacity(i % 2 ? 1000 : 0);
+    done = true;
+    for (auto& w : writers)
+        w.join();
+
+    CHECK(shared.capacity() == 1000);
+    shared.setCapacity(1000);
+    stats = shared.stats();
+    CHECK(stats.cost == 0);
+    CHECK(stats.entries == 0);
+}
+
+TEST_CASE("UploadQueue")
+{
+    util::UploadBudget budget;
+    budget.setLimit(1000);
+
+    SECTION("Budget")
+    {
+        CHECK(budget.tryClaim(600));
+        CHECK(budget.tryClaim(600) == false);
+        CHECK(budget.tryClaim(400));
+        CHECK(budget.available() == 0);
+
+        // the first claim of a frame always succeeds, however large
+        budget.nextFrame();
+        CHECK(budget.available() == 1000);
+        CHECK(budget.tryClaim(5000));
+        CHECK(budget.tryClaim(1) == false);
+
+        // a waiting claim goes through once the next frame starts
+        std::thread frame([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            budget.nextFrame(); });
+        CHECK(budget.claim(800, std::chrono::milliseconds(5000)));
+        frame.join();
+        CHECK(budget.claimed() == 800);
+        CHECK(budget.claim(800, std::chrono::milliseconds(10)) == false);
+
+        budget.setLimit(0);
+        CHECK(budget.tryClaim(1000000));
+    }
+
+    SECTION("Batching")
+    {
+        // priority is the item itself
+        util::UploadQueue<int> queue;
+        queue.push(1, 300);
+        queue.push(5, 300);
+        queue.push(3, 600);
+        queue.push(4, 300);
+        queue.push(2, 100);
+        auto priority = [](int i) { return (float)i; };
+
+        // most important first, stopping at the first upload that doesn't fit
+        // (2 would fit, but it must not jump ahead of 3)
+        auto batch = queue.nextBatch(budget, priority);
+        CHECK((batch.items == std::vector<int>{ 5, 4 }));
+        CHECK(batch.bytes == 600);
+        CHECK(queue.size() == 3);
+
+        // nothing more this frame
+        batch = queue.nextBatch(budget, priority);
+        CHECK(batch.items.empty());
+        CHECK(queue.size() == 3);
+
+        budget.nextFrame();
+        batch = queue.nextBatch(budget, priority);
+        CHECK((batch.items == std::vector<int>{ 3, 2, 1 }));
+        CHECK(batch.bytes == 1000);
+        CHECK(queue.empty());
+
+        // an upload larger than the budget still goes, alone, as the frame's first
+        budget.nextFrame();
+        queue.push(7, 4000);
+        queue.push(6, 10);
+        batch = queue.nextBatch(budget, priority);
+        CHECK((batch.items == std::vector<int>{ 7 }));
+        CHECK(queue.size() == 1);
+    }
+
+    SECTION("Shared budget")
+    {
+        util::UploadQueue<int> queue;
+        for (int i = 0; i < 10; ++i)
+            queue.push(i, 100);
+        auto priority = [](int i) { return (float)i; };
+
+        // another uploader (entity textures, say) spent most of the frame's budget
+        CHECK(budget.tryClaim(700));
+        auto batch = queue.nextBatch(budget, priority);
+        CHECK((batch.items == std::vector<int>{ 9, 8, 7 }));
+
+        // and when it spends all of it, the queue waits for the next frame
+        budget.nextFrame();
+        CHECK(budget.tryClaim(1000));
+        CHECK(queue.nextBatch(budget, priority).items.empty());
+        CHECK(queue.size() == 7);
+
+        // expired uploads are dropped
+        auto even = [](int i) { return i % 2 == 0; };
+        CHECK(queue.erase_if(even) == 4);
+        budget.nextFrame();
+        batch = queue.nextBatch(budget, priority);
+        CHECK((batch.items == std::vector<int>{ 5, 3, 1 }));
+    }
 }
 
 TEST_CASE("Math")
@@ -200,6 +597,129 @@ TEST_CASE("Image")
     CHECK(equiv(value.g, 0.5f, 0.01f));
     CHECK(equiv(value.b, 0.0f, 0.01f));
     CHECK(equiv(value.a, 1.0f, 0.01f));
+
+    SECTION("Mipmaps")
+    {
+        // 5x4 -> 2x2 -> 1x1; the odd column drops out of the box filter
+        image = Image::create(Image::R8_UNORM, 5, 4);
+        for (unsigned t = 0; t < 4; ++t)
+            for (unsigned s = 0; s < 5; ++s)
+                image->value<unsigned char>(s, t) = (unsigned char)(s * 10 + t * 40);
+
+        auto mipmapped = image->generateMipmaps();
+        REQUIRE(mipmapped);
+        CHECK(image->mipLevels() == 1);
+        CHECK(mipmapped->mipLevels() == 3);
+        CHECK(mipmapped->sizeInBytes() == 20);
+        CHECK(mipmapped->sizeInBytesWithMipmaps() == 25);
+        CHECK(mipmapped->mipmapWidth(1) == 2);
+        CHECK(mipmapped->mipmapHeight(2) == 1);
+        CHECK(mipmapped->value<unsigned char>(2, 1) == 60);
+
+        auto level1 = mipmapped->mipmapData<unsigned char>(1);
+        CHECK(level1[0] == 25);
+        CHECK(level1[1] == 45);
+        CHECK(level1[2] == 105);
+        CHECK(level1[3] == 125);
+        CHECK(mipmapped->mipmapData<unsigned char>(2)[0] == 75);
+
+        auto copy = mipmapped->clone();
+        REQUIRE(copy);
+        CHECK(copy->mipLevels() == 3);
+        CHECK(copy->mipmapData<unsigned char>(2)[0] == 75);
+    }
+
+    SECTION("Block compression")
+    {
+        image = Image::create(Image::R8G8B8A8_UNORM, 256, 256);
+        image->fill(Image::Pixel(0.8f, 0.4f, 0.2f, 0.5f));
+        auto mipmapped = image->generateMipmaps();
+        REQUIRE(mipmapped);
+        CHECK(mipmapped->mipLevels() == 9);
+        CHECK(util::BlockCompressor::chooseFormat(*image) == Image::BC7_UNORM);
+
+        util::BlockCompressor compressor;
+        compressor.format = Image::BC1_RGB_UNORM;
+        auto bc1 = compressor.compress(*mipmapped);
+        REQUIRE(bc1);
+        CHECK(bc1->isCompressed());
+        CHECK(bc1->sizeInBytes() == 32768);
+        CHECK(bc1->rowSizeInBytes() == 512);
+        CHECK(bc1->mipLevels() == 7); // stops at the 4x4 level
+        CHECK(bc1->mipmapWidth(6) == 4);
+
+        // 5:6:5 color, no alpha
+        Image::Pixel pixel;
+        bc1->read(pixel, 100, 37);
+        CHECK(pixel.r == Approx(0.8f).margin(0.02f));
+        CHECK(pixel.g == Approx(0.4f).margin(0.02f));
+        CHECK(pixel.b == Approx(0.2f).margin(0.02f));
+        CHECK(pixel.a == 1.0f);
+
+        compressor.format = Image::BC7_UNORM;
+        compressor.preset = util::BlockCompressor::Preset::QUALITY;
+        auto bc7 = compressor.compress(*mipmapped);
+        REQUIRE(bc7);
+        CHECK(bc7->sizeInBytes() == 65536);
+        bc7->read(pixel, 255, 255);
+        CHECK(pixel.r == Approx(0.8f).margin(0.01f));
+        CHECK(pixel.a == Approx(0.5f).margin(0.01f));
+
+        // no mipmaps for sizes that aren't powers of two
+        auto odd = Image::create(Image::R8G8B8_UNORM, 10, 6);
+        odd->fill(Image::Pixel(1, 1, 1, 1));
+        compressor.format = Image::BC3_UNORM;
+        auto bc3 = compressor.compress(*odd->generateMipmaps());
+        REQUIRE(bc3);
+        CHECK(bc3->mipLevels() == 1);
+        CHECK(bc3->sizeInBytes() == 6 * 16);
+
+        // gradients with a little noise exercise the endpoints and indices;
+        // a swapped endpoint or a misplaced index shows up as a large error
+        auto gradient = Image::create(Image::R8G8B8A8_UNORM, 64, 64);
+        for (unsigned t = 0; t < 64; ++t)
+        {
+            for (unsigned s = 0; s < 64; ++s)
+            {
+                float n = (float)((int)((s * 7 + t * 13) % 9) - 4);
+                gradient->write(Image::Pixel(
+                    std::clamp((float)(s * 4) + n, 0.0f, 255.0f) / 255.0f,
+                    std::clamp((float)(t * 4) - n, 0.0f, 255.0f) / 255.0f,
+                    std::clamp((float)((s + t) * 2) + n, 0.0f, 255.0f) / 255.0f,
+                    std::clamp((float)(255 - s * 2) + n, 0.0f, 255.0f) / 255.0f), s, t);
+            }
+        }
+
+        for (auto format : { Image::BC1_RGB_UNORM, Image::BC3_UNORM, Image::BC7_UNORM })
+        {
+            double rmse[2];
+            for (auto preset : { util::BlockCompressor::Preset::FAST, util::BlockCompressor::Preset::QUALITY })
+            {
+                compressor.format = format;
+                compressor.preset = preset;
+                auto compressed = compressor.compress(*gradient);
+                REQUIRE(compressed);
+
+                const unsigned channels = format == Image::BC1_RGB_UNORM ? 3 : 4;
+                double sum = 0.0;
+                Image::Pixel a, b;
+                for (unsigned t = 0; t < 64; ++t)
+                {
+                    for (unsigned s = 0; s < 64; ++s)
+                    {
+                        gradient->read(a, s, t);
+                        compressed->read(b, s, t);
+                        for (unsigned c = 0; c < channels; ++c)
+                            sum += (255.0 * (a[c] - b[c])) * (255.0 * (a[c] - b[c]));
+                    }
+                }
+                rmse[preset == util::BlockCompressor::Preset::QUALITY] = std::sqrt(sum / (64.0 * 64.0 * channels));
+            }
+            CHECK(rmse[0] < 6.0);
+            CHECK(rmse[1] < 6.0);
+            CHECK(rmse[1] <= rmse[0] + 0.1);
+        }
+    }
 }
 
 TEST_CASE("Heightfield")
@@ -234,6 +754,96 @@ TEST_CASE("Heightfield")
     }
 }
 
+TEST_CASE("ElevationLayer")
+{
+    auto layer = CountingElevationLayer::create();
+    REQUIRE(layer->open({}).ok());
+
+    Profile p("global-geodetic");
+    TileKey key(3, 2, 1, p);
+
+    // what the layer generates: 100m, with a NO_DATA corner
+    auto generated = [](const Result<GeoHeightfield>& r)
+        {
+            auto hf = r.value.heightfield();
+            return hf && hf->width() == 17 &&
+                hf->heightAt(8, 8) == 100.0f &&
+                hf->heightAt(0, 0) == NO_DATA_VALUE;
+        };
+
+    SECTION("Cache hit")
+    {
+        auto first = layer->createHeightfield(key, {});
+        REQUIRE(first.status.ok());
+        CHECK(first.value.valid());
+        CHECK(layer->calls == 1);
+
+        // served from the L2 cache without generating again
+        auto second = layer->createHeightfield(key, {});
+        CHECK(second.status.ok());
+        CHECK(generated(second));
+        CHECK(layer->calls == 1);
+
+        layer->createHeightfield(TileKey(3, 3, 1, p), {});
+        CHECK(layer->calls == 2);
+    }
+
+    SECTION("Tile model")
+    {
+        auto map = Map::create();
+        map->layers().add(layer);
+
+        // the tile model replaces NO_DATA with zero, but in its own copy,
+        // never in the heightfield the layer caches and shares
+        TerrainTileModelFactory factory;
+        auto model = factory.createElevationModel(map.get(), key, {});
+        REQUIRE(model.heightfield.heightfield());
+        CHECK(model.heightfield.heightfield()->heightAt(0, 0) == 0.0f);
+        CHECK(model.heightfield.heightfield()->heightAt(8, 8) == 100.0f);
+
+        auto calls = layer->calls.load();
+        CHECK(generated(layer->createHeightfield(key, {})));
+        CHECK(layer->calls == calls);
+    }
+
+    SECTION("Shared flight")
+    {
+        std::promise<void> release;
+        layer->gate = release.get_future().share();
+
+        // the leader generates the tile and blocks inside the layer
+        auto leader = std::async(std::launch::async, [&]() { return layer->createHeightfield(key, {}); });
+        while (layer->calls == 0)
+            std::this_thread::yield();
+
+        // one waiter gets canceled while it waits on the leader's flight
+        CancelFlag flag;
+        IOOptions canceledIO(flag);
+        auto canceled = std::async(std::launch::async, [&]() { return layer->createHeightfield(key, canceledIO); });
+
+        // another waits for the leader's result
+        auto waiter = std::async(std::launch::async, [&]() { return layer->createHeightfield(key, {}); });
+
+        CHECK(canceled.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+        flag.value = true;
+        CHECK(canceled.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        CHECK(canceled.get().value.valid() == false);
+        CHECK(leader.wait_for(std::chrono::milliseconds(0)) == std::future_status::timeout);
+
+        release.set_value();
+        auto lead = leader.get();
+        auto shared = waiter.get();
+        CHECK(lead.value.valid());
+        CHECK(generated(lead));
+        CHECK(generated(shared));
+        CHECK(layer->calls == 1);
+
+        // and later requests hit the cache
+        CHECK(generated(layer->createHeightfield(key, {})));
+        CHECK(layer->calls == 1);
+    }
+}
+
 TEST_CASE("Map")
 {
     auto map = Map::create();
@@ -281,9 +891,166 @@ TEST_CASE("Map")
 #ifdef ROCKY_HAS_GDAL
 TEST_CASE("GDAL")
 {
+    SECTION("Sibling batching")
+    {
+        GDAL::SiblingBatcher<Image> siblings;
+        Profile profile("global-geodetic");
+        IOOptions io;
+        int reads = 0;
+
+        auto readBatch = [&](const std::vector<TileKey>& keys)
+            {
+                ++reads;
+                GDAL::SiblingBatcher<Image>::Batch batch;
+                for (auto& key : keys)
+                    batch.emplace_back(Image::create(Image::R8_UNORM, key.x + 1, key.y + 1));
+                return batch;
+            };
+
+        // all four children come from one read, each with its own result
+        TileKey parent(3, 5, 2, profile);
+        for (unsigned q = 0; q < 4; ++q)
+        {
+            auto child = parent.createChildKey(q);
+            auto r = siblings.read(child, io, readBatch);
+            REQUIRE(r.status.ok());
+            CHECK(r.value->width() == child.x + 1);
+            CHECK(r.value->height() == child.y + 1);
+        }
+        CHECK(reads == 1);
+
+        // once all four are taken, the quad is released
+        siblings.read(parent.createChildKey(0), io, readBatch);
+        CHECK(reads == 2);
+    }
+
+    SECTION("Batched reads match single-tile reads")
+    {
+        for (auto interpolation : { Interpolation::NEAREST, Interpolation::AVERAGE })
+        {
+            // separate layers, so neither can answer from the other's results
+            auto single = GDALImageLayer::create();
+            auto batched = GDALImageLayer::create();
+            for (auto& layer : { single, batched })
+            {
+                layer->uri = std::string(ROCKY_TEST_DATA_DIR) + "/imagery/world.tif";
+                layer->interpolation = interpolation;
+                REQUIRE(layer->open({}).ok());
+            }
+
+            TileKey parent(2, 5, 1, batched->profile);
+            for (unsigned q = 0; q < 4; ++q)
+            {
+                auto key = parent.createChildKey(q);
+
+                IOOptions io;
+                auto expected = single->createImage(key, io);
+
+                // only a read for the pager's own key is batched
+                io.quadLoadKey = key;
+                auto actual = batched->createImage(key, io);
+
+                REQUIRE(expected.status.ok());
+                REQUIRE(actual.status.ok());
+                auto a = expected.value.image();
+                auto b = actual.value.image();
+                REQUIRE(a->sizeInBytes() == b->sizeInBytes());
+                CHECK(memcmp(a->data<unsigned char>(), b->data<unsigned char>(), a->sizeInBytes()) == 0);
+            }
+        }
+    }
 }
 #endif // ROCKY_HAS_GDAL
 
+#ifdef ROCKY_HAS_MBTILES
+TEST_CASE("MBTiles")
+{
+    auto filename = (std::filesystem::temp_directory_path() / "rocky_tests.mbtiles").string();
+    std::filesystem::remove(filename);
+
+    // a one-byte "codec", so the test doesn't depend on an image plugin
+    IOOptions io;
+    io.services.writeImageToStream = [](std::shared_ptr<Image> image, std::ostream& out, std::string, const IOOptions&) -> Status
+        {
+            out.put((char)image->data<unsigned char>()[0]);
+            return StatusOK;
+        };
+    io.services.readImageFromStream = [](std::istream& in, std::string, const IOOptions&) -> Result<std::shared_ptr<Image>>
+        {
+            auto image = Image::create(Image::R8_UNORM, 1, 1);
+            image->data<unsigned char>()[0] = (unsigned char)in.get();
+            return image;
+        };
+
+    auto tile = [](unsigned char value)
+        {
+            auto image = Image::create(Image::R8_UNORM, 1, 1);
+            image->data<unsigned char>()[0] = value;
+            return image;
+        };
+
+    auto valueAt = [&](MBTiles::Driver& db, const TileKey& key)
+        {
+            auto r = db.read(key, io);
+            return r.status.ok() ? (int)r.value->data<unsigned char>()[0] : -1;
+        };
+
+    Profile profile("global-geodetic");
+    MBTiles::Options options;
+    options.uri = URI(filename);
+    options.writeAheadLog = true;
+
+    {
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        SECTION("Batch write")
+        {
+            std::vector<MBTiles::Tile> tiles;
+            for (unsigned i = 0; i < 8; ++i)
+                tiles.push_back({ TileKey(3, i, 1, profile), tile((unsigned char)(i * 10)) });
+
+            REQUIRE(db.write(tiles, io).ok());
+            for (unsigned i = 0; i < 8; ++i)
+            {
+                CHECK(db.contains(TileKey(3, i, 1, profile)));
+                CHECK(valueAt(db, TileKey(3, i, 1, profile)) == (int)(i * 10));
+            }
+            CHECK_FALSE(db.contains(TileKey(3, 0, 2, profile)));
+
+            // the cached query is prepared again for a reopened database
+            db.close();
+            extents.clear();
+            REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+            CHECK(db.contains(TileKey(3, 5, 1, profile)));
+            CHECK_FALSE(db.contains(TileKey(3, 0, 2, profile)));
+        }
+
+        SECTION("Transactions")
+        {
+            // single and batch writes join an open transaction
+            REQUIRE(db.beginTransaction().ok());
+            CHECK(db.write(TileKey(2, 0, 0, profile), tile(7), io).ok());
+            CHECK(db.write({ { TileKey(2, 1, 0, profile), tile(8) } }, io).ok());
+            REQUIRE(db.commitTransaction().ok());
+            CHECK(valueAt(db, TileKey(2, 0, 0, profile)) == 7);
+            CHECK(valueAt(db, TileKey(2, 1, 0, profile)) == 8);
+
+            // a failed commit must not leave the driver confused about
+            // whether a transaction is open
+            CHECK(db.commitTransaction().failed());
+            CHECK(db.write({ { TileKey(2, 2, 0, profile), tile(9) } }, io).ok());
+            CHECK(valueAt(db, TileKey(2, 2, 0, profile)) == 9);
+        }
+
+        db.close();
+    }
+
+    std::filesystem::remove(filename);
+}
+#endif // ROCKY_HAS_MBTILES
+
 TEST_CASE("TMS")
 {
     auto layer = TMSImageLayer::create();
@@ -685,7 +1452,7 @@ TEST_CASE("IO")
         {
             CHECK(r.value.contentType == "text/xml");
 
-            auto body = r.value.data;
+            auto body = r.value.data.str();
             CHECK(!body.empty());
             CHECK(rocky::util::startsWith(body, "<?xml"));
         }
@@ -704,7 +1471,7 @@ TEST_CASE("IO")
             CHECKED_IF(r.status.ok())
             {
                 CHECK(r.value.contentType == "text/xml");
-                auto body = r.value.data;
+                auto body = r.value.data.str();
                 CHECK(!body.empty());
                 CHECK(rocky::util::startsWith(body, "<?xml"));
             }
@@ -715,6 +1482,63 @@ TEST_CASE("IO")
         }
     }
 
+    SECTION("HTTP connection pool")
+    {
+#ifdef ROCKY_HAS_HTTPLIB
+        // local stand-in for a tile server
+        httplib::Server server;
+        server.Get(R"(/tiles/(\d+))", [](const httplib::Request& req, httplib::Response& res) {
+            res.set_content("tile " + req.matches[1].str(), "text/plain");
+            });
+        int port = server.bind_to_any_port("127.0.0.1");
+        REQUIRE(port > 0);
+        std::thread listener([&]() { server.listen_after_bind(); });
+        while (!server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        auto tile = [port](int i) {
+            return URI("http://127.0.0.1:" + std::to_string(port) + "/tiles/" + std::to_string(i));
+        };
+
+        IOOptions io;
+        io.services.httpPool = std::make_shared<HTTPConnectionPool>(2);
+
+        // sequential requests share one kept-alive connection
+        for (int i = 0; i < 8; ++i)
+        {
+            auto r = tile(i).read(io);
+            REQUIRE(r.status.ok());
+            CHECK(r.value.data.str() == "tile " + std::to_string(i));
+        }
+        auto stats = io.services.httpPool->stats();
+        CHECK(stats.created == 1);
+        CHECK(stats.reused == 7);
+        CHECK(stats.idle == 1);
+
+        // concurrent requests never open more than the per-host limit
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < 4; ++i)
+                    tile(100 + t * 4 + i).read(io);
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        stats = io.services.httpPool->stats();
+        CHECK(stats.created <= 2);
+        CHECK(stats.created + stats.reused == 8 + 32);
+        CHECK(stats.active == 0);
+
+        server.stop();
+        listener.join();
+#else
+        WARN("No httplib - skipping connection pool test");
+#endif
+    }
+
     SECTION("URI")
     {
         URI file("C:/folder/filename.ext");
@@ -745,6 +1569,82 @@ TEST_CASE("IO")
         CHECK(relative_to_url_file.base() == "filename.ext");
         CHECK(relative_to_url_file.full() == "https://server.tld/folder/filename.ext");
     }
+
+    SECTION("Buffer")
+    {
+        auto filename = (std::filesystem::temp_directory_path() / "rocky_test_buffer.bin").string();
+
+        // large enough to take the memory-mapped path
+        std::string data(256 * 1024, '\0');
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = (char)(i * 7);
+        {
+            std::ofstream out(filename, std::ios_base::binary);
+            out.write(data.data(), data.size());
+        }
+
+        auto r = Buffer::readFile(filename);
+        REQUIRE(r.status.ok());
+        CHECK(r.value.size() == data.size());
+        CHECK(r.value.view() == data);
+
+        // copies and slices share the same memory
+        Buffer copy = r.value;
+        CHECK(copy.data() == r.value.data());
+        auto slice = copy.slice(1000, 10);
+        CHECK(slice.data() == copy.data() + 1000);
+        CHECK(slice.view() == data.substr(1000, 10));
+        CHECK(copy.slice(data.size() + 1).empty());
+
+        BufferStream in(copy);
+        in.seekg(1000);
+        char c = 0;
+        in.read(&c, 1);
+        CHECK(c == data[1000]);
+
+        CHECK(Buffer::readFile(filename + ".missing").status.failed());
+        std::filesystem::remove(filename);
+    }
+
+    SECTION("DiskCache")
+    {
+        auto path = (std::filesystem::temp_directory_path() / "rocky_test_cache").string();
+        std::filesystem::remove_all(path);
+
+        Content content{ "image/png", std::string(1000, 'x'), std::chrono::system_clock::now() };
+
+        auto cache = DiskCache::create(path, 2500);
+        REQUIRE(cache->status().ok());
+        CHECK(cache->write("http://server/a.png", content).ok());
+        CHECK(cache->write("http://server/b.png", content).ok());
+
+        auto r = cache->read("http://server/a.png");
+        REQUIRE(r.status.ok());
+        CHECK(r.value.contentType == "image/png");
+        CHECK(r.value.data == content.data);
+        CHECK(cache->read("http://server/missing.png").status.failed());
+
+        // exceeds the budget; evicts the least recently accessed entry (b)
+        CHECK(cache->write("http://server/c.png", content).ok());
+        CHECK(cache->bytes() <= 2500);
+        CHECK(cache->read("http://server/b.png").status.failed());
+        CHECK(cache->read("http://server/a.png").status.ok());
+
+        // entries persist across instances
+        cache = DiskCache::create(path, 2500);
+        CHECK(cache->entries() == 2);
+        CHECK(cache->read("http://server/c.png").status.ok());
+
+        // expiry
+        content.timestamp -= std::chrono::hours(2);
+        CHECK(cache->write("http://server/old.png", content).ok());
+        cache->maxAge = std::chrono::hours(1);
+        CHECK(cache->read("http://server/old.png").status.failed());
+
+        cache->clear();
+        CHECK(cache->entries() == 0);
+        std::filesystem::remove_all(path);
+    }
 }
 
 TEST_CASE("Earth File")